@@ -20,9 +20,11 @@
 #include <smart-snmpd/smart-snmpd.h>
 #include <smart-snmpd/cmndline.h>
 #include <smart-snmpd/resourcelimits.h>
+#include <smart-snmpd/pwent.h>
 
 #include <confuse.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <map>
@@ -31,12 +33,133 @@ using namespace std;
 
 namespace SmartSnmpd
 {
+    /**
+     * format of the output of external commands
+     */
+    enum ExternalOutputFormat
+    {
+        //! list of (oid, type, value) tuples as JSON
+        outputFormatJson,
+        //! compact binary encoding (see ParseExternalBinary)
+        outputFormatBinary
+    };
+
+    /**
+     * handling of external command output exceeding the configured limits
+     */
+    enum ExternalOutputOverflow
+    {
+        //! the excess output is discarded (the tail is kept for STDERR)
+        outputOverflowTruncate,
+        //! the command is killed
+        outputOverflowAbort
+    };
+
     struct ExternalCommandConfig
     {
+        inline ExternalCommandConfig()
+            : Executable()
+            , Arguments()
+            , User()
+            , UserResolved(false)
+            , UserCredentials()
+            , ResourceLimits()
+            , Timeout(0)
+            , KillGrace(5000)
+            , OutputFormat(outputFormatJson)
+            , MaxStdout(0)
+            , MaxStderr(65536)
+            , OutputOverflow(outputOverflowTruncate)
+            , Persistent(false)
+            , Differential(false)
+            , RequestTimeout(10000)
+            , RestartBackoff(1000)
+            , RestartBackoffMax(300000)
+            , OidPrefix()
+        {}
+
         string Executable;
         vector<string> Arguments;
         string User;
+        // whether UserCredentials holds the identity of User - both are
+        // set by the data source when the configuration is applied
+        bool UserResolved;
+        SystemUserInfo::Credentials UserCredentials;
         class ResourceLimits ResourceLimits;
+        // wall-clock time limit of a command run in milliseconds, 0 for none
+        unsigned long Timeout;
+        // time between SIGTERM and SIGKILL for commands exceeding Timeout in milliseconds
+        unsigned long KillGrace;
+        // format of the command output
+        ExternalOutputFormat OutputFormat;
+        // maximum number of STDOUT bytes of a document, 0 for unlimited
+        unsigned long MaxStdout;
+        // maximum number of STDERR bytes kept, 0 for unlimited
+        unsigned long MaxStderr;
+        // handling of output exceeding MaxStdout or MaxStderr
+        ExternalOutputOverflow OutputOverflow;
+        // keep the command running as co-process answering requests on stdin
+        bool Persistent;
+        // a persistent command may answer with the changes since its previous answer only
+        bool Differential;
+        // time to wait for the answer of a co-process in milliseconds
+        unsigned long RequestTimeout;
+        // initial delay before restarting a failed co-process in milliseconds
+        unsigned long RestartBackoff;
+        // maximum delay before restarting a failed co-process in milliseconds
+        unsigned long RestartBackoffMax;
+        // only output below this oid is published, empty for all
+        string OidPrefix;
+    };
+
+    /**
+     * how rows of tables are indexed
+     */
+    enum RowIndexing
+    {
+        //! rows are numbered in order of collection
+        rowIndexSequential,
+        //! rows are indexed by a key which is stable over refreshes (pid, interface index, ...)
+        rowIndexStable
+    };
+
+    /**
+     * restriction of the rows collected into process and file system tables
+     */
+    struct RowFilterConfig
+    {
+        inline RowFilterConfig()
+            : Name()
+            , User()
+            , States()
+            , MinResident(0)
+            , MinCpuPercent(0.0)
+            , FsTypes()
+            , MountPrefixes()
+        {}
+
+        inline bool operator == ( RowFilterConfig const &ref ) const
+        {
+            return ( Name == ref.Name ) && ( User == ref.User ) && ( States == ref.States ) &&
+                   ( MinResident == ref.MinResident ) && ( MinCpuPercent == ref.MinCpuPercent ) &&
+                   ( FsTypes == ref.FsTypes ) && ( MountPrefixes == ref.MountPrefixes );
+        }
+        inline bool operator != ( RowFilterConfig const &ref ) const { return !( *this == ref ); }
+
+        // extended regular expression the process name has to match, empty for any
+        string Name;
+        // extended regular expression the name of the process owner has to match, empty for any
+        string User;
+        // accepted process states (running, sleeping, stopped, zombie, unknown), empty for any
+        vector<string> States;
+        // minimum resident size of a process in bytes
+        unsigned long long MinResident;
+        // minimum cpu usage of a process in percent
+        double MinCpuPercent;
+        // accepted file system types, empty for any
+        vector<string> FsTypes;
+        // accepted mount point prefixes (whole path components), empty for any
+        vector<string> MountPrefixes;
     };
 
     /**
@@ -47,8 +170,17 @@ namespace SmartSnmpd
         inline MibObjectConfig()
             : MibEnabled(true)
             , AsyncUpdate(false)
-            , CacheTime(30)
+            , CacheTime(30000)
+            , UpdateJitter(0)
+            , UpdatePriority(0)
+            , StaleWhileRevalidate(false)
+            , MaxStaleness(0)
+            , RowIndex(rowIndexSequential)
+            , Columns()
+            , RowFilter()
             , MostRecentIntervalTime(0)
+            , RateWindows()
+            , RatePercentile(95)
             , ExternalCommand()
             , SubOid(0)
         {}
@@ -57,7 +189,16 @@ namespace SmartSnmpd
             : MibEnabled(ref.MibEnabled)
             , AsyncUpdate(ref.AsyncUpdate)
             , CacheTime(ref.CacheTime)
+            , UpdateJitter(ref.UpdateJitter)
+            , UpdatePriority(ref.UpdatePriority)
+            , StaleWhileRevalidate(ref.StaleWhileRevalidate)
+            , MaxStaleness(ref.MaxStaleness)
+            , RowIndex(ref.RowIndex)
+            , Columns(ref.Columns)
+            , RowFilter(ref.RowFilter)
             , MostRecentIntervalTime(ref.MostRecentIntervalTime)
+            , RateWindows(ref.RateWindows)
+            , RatePercentile(ref.RatePercentile)
             // , ExternalCommand(ref.ExternalCommand)
             // , CommandArguments(ref.CommandArguments)
             // , User(ref.User)
@@ -67,18 +208,70 @@ namespace SmartSnmpd
 
         bool MibEnabled;
         bool AsyncUpdate;
-        time_t CacheTime;
-        // special addional settings for interval mibs (cpu cycles per minute etc.)
-        time_t MostRecentIntervalTime;
+        // time in milliseconds before the content expires
+        unsigned long CacheTime;
+        // random delay of asynchronous updates in percent of CacheTime
+        unsigned UpdateJitter;
+        // due asynchronous updates with higher priority are run first
+        int UpdatePriority;
+        // serve previous content while another request refreshes an expired object
+        bool StaleWhileRevalidate;
+        // maximum age in milliseconds of content served while refreshing, 0 for unlimited
+        unsigned long MaxStaleness;
+        // how rows of tables are indexed
+        RowIndexing RowIndex;
+        // sorted numbers of the table columns to collect and publish, empty for all
+        vector<unsigned long> Columns;
+        // rows to collect into process and file system tables
+        RowFilterConfig RowFilter;
+        // special addional settings for interval mibs (cpu cycles per minute etc.) in milliseconds
+        unsigned long MostRecentIntervalTime;
+        // windows in milliseconds to aggregate rates of interval mibs over
+        vector<unsigned long> RateWindows;
+        // percentile reported for the rates of each window
+        unsigned RatePercentile;
         // special additional settings for mibs filled from external programs
         struct ExternalCommandConfig ExternalCommand;
         unsigned SubOid; // for unknown mibs
+
+        inline bool isColumnEnabled( unsigned long column ) const
+        {
+            return Columns.empty() || binary_search( Columns.begin(), Columns.end(), column );
+        }
+    };
+
+    /**
+     * source of the process statistics
+     */
+    enum ProcessCollector
+    {
+        //! sg_get_process_stats_r() of libstatgrab
+        processCollectorStatgrab,
+        //! direct scan of /proc (Linux only, see ProcfsProcessCollector)
+        processCollectorProcfs
     };
 
     struct StatgrabSettings
     {
+        inline StatgrabSettings()
+            : RemoveFilesystems(false)
+            , ValidFilesystems()
+            , ProcessCollector(processCollectorStatgrab)
+            , ProcessThreads(1)
+            , ProcessTopCount(0)
+            , ProcessDeltaUpdate(true)
+        {}
+
         bool RemoveFilesystems;
         vector<string> ValidFilesystems;
+        // how process statistics are collected
+        enum ProcessCollector ProcessCollector;
+        // number of threads scanning /proc
+        unsigned ProcessThreads;
+        // number of rows of the top process tables, 0 disables them
+        unsigned ProcessTopCount;
+        // update the process table rows incrementally between refreshes
+        bool ProcessDeltaUpdate;
     };
 
     /**
@@ -182,6 +375,10 @@ namespace SmartSnmpd
 #ifdef AGENTPP_USE_THREAD_POOL
             , mNumberOfJobThreads(16)
 #endif
+            , mNumberOfUpdateThreads(4)
+            , mExternalCommandConcurrency(8)
+            , mUserCacheTimeout(300000)
+            , mUserCacheNegativeTimeout(60000)
             // resource limits of the daemon
             , mDaemonResourceLimits()
             , mOnFatalError(onfKill)
@@ -321,6 +518,10 @@ namespace SmartSnmpd
 #ifdef AGENTPP_USE_THREAD_POOL
         inline int getNumberOfJobThreads() const { return mNumberOfJobThreads; }
 #endif
+        inline int getNumberOfUpdateThreads() const { return mNumberOfUpdateThreads; }
+        inline int getExternalCommandConcurrency() const { return mExternalCommandConcurrency; }
+        inline unsigned long getUserCacheTimeout() const { return mUserCacheTimeout; }
+        inline unsigned long getUserCacheNegativeTimeout() const { return mUserCacheNegativeTimeout; }
 
         inline ResourceLimits const & getDaemonResourceLimits() const { return mDaemonResourceLimits; }
         inline OnFatalError getOnFatalError() const { return mOnFatalError; }
@@ -380,6 +581,10 @@ namespace SmartSnmpd
 #ifdef AGENTPP_USE_THREAD_POOL
         int mNumberOfJobThreads;
 #endif
+        int mNumberOfUpdateThreads;
+        int mExternalCommandConcurrency;
+        unsigned long mUserCacheTimeout;
+        unsigned long mUserCacheNegativeTimeout;
         ResourceLimits mDaemonResourceLimits;
         OnFatalError mOnFatalError;
         // managed mib-objects
@@ -19,7 +19,7 @@
 
 #include <smart-snmpd/mibobject.h>
 
-#include <queue>
+#include <vector>
 #include <functional>
 
 namespace SmartSnmpd
@@ -42,59 +42,101 @@ namespace SmartSnmpd
          * from the recent value.
          *
          * Implement specializations of this operator is valuable when the
-         * subtraction operator can't be overloaded.
+         * subtraction operator can't be overloaded. Specializations must
+         * provide the type of the difference as result_type - the result
+         * object is reused for each calculation, so containers keep their
+         * capacity.
          *
          * @param comperator - operand to compare against the most recent value
          * @param recent - the most recent value
+         * @param result - receives the calculated difference between given
+         *   comperator and recent
+         */
+        inline void operator () ( T const &comperator, T const &recent, T &result ) const { result = recent - comperator; }
+
+        /**
+         * takes a measuring value as it is
+         *
+         * Used when there is nothing to compare against - specializations
+         * with a result_type different from T must provide it, too.
          *
-         * @return calculated difference between given comperator and recent
+         * @param recent - the most recent value
+         * @param result - receives the value
          */
-        inline T operator () ( T const &comperator, T const &recent ) const { return recent - comperator; }
+        inline void assign( T const &recent, T &result ) const { result = recent; }
     };
 
     /**
      * base class to calculate differences between measuring values
      *
+     * The measuring values are kept in a ring buffer which is allocated
+     * once when the history is set up - adding a measuring value doesn't
+     * allocate memory.
+     *
      * @param T - the type of measuring values to manage and calculate
      *            differences for.
      * @param Differ - the difference calculating class
-     *
-     * @todo rewrite to use allocators for pointer to measuring values
      */
     template <class T, class Differ = calc_diff< T > >
     class DataDiff
     {
     public:
+        typedef typename Differ::result_type ResultType;
+
         /**
          * destructor
          *
          * This destructor calls freeItem for each managed measuring value
-         * and the lastest calculated difference
          */
         virtual ~DataDiff()
         {
-            if( mValidDiffResult )
-            {
-                mValidDiffResult = false;
-                freeItem(mDiffResult);
-            }
-
-            while( !mHistory.empty() )
-            {
-                freeItem( mHistory.front() );
-                mHistory.pop();
-            }
+            while( mHistorySize )
+                dropOldest();
         } 
 
+        /**
+         * wall clock time of the measuring value the last difference has
+         * been calculated against
+         *
+         * @return unsigned long long - milliseconds since epoch
+         */
+        inline unsigned long long getDiffFrom() const { return mDiffFrom; }
+        /**
+         * wall clock time of the most recent measuring value
+         *
+         * @return unsigned long long - milliseconds since epoch
+         */
+        inline unsigned long long getDiffUntil() const { return mDiffUntil; }
+
     protected:
         /**
-         * history of measuring values
+         * measuring value with the wall clock time it has been added
+         */
+        struct Sample
+        {
+            Sample()
+                : Value()
+                , Timestamp(0)
+            {}
+
+            T Value;
+            //! milliseconds since epoch
+            unsigned long long Timestamp;
+        };
+
+        /**
+         * ring buffer of measuring values, the capacity is the maximum
+         * size of history
          */
-        std::queue <T> mHistory;
+        std::vector<Sample> mHistory;
         /**
-         * maximum size of history
+         * position of the oldest measuring value in mHistory
          */
-        size_t mHistoryMaxSize;
+        size_t mHistoryFirst;
+        /**
+         * number of measuring values in mHistory
+         */
+        size_t mHistorySize;
         /**
          * difference calculator
          */
@@ -102,11 +144,11 @@ namespace SmartSnmpd
         /**
          * difference result
          */
-        T mDiffResult;
+        ResultType mDiffResult;
         /**
-         * true when mDiffResult contains some data
+         * timestamps of the measuring values mDiffResult has been calculated from
          */
-        bool mValidDiffResult;
+        unsigned long long mDiffFrom, mDiffUntil;
 
         // will be singletons ...
         /**
@@ -115,13 +157,27 @@ namespace SmartSnmpd
          * The default constructor is protected to allow deriving into singletons
          */
         inline DataDiff()
-            : mHistory()
-            , mHistoryMaxSize(1)
+            : mHistory(1)
+            , mHistoryFirst(0)
+            , mHistorySize(0)
             , mDiffer()
             , mDiffResult()
-            , mValidDiffResult(false)
+            , mDiffFrom(0)
+            , mDiffUntil(0)
         {}
 
+        /**
+         * current wall clock time with sub-second precision
+         *
+         * @return unsigned long long - milliseconds since epoch
+         */
+        static inline unsigned long long currentTimestamp()
+        {
+            struct timeval tv;
+            gettimeofday( &tv, NULL );
+            return ( (unsigned long long)(tv.tv_sec) ) * 1000 + tv.tv_usec / 1000;
+        }
+
         /**
          * simple allocator replacement to free no more measuring values
          *
@@ -133,6 +189,17 @@ namespace SmartSnmpd
          */
         inline void freeItem( T &t ) { (void)t; }
 
+        /**
+         * removes the oldest measuring value from the history
+         */
+        inline void dropOldest()
+        {
+            freeItem( mHistory[mHistoryFirst].Value );
+            mHistory[mHistoryFirst] = Sample();
+            mHistoryFirst = ( mHistoryFirst + 1 ) % mHistory.size();
+            --mHistorySize;
+        }
+
         /**
          * setup the history buffer
          *
@@ -140,20 +207,31 @@ namespace SmartSnmpd
          * to collect one object per update interval and have room for
          * mrInterval / cacheTime measuring values to calcultate the difference
          * between new measuring values and the last one before the measuring
-         * interval is exceeded.
+         * interval is exceeded. The buffer is only reallocated when its
+         * capacity changes, the most recent measuring values are kept.
          *
          * @param mibObj - the MibObject instance to get the configured parameters from
          */
         inline void setupHistory(MibObject const &mibObj)
         {
-            time_t cacheTime = mibObj.getConfig().CacheTime;
-            time_t mrInterval = mibObj.getConfig().MostRecentIntervalTime;
-            mHistoryMaxSize = cacheTime ? mrInterval / cacheTime : 1;
-            while( mHistory.size() > mHistoryMaxSize )
-            {
-                freeItem( mHistory.front() );
-                mHistory.pop();
-            }
+            unsigned long cacheTime = mibObj.getConfig().CacheTime;
+            unsigned long mrInterval = mibObj.getConfig().MostRecentIntervalTime;
+            size_t historyMaxSize = cacheTime ? mrInterval / cacheTime : 1;
+            if( historyMaxSize < 1 )
+                historyMaxSize = 1;
+
+            if( historyMaxSize == mHistory.size() )
+                return;
+
+            while( mHistorySize > historyMaxSize )
+                dropOldest();
+
+            std::vector<Sample> history( historyMaxSize );
+            for( size_t i = 0; i < mHistorySize; ++i )
+                history[i] = mHistory[( mHistoryFirst + i ) % mHistory.size()];
+
+            mHistory.swap( history );
+            mHistoryFirst = 0;
         }
 
         /**
@@ -162,41 +240,40 @@ namespace SmartSnmpd
          * This method returns the difference between the most recent and
          * the oldest available measuring value. If there is no measurng
          * value available to compare against, the given measuring value
-         * is stored for later comparison with a later "recent measuring value".
+         * is returned and stored for later comparison with a later
+         * "recent measuring value".
+         * The time range of the difference is available via getDiffFrom() and
+         * getDiffUntil() afterwards.
          *
          * @param mostRecent - the most recent measuring value
          *
-         * @return T const & - reference to immutable difference result
+         * @return ResultType const & - reference to immutable difference result
          */
-        inline T const & diff(T const &mostRecent)
+        inline ResultType const & diff(T const &mostRecent)
         {
-            if( mValidDiffResult )
-            {
-                mValidDiffResult = false;
-                freeItem( mDiffResult );
-                memset( &mDiffResult, 0, sizeof(mDiffResult) );
-            }
+            mDiffUntil = currentTimestamp();
 
-            if( mHistory.empty() )
+            if( 0 == mHistorySize )
             {
-                mHistory.push( mostRecent );
-                return mostRecent;
+                mDiffFrom = mDiffUntil;
+                mDiffer.assign( mostRecent, mDiffResult );
             }
             else
             {
-                T const &comperator = mHistory.front();
-                mDiffResult = mDiffer( comperator, mostRecent );
-                mValidDiffResult = true;
-
-                mHistory.push( mostRecent );
-                while( mHistory.size() > mHistoryMaxSize )
-                {
-                    freeItem( mHistory.front() );
-                    mHistory.pop();
-                }
-
-                return mDiffResult;
+                Sample const &comperator = mHistory[mHistoryFirst];
+                mDiffFrom = comperator.Timestamp;
+                mDiffer( comperator.Value, mostRecent, mDiffResult );
             }
+
+            if( mHistorySize == mHistory.size() )
+                dropOldest();
+
+            Sample &slot = mHistory[( mHistoryFirst + mHistorySize ) % mHistory.size()];
+            slot.Value = mostRecent;
+            slot.Timestamp = mDiffUntil;
+            ++mHistorySize;
+
+            return mDiffResult;
         }
     };
 }
@@ -20,10 +20,11 @@
 #include <agent_pp/agent++.h>
 #include <agent_pp/threads.h>
 
+#include <smart-snmpd/updatescheduler.h>
+
 namespace SmartSnmpd
 {
     class MibObject;
-    class UpdateThread;
 
     /**
      * base class for data sources
@@ -105,13 +106,6 @@ namespace SmartSnmpd
         virtual bool unregisterMibs( NS_AGENT Mib &mainMibCtrl );
 
     protected:
-        /**
-         * Instance of asynchronous update thread, if once configured.
-         * The update thread doesn't always run, but isn't deleted when
-         * configuration change from asynchronous to synchronous data
-         * providing.
-         */
-        UpdateThread *mUpdateThread;
         /**
          * Instance of controlled mib object.
          */
@@ -125,7 +119,6 @@ namespace SmartSnmpd
          */
         inline DataSource()
             : ThreadManager()
-            , mUpdateThread(0)
             , mMibObj(0)
         {}
 
@@ -136,17 +129,23 @@ namespace SmartSnmpd
          */
         virtual bool initMibObj();
         /**
-         * start the asynchronous update thread for the controlled mib
+         * schedule asynchronous updates of the controlled mib or apply
+         * changed scheduling parameters
          *
          * @return bool - true when successful, false otherwise
          */
         virtual bool startMibObjUpdater();
         /**
-         * stop the asynchronous update thread for the controlled mib
-         *
-         * @return bool - true when successful, false otherwise
+         * remove the controlled mib from the update scheduler
          */
         virtual void stopMibObjUpdater();
+        /**
+         * build the scheduling parameters from the configuration of the
+         * controlled mib
+         *
+         * @return UpdateJobConfig - parameters for the update scheduler
+         */
+        virtual UpdateJobConfig getUpdateJobConfig() const;
     };
 }
 
@@ -19,6 +19,7 @@
 
 #include <smart-snmpd/smart-snmpd.h>
 #include <smart-snmpd/config.h>
+#include <smart-snmpd/updatescheduler.h>
 #if 0
 #include <smart-snmpd/mibutils/mibcomposed.h>
 #endif
@@ -56,21 +57,32 @@ namespace SmartSnmpd
         /**
          * destructor
          */
-        virtual ~MibObject() {}
+        virtual ~MibObject();
 
         /**
          * virtual constructor to clone this instance into a new object
          *
          * @return new instance of MibObject based on this instance
          */
-        virtual MibEntry *clone() { NS_AGENT ThreadSynchronize guard(*this); return new MibObject(*this); }
+        virtual MibEntry *clone() { NS_AGENT ThreadSynchronize guard(mUpdateGuard); return new MibObject(*this); }
 
         /**
          * Get method for last update timestamp
          *
          * @return time_t - timestamp of last object update
          */
-        time_t GetLastUpdate() const { return mContentMgr.GetLastUpdate(); }
+        time_t GetLastUpdate() const { ContentReference content( *this ); return content->GetLastUpdate(); }
+        /**
+         * Get method for the time the current content has been published
+         *
+         * The time is taken from the monotonic clock of the update scheduler
+         * and is used to check the expiry of the content - it isn't affected
+         * by adjustments of the system time.
+         *
+         * @return UpdateTime - time of last commitContentUpdate(), 0 when
+         *   no content has been published yet
+         */
+        UpdateTime GetLastCommit() const { ContentReference content( *this ); return content.getCommitted(); }
 
         /**
          * provide access to the configuration of this mib
@@ -100,9 +112,28 @@ namespace SmartSnmpd
          * done asynchronously by a background updating thread. This is
          * thread safe anyway, because each modification of a value is
          * guarded.
+         *
+         * Concurrent requests for an expired object don't start their own
+         * refresh: the first one refreshes, the others wait for its result.
+         * When stale-while-revalidate is configured, requests are answered
+         * from the previous content while the refresh is done by the update
+         * scheduler - as long as the content isn't older than max-staleness.
          */
         virtual void update(NS_AGENT Request* aReq);
 
+        /**
+         * refresh the data managed by this mib object - called by the
+         * update workers
+         *
+         * Takes the same refresh claim as update(), so requests wait for a
+         * refresh done by a worker instead of starting another one. Nothing
+         * is done when a request is refreshing the object right now.
+         *
+         * @return bool - true when the data source has been updated
+         *    successfully, false on error or when skipped
+         */
+        bool refresh();
+
         /**
          * Return the successor of a given object identifier within the 
          * receiver's scope and the context of a given Request.
@@ -118,93 +149,172 @@ namespace SmartSnmpd
          */
         virtual Oidx find_succ( NS_AGENT Oidx const &o, NS_AGENT Request *aReq = 0 )
         {
-            NS_AGENT ThreadSynchronize guard(*this);
-            return mContentMgr.find_succ( o, aReq );
+            ContentReference content( *this );
+            return content->find_succ( o, aReq );
         }
 
         /**
-         * Let the receiver process a SNMP GET subrequest (SYNCHRONIZED by caller)
+         * Let the receiver process a SNMP GET subrequest (NOT SYNCHRONIZED)
+         *
+         * The request is answered from the currently published content
+         * snapshot, a concurrent content update doesn't block it.
          * 
          * @param req - A pointer to the whole SNMP GET request.
          * @param idx - The index of the subrequest to be processed.
          */
         virtual void get_request( NS_AGENT Request *aReq, int idx )
         {
-            mContentMgr.get_request( aReq, idx );
+            ContentReference content( *this );
+            content->get_request( aReq, idx );
         }
 
         /**
-         * Let the receiver process a SNMP GETNEXT subrequest (SYNCHRONIZED by caller)
+         * Let the receiver process a SNMP GETNEXT subrequest (NOT SYNCHRONIZED)
+         *
+         * The request is answered from the currently published content
+         * snapshot, a concurrent content update doesn't block it.
          * 
          * @param req - A pointer to the whole SNMP GETNEXT request.
          * @param idx - The index of the subrequest to be processed.
          */
         virtual void get_next_request( NS_AGENT Request *aReq, int idx )
         {
-            mContentMgr.get_next_request( aReq, idx );
+            ContentReference content( *this );
+            content->get_next_request( aReq, idx );
         }
 
         /**
          * getter method to retrieve the instance of the content manager
          *
-         * This method locks the container which contains the updated content
-         * and holds that lock until commitContentUpdate() or
-         * abortContentUpdate() is called.
+         * This method locks out other updaters until commitContentUpdate()
+         * or abortContentUpdate() is called. The returned content manager
+         * is private to the caller until it's published by
+         * commitContentUpdate().
          *
          * @return reference to the used content manager
          */
-        ContentManagerType & beginContentUpdate()
-        {
-            NS_AGENT ThreadSynchronize guard(*this);
-            mShadowContentMgr.start_synch();
-            return mShadowContentMgr;
-        }
+        ContentManagerType & beginContentUpdate();
         /**
-         * getter method to retrieve the instance of the content manager
+         * commit requested content update
          *
-         * @return reference to the (immutable) used content manager
+         * Publishes the content built since beginContentUpdate() as new
+         * snapshot. Readers still working on the previous snapshot finish
+         * on it, it's recycled when the last of them has released it.
+         *
+         * @return reference to this instance
          */
-        ContentManagerType const & getShadowContentManager() const { return mShadowContentMgr; }
+        MibObject & commitContentUpdate();
         /**
-         * commit requested content update (SYNCHRONIZED)
+         * grants access to the currently published content while a
+         * content update is running - it can't be replaced before
+         * commitContentUpdate() or abortContentUpdate()
+         *
+         * @return reference to the published content
+         */
+        ContentManagerType const & getPublishedContent() const { return mContent->Content; }
+        /**
+         * aborts the requested content update
          *
          * @return reference to this instance
          */
-        MibObject & commitContentUpdate()
+        MibObject & abortContentUpdate();
+
+        /**
+         * Start synchronized execution.
+         *
+         * Published content is immutable, so requests don't need to lock
+         * the content - they hold a reference to the snapshot instead.
+         */
+        virtual void start_synch() {}
+        /**
+         * End synchronized execution.
+         */
+        virtual void end_synch() {}
+
+    protected:
+        /**
+         * reference counted snapshot of the content
+         */
+        struct ContentSnapshot
         {
-            NS_AGENT ThreadSynchronize guard(*this);
-            mShadowContentMgr.start_synch(); // (ccu1)
-            mContentMgr.swap( mShadowContentMgr );
-            mShadowContentMgr.end_synch(); // end sync from (ccu1)
+            explicit ContentSnapshot( NS_AGENT Oidx const &anOid )
+                : Content( anOid )
+                , RefCount( 1 )
+                , Committed( 0 )
+            {}
 
-            mShadowContentMgr.clear();
-            mShadowContentMgr.end_synch(); // end sync from beginContentUpdate()
+            explicit ContentSnapshot( ContentManagerType const &aContent )
+                : Content( aContent )
+                , RefCount( 1 )
+                , Committed( 0 )
+            {}
+
+            ContentManagerType Content;
+            unsigned long RefCount;
+            //! monotonic time when the snapshot has been published
+            UpdateTime Committed;
+        };
 
-            return *this;
-        }
         /**
-         * aborts the requested content update
-         *
-         * @return reference to this instance
+         * holds a reference to the currently published content snapshot
+         * for the life time of the instance
          */
-        MibObject & abortContentUpdate()
+        class ContentReference
         {
-            mShadowContentMgr.clear();
-            mShadowContentMgr.end_synch(); // end sync from beginContentUpdate();
+        public:
+            explicit ContentReference( MibObject const &aMibObj )
+                : mMibObj( aMibObj )
+                , mSnapshot( aMibObj.acquireContent() )
+            {}
+
+            ~ContentReference() { mMibObj.releaseContent( mSnapshot ); }
+
+            // published content is shared by the readers and must not be modified
+            ContentManagerType const & operator * () const { return mSnapshot->Content; }
+            ContentManagerType const * operator -> () const { return &mSnapshot->Content; }
+            UpdateTime getCommitted() const { return mSnapshot->Committed; }
+
+        private:
+            ContentReference();
+            ContentReference( ContentReference const & );
+            ContentReference & operator = ( ContentReference const & );
 
-            return *this;
+            MibObject const &mMibObj;
+            ContentSnapshot *mSnapshot;
+        };
+
+        /**
+         * takes a reference on the currently published content snapshot
+         *
+         * @return ContentSnapshot * - the published snapshot
+         */
+        ContentSnapshot * acquireContent() const
+        {
+            NS_AGENT ThreadSynchronize guard( mSnapshotGuard );
+            ++mContent->RefCount;
+            return mContent;
         }
 
         /**
-         * Start synchronized execution.
+         * drops a reference taken by acquireContent(), recycles the snapshot
+         * when the last reference has gone
+         *
+         * @param aSnapshot - snapshot to release
+         */
+        void releaseContent( ContentSnapshot *aSnapshot ) const;
+
+        /**
+         * updates the data source under the refresh claim taken by the
+         * caller, clears the claim and wakes up the requests waiting for it
+         *
+         * @return bool - result of DataSource::updateMibObj()
          */
-        virtual void start_synch() { MibComplexEntry::start_synch(); mContentMgr.start_synch(); }
+        bool runRefresh();
         /**
-         * End synchronized execution.
+         * clears the refresh claim and wakes up the requests waiting for it
          */
-        virtual void end_synch() { mContentMgr.end_synch(); MibComplexEntry::end_synch(); }
+        void endRefresh();
 
-    protected:
         /**
          * private copy of configuration settings of this mib object
          */
@@ -215,13 +325,37 @@ namespace SmartSnmpd
          */
         DataSource &mDataSource;
         /**
-         * content manager
+         * serializes content updates
+         */
+        NS_AGENT ThreadManager mUpdateGuard;
+        /**
+         * signals the end of a synchronous refresh to waiting requests
+         */
+        NS_AGENT Synchronized mRefreshSync;
+        /**
+         * flag whether a synchronous refresh is running (guarded by mRefreshSync)
+         */
+        bool mRefreshing;
+        /**
+         * guards the snapshot pointers and reference counters - held only
+         * for the time to copy a pointer and adjust a counter
+         */
+        mutable NS_AGENT ThreadManager mSnapshotGuard;
+        /**
+         * currently published content
+         */
+        ContentSnapshot *mContent;
+        /**
+         * content being built by the updater to perform atomic updates
          */
-        ContentManagerType mContentMgr;
+        ContentSnapshot *mShadowContent;
         /**
-         * shadow content manager to perform atomic updates
+         * retired snapshot kept to be refilled by the next update
          */
-        ContentManagerType mShadowContentMgr;
+        mutable ContentSnapshot *mSpareContent;
+
+    private:
+        MibObject & operator = ( MibObject const & );
     };
 }
 
@@ -18,6 +18,7 @@
 #define __SMART_SNMPD_DATASOURCE_EXTCMD_H_INCLUDED__
 
 #include <smart-snmpd/datasource.h>
+#include <smart-snmpd/mibs/extcmd/extcmd.h>
 #include <agent_pp/snmp_pp_ext.h>
 
 #include <string>
@@ -26,6 +27,10 @@ using namespace std;
 
 namespace SmartSnmpd
 {
+    class ExternalCoProcess;
+    class ExternalCommandUpdateJob;
+    class ParseExternalOutput;
+
     /**
      * data source for external delivered statistics
      */
@@ -44,13 +49,19 @@ namespace SmartSnmpd
             : DataSource()
             , mRootOid(rootOid)
             , mCommandLine()
+            , mCommandConfig()
             , mExpectedEntryCount( 1000 )
+            , mCoProcess( NULL )
+            , mJob( NULL )
+            , mDeltaBase( false )
+            , mDeltaBaseStarts( 0 )
+            , mOutputCounters()
         {}
 
         /**
-         * destructor
+         * destructor - terminates a running co-process or command
          */
-        virtual ~DataSourceExternalCommand() {}
+        virtual ~DataSourceExternalCommand();
 
         /**
          * accessor to the controlled MibObject instance bound to the oid
@@ -80,7 +91,14 @@ namespace SmartSnmpd
          * updates the managed mib object
          *
          * This method fetches the current content by executing the configured
-         * external command and parses the resulting json output. The resulting
+         * external command (or by requesting it from the co-process for
+         * persistent commands) and parses the resulting output (json or
+         * binary, see ExternalCommandConfig::OutputFormat). The
+         * output of non-persistent commands is parsed while it arrives. With
+         * asynchronous updates, the command is queued to the
+         * ExternalCommandExecutor and its output is collected by the update
+         * triggered when it is done. Runs of the same command are shared
+         * between data sources within their cache time. The resulting
          * data is put at the oid ".100" below the configured base oid. The
          * meta data is updated upon the status of the command execution.
          *
@@ -97,15 +115,76 @@ namespace SmartSnmpd
          * the command line to execute (for logging output and SM_EXTERNAL_COMMAND_COMMAND_LINE)
          */
         string mCommandLine;
+        /**
+         * the applied command configuration including the identity of
+         * the configured user (resolved once per configuration change -
+         * never during an update)
+         */
+        ExternalCommandConfig mCommandConfig;
         /**
          * contains the estimated number of json entries (to avoid reallocs during parsing)
          */
         size_t mExpectedEntryCount;
+        /**
+         * the running command for persistent external commands
+         */
+        ExternalCoProcess *mCoProcess;
+        /**
+         * the queued, running or finished command (possibly shared with
+         * other data sources running the same command), NULL when none
+         */
+        ExternalCommandUpdateJob *mJob;
+        /**
+         * flag whether the published content is a valid base for a
+         * differential answer of the co-process
+         */
+        bool mDeltaBase;
+        /**
+         * start count of the co-process instance which delivered the
+         * published content (differential answers of other instances are
+         * rejected)
+         */
+        unsigned long mDeltaBaseStarts;
+        /**
+         * output statistics of finished commands and co-processes
+         */
+        ExternalOutputCounters mOutputCounters;
 
         /**
          * builds the command line to be executed (to be reported via logging and mib fetching)
          */
         void buildCommandLine();
+        /**
+         * copies the command configuration of the managed mib object and
+         * resolves the identity of the configured user (may block on name
+         * services, so it's not called with the lock held)
+         *
+         * @return ExternalCommandConfig - the configuration to apply to mCommandConfig
+         */
+        ExternalCommandConfig resolveCommandConfig() const;
+
+        /**
+         * fetches the json output of a persistent external command
+         *
+         * @param smExtCmdMib - mib to report the execution state to
+         *
+         * @return string const * - the json output on success, NULL otherwise
+         */
+        string const * requestCoProcess( class ExtCmdMib &smExtCmdMib );
+        /**
+         * reports the execution state of the finished command in mJob
+         *
+         * @param smExtCmdMib - mib to report the execution state to
+         *
+         * @return ParseExternalOutput const * - the parser fed with the
+         *   output of the command on success, NULL otherwise
+         */
+        ParseExternalOutput const * collectJob( class ExtCmdMib &smExtCmdMib );
+        /**
+         * releases mJob (its command is cancelled when no other data
+         * source shares it)
+         */
+        void dropJob();
 
         /**
          * initialize controlled mib object
@@ -19,14 +19,74 @@
 
 #include <smart-snmpd/config.h>
 #include <smart-snmpd/resourcelimits.h>
+#include <smart-snmpd/pwent.h>
+#include <smart-snmpd/updatescheduler.h>
 
 #include <string>
 #include <vector>
 
 namespace SmartSnmpd
 {
+    /**
+     * receiver of the STDOUT content of an external command
+     *
+     * A sink gets the output chunk by chunk while the command is still
+     * running, so it can be processed without capturing it completely.
+     */
+    class ExternalCommandOutputSink
+    {
+    public:
+        //! destructor
+        virtual ~ExternalCommandOutputSink() {}
+
+        /**
+         * processes the next chunk of output
+         *
+         * @param data - pointer to the chunk, valid only during the call
+         * @param length - length of the chunk
+         */
+        virtual void consume(const char *data, size_t length) = 0;
+    };
+
+    /**
+     * statistics of the output of external commands
+     */
+    struct ExternalOutputCounters
+    {
+        inline ExternalOutputCounters()
+            : OutBytes(0)
+            , ErrBytes(0)
+            , DiscardedBytes(0)
+            , Overflows(0)
+        {}
+
+        inline ExternalOutputCounters & operator += (ExternalOutputCounters const &ref)
+        {
+            OutBytes += ref.OutBytes;
+            ErrBytes += ref.ErrBytes;
+            DiscardedBytes += ref.DiscardedBytes;
+            Overflows += ref.Overflows;
+
+            return *this;
+        }
+
+        //! bytes read from STDOUT
+        unsigned long long OutBytes;
+        //! bytes read from STDERR
+        unsigned long long ErrBytes;
+        //! bytes dropped because of the configured limits
+        unsigned long long DiscardedBytes;
+        //! number of command instances which exceeded a limit
+        unsigned long Overflows;
+    };
+
     /**
      * class to encapsulate external command starting and output capturing
+     *
+     * The captured output is bounded by the configured limits: STDOUT
+     * beyond the limit is discarded, for STDERR only the most recent bytes
+     * are kept in a ring buffer. Optionally the command is killed when it
+     * exceeds a limit.
      */
     class ExternalCommand
     {
@@ -43,9 +103,19 @@ namespace SmartSnmpd
             , mArguments(cmdcfg.Arguments)
             , mResourceLimits(cmdcfg.ResourceLimits)
             , mBuffers(2)
+            , mMaxStdout(cmdcfg.MaxStdout)
+            , mMaxStderr(cmdcfg.MaxStderr)
+            , mAbortOnOverflow(outputOverflowAbort == cmdcfg.OutputOverflow)
+            , mErrStart(0)
+            , mCounters()
+            , mOverflowed(false)
+            , mOutTruncated(false)
             , mExitCode(-1)
             , mExitSignal(-1)
             , mChildPid(-1)
+            , mWithInput(false)
+            , mInFileno(-1)
+            , mOutSink(0)
         {
             mFileno[0] = mFileno[1] = -1;
         }
@@ -61,6 +131,12 @@ namespace SmartSnmpd
         /**
          * start configured external command
          *
+         * The child is created by vfork() and only applies the resource
+         * limits and the identity (see applyIdentity()), redirects
+         * STDOUT/STDERR and closes all other inherited descriptors before
+         * executing the command. A failing execv() is reported as error
+         * code.
+         *
          * @return int - 0 on success, errno code on error
          */
         virtual int start();
@@ -71,7 +147,21 @@ namespace SmartSnmpd
          *
          * @return bool - true if still running, false if can reaped
          */
-        virtual bool poll(unsigned seconds);
+        virtual bool poll(unsigned seconds) { return pollMs( seconds * 1000UL ); }
+        /**
+         * polls external command status
+         *
+         * The capturing pipes are read without blocking. They are polled
+         * until end of file even after the process has been reaped, because
+         * children of the command may still write to them - use
+         * closeOutput() to give up on them.
+         *
+         * @param milliseconds - time to wait for data or process exit
+         *
+         * @return bool - true if still running or a capturing pipe is open,
+         *   false if reaped and all output has been collected
+         */
+        virtual bool pollMs(unsigned long milliseconds);
         /**
          * sends a signal to the process started via external command
          *
@@ -81,10 +171,55 @@ namespace SmartSnmpd
          */
         virtual int kill(int signal);
         /**
-         * waits (blocking) until started process has been ended and all
-         * data is collected
+         * waits (blocking) until started process has been ended and
+         * collects the data it has written - pipes held open by children
+         * of the command are closed instead of waiting for end of file
+         */
+        virtual void finish();
+        /**
+         * closes the capturing pipes, output not read so far is lost
          */
-        virtual void finish() { while( poll(1) ) (void)0; }
+        virtual void closeOutput();
+
+        /**
+         * connects STDIN of the command to a pipe instead of inheriting it
+         * from the agent - must be called before start()
+         *
+         * @param withInput - true to create an input pipe
+         */
+        inline void setInputPipe(bool withInput) { mWithInput = withInput; }
+        /**
+         * passes STDOUT to a sink instead of capturing it in the output
+         * buffer (getOutBuf() stays empty then)
+         *
+         * @param sink - sink to feed or 0 to capture the output, must live
+         *   until the command is finished
+         */
+        inline void setOutSink(ExternalCommandOutputSink *sink) { mOutSink = sink; }
+        /**
+         * writes data to STDIN of the running command
+         *
+         * @param data - data to write
+         * @param milliseconds - maximum time to wait until the data is written
+         *
+         * @return int - 0 on success, errno code on error (eg. EPIPE when
+         *   the command closed its STDIN or ETIMEDOUT)
+         */
+        virtual int writeInput(string const &data, unsigned long milliseconds);
+        /**
+         * closes STDIN of the running command (signals end of input)
+         */
+        virtual void closeInput();
+        /**
+         * removes processed data from the begin of the STDOUT capture buffer
+         *
+         * @param length - number of bytes to remove
+         */
+        inline void consumeOutBuf(size_t length) { mBuffers[0].erase( 0, length ); }
+        /**
+         * discards the captured STDERR content
+         */
+        inline void clearErrBuf() { mBuffers[1].clear(); mErrStart = 0; }
 
         /**
          * grants access to the captured STDOUT content
@@ -97,9 +232,33 @@ namespace SmartSnmpd
          * grants access to the captured STDERR content
          *
          * @return string const & - string buffer containing the captured
-         *   error output without any modification
+         *   error output, only the tail when the limit has been exceeded
+         */
+        string const & getErrBuf() const;
+        /**
+         * returns the statistics of the output of the command
+         *
+         * @return ExternalOutputCounters const & - output statistics
+         */
+        inline ExternalOutputCounters const & getOutputCounters() const { return mCounters; }
+        /**
+         * checks whether the output exceeded a configured limit
+         *
+         * @return bool - true when output has been discarded
          */
-        inline string const & getErrBuf() const { return mBuffers[1]; }
+        inline bool hasOverflowed() const { return mOverflowed; }
+        /**
+         * checks whether STDOUT has been truncated
+         *
+         * @return bool - true when STDOUT output has been discarded
+         */
+        inline bool isOutTruncated() const { return mOutTruncated; }
+        /**
+         * checks whether the command is killed when exceeding a limit
+         *
+         * @return bool - true when the command is killed on overflow
+         */
+        inline bool abortsOnOverflow() const { return mAbortOnOverflow; }
         /**
          * returns the exit code of the process
          *
@@ -120,6 +279,18 @@ namespace SmartSnmpd
          * @return pid_t - child's pid or (pid_t)-1 if not running
          */
         inline int getChildPid() const { return mChildPid; }
+        /**
+         * return file handle of the STDOUT capturing pipe
+         *
+         * @return int - file handle or -1 if closed
+         */
+        inline int getOutFileno() const { return mFileno[0]; }
+        /**
+         * return file handle of the STDERR capturing pipe
+         *
+         * @return int - file handle or -1 if closed
+         */
+        inline int getErrFileno() const { return mFileno[1]; }
 
     protected:
         /**
@@ -135,9 +306,38 @@ namespace SmartSnmpd
          */
         class ResourceLimits mResourceLimits;
         /**
-         * output capture buffers
+         * output capture buffers, mBuffers[1] is a ring buffer when
+         * mMaxStderr is set (see mErrStart)
+         */
+        mutable vector<string> mBuffers;
+        /**
+         * maximum number of captured STDOUT bytes, 0 for unlimited
+         */
+        unsigned long mMaxStdout;
+        /**
+         * maximum number of kept STDERR bytes, 0 for unlimited
+         */
+        unsigned long mMaxStderr;
+        /**
+         * flag whether the command is killed when exceeding a limit
+         */
+        bool mAbortOnOverflow;
+        /**
+         * position of the oldest byte in the STDERR ring buffer
+         */
+        mutable size_t mErrStart;
+        /**
+         * output statistics
+         */
+        ExternalOutputCounters mCounters;
+        /**
+         * flag whether a limit has been exceeded
          */
-        vector<string> mBuffers;
+        bool mOverflowed;
+        /**
+         * flag whether STDOUT output has been discarded
+         */
+        bool mOutTruncated;
         /**
          * exit code "cache"
          */
@@ -155,6 +355,51 @@ namespace SmartSnmpd
          * file handles of capturing pipes
          */
         int mFileno[2];
+        /**
+         * flag whether STDIN is connected to a pipe
+         */
+        bool mWithInput;
+        /**
+         * file handle of the input pipe
+         */
+        int mInFileno;
+        /**
+         * receiver of STDOUT, 0 to capture it in mBuffers[0]
+         */
+        ExternalCommandOutputSink *mOutSink;
+
+        /**
+         * switches the identity of the child before executing the command
+         *
+         * Runs in the child between vfork() and execv() - therefore only
+         * async signal safe calls are allowed here, no memory must be
+         * allocated.
+         *
+         * @return int - 0 on success, errno code on error
+         */
+        virtual int applyIdentity() const { return 0; }
+        /**
+         * reads available data from a capturing pipe, closes it on end of file
+         *
+         * @param idx - 0 for STDOUT, 1 for STDERR
+         *
+         * @return bool - true when data has been read
+         */
+        bool readPipe(unsigned idx);
+        /**
+         * appends to the STDERR ring buffer, overwriting the oldest bytes
+         * when it's full
+         *
+         * @param data - pointer to the data
+         * @param length - length of the data
+         */
+        void appendErrTail(const char *data, size_t length);
+        /**
+         * accounts discarded output and kills the command when configured
+         *
+         * @param discarded - number of discarded bytes
+         */
+        void overflow(size_t discarded);
 
     private:
         //! forbidden default constructor
@@ -167,6 +412,12 @@ namespace SmartSnmpd
 
     /**
      * class to encapsulate external command starting as specific user and output capturing
+     *
+     * The user id, primary group and supplementary groups of the user are
+     * taken from the configuration, where the data source puts them when
+     * the configuration is applied (see resolve()). The child switches to
+     * that identity before executing the command, which requires the
+     * agent to run as root unless the user is the one the agent runs as.
      */
     class ExternalCommandAsUser
         : public ExternalCommand
@@ -176,16 +427,218 @@ namespace SmartSnmpd
          * constructor
          *
          * Creates execution plan from external command configuration
+         * including the identity resolved for the configured user
          *
          * @param cmdcfg - specification how to run external command
          */
         ExternalCommandAsUser(ExternalCommandConfig const &cmdcfg);
 
+        /**
+         * looks up the identity of a user (may block on name services)
+         *
+         * @param user - name of the user
+         * @param credentials - receives the identity of the user
+         *
+         * @return bool - true when the user could be resolved
+         */
+        static bool resolve(string const &user, SystemUserInfo::Credentials &credentials);
+
+        /**
+         * start configured external command as the configured user
+         *
+         * @return int - 0 on success, errno code on error (ENOENT when
+         *   the user couldn't be resolved)
+         */
+        virtual int start();
+
     protected:
         /**
          * user name to run as
          */
         string mUser;
+        /**
+         * identity of mUser
+         */
+        SystemUserInfo::Credentials mCredentials;
+        /**
+         * flag whether mCredentials could be resolved
+         */
+        bool mResolved;
+        /**
+         * flag whether the identity differs from the one of the agent
+         */
+        bool mSwitch;
+
+        virtual int applyIdentity() const;
+        /**
+         * sets mSwitch from the resolved identity
+         */
+        void checkSwitch();
+    };
+
+    /**
+     * class to keep an external command running as co-process
+     *
+     * The command is started once and receives a request line (terminated
+     * by a newline) on STDIN for each refresh. It answers with one framed
+     * document per request on STDOUT: the length of the document in bytes
+     * as decimal number followed by a newline, followed by the document
+     * itself. Whitespace between the frames is ignored.
+     *
+     * When the command dies, doesn't answer within the configured request
+     * timeout or violates the protocol, it is killed and restarted with
+     * the next request. Restarts after failures are delayed by a backoff
+     * which doubles with each consecutive failure.
+     */
+    class ExternalCoProcess
+    {
+    public:
+        /**
+         * constructor
+         *
+         * @param cmdcfg - specification how to run external command
+         */
+        ExternalCoProcess(ExternalCommandConfig const &cmdcfg);
+
+        /**
+         * destructor - closes STDIN of the command and terminates it
+         * when it doesn't exit by itself in time
+         */
+        virtual ~ExternalCoProcess();
+
+        /**
+         * sends a request to the command and waits for the answer
+         *
+         * The command is (re-)started when necessary.
+         *
+         * @param request - request line to send (without newline)
+         *
+         * @return int - 0 on success, errno code on error (EAGAIN while
+         *   a restart is delayed, ETIMEDOUT when no answer has been received
+         *   in time, EPIPE when the command died, EPROTO on invalid frames,
+         *   EFBIG when the output exceeded the configured limits)
+         */
+        virtual int request(string const &request);
+
+        /**
+         * checks whether the co-process has been set up with the specified
+         * command configuration
+         *
+         * @param cmdcfg - command configuration to compare with
+         *
+         * @return bool - true when executable, arguments, user (and its resolved
+         *   identity) and the co-process timings are equal
+         */
+        bool matches(ExternalCommandConfig const &cmdcfg) const;
+
+        /**
+         * grants access to the document received by the last successful request
+         *
+         * @return string const & - the document without framing
+         */
+        inline string const & getDocument() const { return mDocument; }
+        /**
+         * grants access to the error output captured during the last request
+         *
+         * @return string const & - captured STDERR content
+         */
+        inline string const & getErrBuf() const { return mErrBuf; }
+        /**
+         * returns the exit code of the last terminated command instance
+         *
+         * @return int - exit code or -1 if ended by signal or never terminated
+         */
+        inline int getExitCode() const { return mExitCode; }
+        /**
+         * returns the exit signal of the last terminated command instance
+         *
+         * @return int - signal number or -1 if ended by exit code or never terminated
+         */
+        inline int getExitSignal() const { return mExitSignal; }
+        /**
+         * returns the number of times the command has been started
+         *
+         * @return unsigned long - number of starts
+         */
+        inline unsigned long getStarts() const { return mStarts; }
+        /**
+         * returns the output statistics of all command instances
+         *
+         * @return ExternalOutputCounters - output statistics
+         */
+        inline ExternalOutputCounters getOutputCounters() const
+        {
+            ExternalOutputCounters counters( mCounters );
+            if( mCommand )
+                counters += mCommand->getOutputCounters();
+            return counters;
+        }
+
+    protected:
+        /**
+         * extracts a complete frame from the captured output into mDocument
+         *
+         * @return int - 0 when a frame has been extracted, EAGAIN when the
+         *   frame is incomplete, EPROTO on invalid frame header
+         */
+        int extractFrame();
+        /**
+         * kills and reaps the running command and delays the next start
+         *
+         * @param now - current time (see UpdateScheduler::now())
+         * @param failed - true when the command failed, which increases
+         *   the backoff, false when it exited between two requests
+         */
+        void abandon(UpdateTime now, bool failed);
+
+        /**
+         * configuration the command is started with
+         */
+        ExternalCommandConfig mConfig;
+        /**
+         * the running command, NULL when not started
+         */
+        ExternalCommand *mCommand;
+        /**
+         * document of the last successful request
+         */
+        string mDocument;
+        /**
+         * error output of the last request
+         */
+        string mErrBuf;
+        /**
+         * exit code of the last terminated command instance
+         */
+        int mExitCode;
+        /**
+         * exit signal of the last terminated command instance
+         */
+        int mExitSignal;
+        /**
+         * number of starts of the command
+         */
+        unsigned long mStarts;
+        /**
+         * current restart delay in milliseconds, 0 after a successful request
+         */
+        unsigned long mBackoff;
+        /**
+         * earliest time the command may be started again
+         */
+        UpdateTime mNextStart;
+        /**
+         * output statistics of finished command instances
+         */
+        ExternalOutputCounters mCounters;
+
+    private:
+        //! forbidden default constructor
+        ExternalCoProcess();
+        //! forbidden copy constructor
+        ExternalCoProcess(ExternalCoProcess const &);
+        //! forbidden assignment operator
+        ExternalCoProcess & operator = (ExternalCoProcess const &);
     };
 }
 
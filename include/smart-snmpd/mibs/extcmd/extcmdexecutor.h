@@ -0,0 +1,319 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_EXTCMD_EXECUTOR_H_INCLUDED__
+#define __SMART_SNMPD_EXTCMD_EXECUTOR_H_INCLUDED__
+
+#include <smart-snmpd/mibs/extcmd/extcmd.h>
+#include <smart-snmpd/updatescheduler.h>
+
+#include <agent_pp/threads.h>
+
+#include <deque>
+#include <vector>
+
+namespace SmartSnmpd
+{
+    class ExternalCommandExecutor;
+
+    /**
+     * execution of an external command by the ExternalCommandExecutor
+     */
+    class ExternalCommandJob
+    {
+        friend class ExternalCommandExecutor;
+
+    public:
+        /**
+         * constructor
+         *
+         * @param aCommand - the command to run, must live until the job is done
+         * @param aTimeout - wall-clock time limit in milliseconds, 0 for none
+         * @param aKillGrace - time between SIGTERM and SIGKILL when the
+         *   time limit is exceeded in milliseconds
+         */
+        ExternalCommandJob( ExternalCommand &aCommand, unsigned long aTimeout, unsigned long aKillGrace )
+            : mCommand( aCommand )
+            , mTimeout( aTimeout )
+            , mKillGrace( aKillGrace )
+            , mDeadline( 0 )
+            , mKillStage( 0 )
+            , mPidFd( -1 )
+            , mErrorCode( 0 )
+            , mLaunched( false )
+            , mStarting( false )
+            , mCancelled( false )
+            , mDone( false )
+        {}
+
+        //! destructor
+        virtual ~ExternalCommandJob() {}
+
+        /**
+         * called by the executor when the command has been finished,
+         * but not for jobs cancelled by ExternalCommandExecutor::cancel()
+         * (NOT SYNCHRONIZED - called with the executor lock held, must not
+         * call back into the executor)
+         */
+        virtual void finished() {}
+        /**
+         * called by the executor after output of the command may have been
+         * read - an output sink should only copy the data it gets and do
+         * the expensive processing here (NOT SYNCHRONIZED - called without
+         * the executor lock, but always by the thread supervising the
+         * command and before finished())
+         */
+        virtual void outputReceived() {}
+
+        /**
+         * returns the command run by this job
+         *
+         * @return ExternalCommand & - the command
+         */
+        inline ExternalCommand & getCommand() const { return mCommand; }
+        /**
+         * returns the error of the job
+         *
+         * @return int - 0 when the command has been run, the error code of
+         *   ExternalCommand::start() when it couldn't be started, ETIMEDOUT
+         *   when it has been killed after exceeding the time limit or its
+         *   output pipes were still open then, or ECANCELED when it has been
+         *   cancelled
+         */
+        inline int getErrorCode() const { return mErrorCode; }
+        /**
+         * checks whether the command has been started
+         *
+         * @return bool - true when ExternalCommand::start() succeeded
+         */
+        inline bool isLaunched() const { return mLaunched; }
+        /**
+         * checks whether the job has been done (NOT SYNCHRONIZED - see
+         * ExternalCommandExecutor::isDone())
+         *
+         * @return bool - true when the command has been finished
+         */
+        inline bool isDone() const { return mDone; }
+
+    protected:
+        //! command to run
+        ExternalCommand &mCommand;
+        //! wall-clock time limit in milliseconds
+        unsigned long mTimeout;
+        //! time between SIGTERM and SIGKILL in milliseconds
+        unsigned long mKillGrace;
+        //! time when the next kill stage is entered, 0 for never
+        UpdateTime mDeadline;
+        //! 0 - running, 1 - SIGTERM sent, 2 - SIGKILL sent
+        int mKillStage;
+        //! file handle becoming readable when the child exits, -1 if not supported
+        int mPidFd;
+        //! see getErrorCode()
+        int mErrorCode;
+        //! see isLaunched()
+        bool mLaunched;
+        //! set while the i/o thread starts the command without holding the executor lock
+        bool mStarting;
+        //! flag whether the job has been cancelled
+        bool mCancelled;
+        //! flag whether the job has been done
+        bool mDone;
+
+    private:
+        ExternalCommandJob();
+        ExternalCommandJob( ExternalCommandJob const & );
+        ExternalCommandJob & operator = ( ExternalCommandJob const & );
+    };
+
+    /**
+     * i/o thread of the external command executor
+     */
+    class ExternalCommandWorker
+        : public NS_AGENT Thread
+    {
+    public:
+        /**
+         * constructor
+         *
+         * @param aExecutor - executor to run the i/o loop for
+         */
+        explicit ExternalCommandWorker( ExternalCommandExecutor &aExecutor )
+            : NS_AGENT Thread()
+            , mExecutor( aExecutor )
+        {}
+
+        //! destructor
+        virtual ~ExternalCommandWorker() {}
+
+        //! thread main method
+        virtual void run();
+
+    protected:
+        //! executor running the commands
+        ExternalCommandExecutor &mExecutor;
+
+    private:
+        ExternalCommandWorker();
+        ExternalCommandWorker( ExternalCommandWorker const & );
+        ExternalCommandWorker & operator = ( ExternalCommandWorker const & );
+    };
+
+    /**
+     * central executor for external commands
+     *
+     * All running commands are supervised by one thread which waits for
+     * output and exit of all children with one poll() call. The number of
+     * concurrently running commands is limited, further jobs are queued.
+     * Commands exceeding their time limit are terminated by SIGTERM and
+     * killed by SIGKILL when they don't exit within the grace time.
+     */
+    class ExternalCommandExecutor
+        : public NS_AGENT Synchronized
+    {
+        friend class ExternalCommandWorker;
+
+    public:
+        //! destructor - stops the i/o thread
+        virtual ~ExternalCommandExecutor();
+
+        /**
+         * singleton accessor
+         *
+         * @return ExternalCommandExecutor & - the executor instance
+         */
+        static ExternalCommandExecutor & getInstance();
+
+        /**
+         * starts the i/o thread (SYNCHRONIZED)
+         *
+         * @param aConcurrency - maximum number of concurrently running commands
+         *
+         * @return bool - true when the i/o thread is running
+         */
+        bool start( unsigned aConcurrency );
+        /**
+         * stops the i/o thread, running commands are killed
+         */
+        void stop();
+        /**
+         * changes the maximum number of concurrently running commands (SYNCHRONIZED)
+         *
+         * @param aConcurrency - maximum number of concurrently running commands
+         */
+        void setConcurrency( unsigned aConcurrency );
+
+        /**
+         * queues a job to be run by the i/o thread (SYNCHRONIZED)
+         *
+         * @param aJob - the job to run, must live until it's done
+         *
+         * @return bool - true when queued, false when the i/o thread isn't running
+         */
+        bool submit( ExternalCommandJob &aJob );
+        /**
+         * runs a job and waits until it's done (SYNCHRONIZED)
+         *
+         * When the i/o thread isn't running, the job is run in the calling
+         * thread.
+         *
+         * @param aJob - the job to run
+         */
+        void execute( ExternalCommandJob &aJob );
+        /**
+         * waits until a submitted job is done (SYNCHRONIZED)
+         *
+         * @param aJob - the job to wait for
+         */
+        void waitFor( ExternalCommandJob &aJob );
+        /**
+         * kills the command of a submitted job and waits until it's done (SYNCHRONIZED)
+         *
+         * @param aJob - the job to cancel
+         */
+        void cancel( ExternalCommandJob &aJob );
+        /**
+         * checks whether a submitted job is done (SYNCHRONIZED)
+         *
+         * @param aJob - the job to check
+         *
+         * @return bool - true when the job is done
+         */
+        bool isDone( ExternalCommandJob &aJob );
+
+    protected:
+        //! default constructor - see getInstance()
+        ExternalCommandExecutor();
+
+        /**
+         * i/o loop of the worker thread (NOT SYNCHRONIZED - acquires the lock itself)
+         */
+        void loop();
+        /**
+         * starts the command of a job (NOT SYNCHRONIZED - called without
+         * the lock, the job is neither queued nor active meanwhile)
+         *
+         * @param aJob - the job to start
+         * @param aNow - current time (see UpdateScheduler::now())
+         *
+         * @return bool - true when the command is running
+         */
+        bool launch( ExternalCommandJob &aJob, UpdateTime aNow );
+        /**
+         * collects output and exit state of a job's command and enforces
+         * the time limit (NOT SYNCHRONIZED - called with lock held)
+         *
+         * @param aJob - the job to check
+         * @param aWait - time to wait for output or exit in milliseconds
+         *
+         * @return bool - true while the command is running
+         */
+        bool progress( ExternalCommandJob &aJob, unsigned long aWait );
+        /**
+         * marks a job as done and notifies its waiters (NOT SYNCHRONIZED -
+         * called with lock held)
+         *
+         * @param aJob - the finished job
+         */
+        void complete( ExternalCommandJob &aJob );
+        /**
+         * wakes up the i/o thread from poll()
+         */
+        void wakeup();
+
+        //! jobs waiting for a free slot
+        std::deque<ExternalCommandJob *> mQueue;
+        //! jobs with running commands
+        std::vector<ExternalCommandJob *> mActive;
+        //! poll set of the i/o loop (reused between iterations)
+        std::vector<struct pollfd> mPollFds;
+        //! the i/o thread
+        ExternalCommandWorker *mWorker;
+        //! pipe to wake up the i/o thread
+        int mWakeupPipe[2];
+        //! maximum number of concurrently running commands
+        unsigned mConcurrency;
+        //! flag whether the i/o thread shall run
+        bool mRunning;
+
+        static ExternalCommandExecutor *mInstance;
+
+    private:
+        ExternalCommandExecutor( ExternalCommandExecutor const & );
+        ExternalCommandExecutor & operator = ( ExternalCommandExecutor const & );
+    };
+}
+
+#endif /* __SMART_SNMPD_EXTCMD_EXECUTOR_H_INCLUDED__ */
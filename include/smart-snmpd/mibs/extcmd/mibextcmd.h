@@ -19,7 +19,8 @@
 
 #include <smart-snmpd/mibobject.h>
 
-#include <smart-snmpd/mibs/extcmd/parseextjson.h>
+#include <smart-snmpd/mibs/extcmd/parseextoutput.h>
+#include <smart-snmpd/mibs/extcmd/extcmd.h>
 
 namespace SmartSnmpd
 {
@@ -38,7 +39,12 @@ namespace SmartSnmpd
             , mLastExitSignal( aCntMgr, SM_EXTERNAL_COMMAND_LAST_EXIT_SIGNAL )
             , mLastErrorCode( aCntMgr, SM_EXTERNAL_COMMAND_ERROR_CODE )
             , mLastErrorMessage( aCntMgr, SM_EXTERNAL_COMMAND_ERROR_MESSAGE )
+            , mStdoutBytes( aCntMgr, SM_EXTERNAL_COMMAND_STDOUT_BYTES )
+            , mStderrBytes( aCntMgr, SM_EXTERNAL_COMMAND_STDERR_BYTES )
+            , mDiscardedBytes( aCntMgr, SM_EXTERNAL_COMMAND_DISCARDED_BYTES )
+            , mOutputOverflows( aCntMgr, SM_EXTERNAL_COMMAND_OUTPUT_OVERFLOWS )
             , mExternalDataOid( SM_EXTERNAL_COMMAND_DATA )
+            , mDataPrefix()
         {}
 
         virtual ~ExtCmdMib() {}
@@ -87,6 +93,24 @@ namespace SmartSnmpd
             return *this;
         }
 
+        virtual ExtCmdMib & setOutputCounters( ExternalOutputCounters const &counters )
+        {
+            mStdoutBytes.set( Counter64( counters.OutBytes ) );
+            mStderrBytes.set( Counter64( counters.ErrBytes ) );
+            mDiscardedBytes.set( Counter64( counters.DiscardedBytes ) );
+            mOutputOverflows.set( Counter64( counters.Overflows ) );
+
+            return *this;
+        }
+
+        // restricts the published command output to the subtree below prefix (empty for all)
+        virtual ExtCmdMib & setDataPrefix( NS_AGENT Oidx const &prefix )
+        {
+            mDataPrefix = prefix;
+
+            return *this;
+        }
+
         virtual ExtCmdMib &setCommandResult( vector<ExternalDataTuple> const &data )
         {
             for( vector<ExternalDataTuple>::const_iterator iter = data.begin();
@@ -94,12 +118,33 @@ namespace SmartSnmpd
                  ++iter )
             {
                 const ExternalDataTuple &edt = *iter;
-                mContentMgr.add( mExternalDataOid + edt.Oid, *edt.Datum );
+                if( edt.Datum && ( ( 0 == mDataPrefix.len() ) || mDataPrefix.is_root_of( edt.Oid ) ) )
+                    mContentMgr.add( mExternalDataOid + edt.Oid, *edt.Datum );
             }
 
             return *this;
         }
 
+        // differential result - applies the changes to the previous content
+        virtual ExtCmdMib &setCommandChanges( MibObject::ContentManagerType const &previous, vector<ExternalDataTuple> const &data )
+        {
+            vector<NS_AGENT Oidx> removed;
+
+            // entries set so far (execution state) win over the previous ones
+            mContentMgr.underlay( previous );
+
+            for( vector<ExternalDataTuple>::const_iterator iter = data.begin();
+                 iter != data.end();
+                 ++iter )
+            {
+                if( !iter->Datum )
+                    removed.push_back( mExternalDataOid + iter->Oid );
+            }
+            mContentMgr.remove( removed );
+
+            return setCommandResult( data );
+        }
+
         virtual ExtCmdMib &setUpdateTimestamp( unsigned long long secsSinceEpoch )
         {
             mUpdateTimestamp.set( secsSinceEpoch );
@@ -120,8 +165,13 @@ namespace SmartSnmpd
         MibObject::ContentManagerType::LeafType mLastExitSignal;
         MibObject::ContentManagerType::LeafType mLastErrorCode;
         MibObject::ContentManagerType::LeafType mLastErrorMessage;
+        MibObject::ContentManagerType::LeafType mStdoutBytes;
+        MibObject::ContentManagerType::LeafType mStderrBytes;
+        MibObject::ContentManagerType::LeafType mDiscardedBytes;
+        MibObject::ContentManagerType::LeafType mOutputOverflows;
 
         NS_AGENT Oidx const mExternalDataOid;
+        NS_AGENT Oidx mDataPrefix;
 
     };
 }
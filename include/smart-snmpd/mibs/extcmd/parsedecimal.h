@@ -0,0 +1,67 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_PARSEDECIMAL_H_INCLUDED__
+#define __SMART_SNMPD_PARSEDECIMAL_H_INCLUDED__
+
+#include <stdint.h>
+
+namespace SmartSnmpd
+{
+    /**
+     * parses an unsigned decimal number from a slice of a buffer
+     *
+     * The first 19 digits can't overflow an uint64_t and are accumulated
+     * without checks, only further (leading zero padded) digits are checked.
+     * Used for the numbers and oids of the json output of external commands
+     * instead of copying each token for sscanf().
+     *
+     * @param p - begin of the digits
+     * @param e - end of the digits
+     * @param value - receives the number
+     *
+     * @return bool - true when [p,e) is a non-empty sequence of digits
+     *   fitting into an uint64_t
+     */
+    inline bool
+    parse_decimal(const char *p, const char *e, uint64_t &value)
+    {
+        if( p >= e )
+            return false;
+
+        uint64_t v = 0;
+        const char *unchecked = ( e - p ) > 19 ? p + 19 : e;
+        for( ; p < unchecked; ++p )
+        {
+            unsigned d = (unsigned)( (unsigned char)(*p) - '0' );
+            if( d > 9 )
+                return false;
+            v = v * 10 + d;
+        }
+        for( ; p < e; ++p )
+        {
+            unsigned d = (unsigned)( (unsigned char)(*p) - '0' );
+            if( ( d > 9 ) || ( v > ( ~(uint64_t)0 - d ) / 10 ) )
+                return false;
+            v = v * 10 + d;
+        }
+
+        value = v;
+        return true;
+    }
+}
+
+#endif /* __SMART_SNMPD_PARSEDECIMAL_H_INCLUDED__ */
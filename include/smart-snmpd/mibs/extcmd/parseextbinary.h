@@ -0,0 +1,111 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_PARSEEXTBINARY_H_INCLUDED__
+#define __SMART_SNMPD_PARSEEXTBINARY_H_INCLUDED__
+
+#include <smart-snmpd/mibs/extcmd/parseextoutput.h>
+
+namespace SmartSnmpd
+{
+    /**
+     * parses a binary serialized list
+     *
+     * This class decodes the compact binary representation of the
+     * (oid, type, value) tuples which is an alternative to the JSON
+     * format for commands delivering huge amounts of values. All numbers
+     * are in network byte order. The document starts with the 4 byte
+     * signature "SSB\1" ("SSD\1" for differential documents), followed
+     * by the records:
+     *
+     * <ul>
+     * <li>1 byte number of sub-identifiers of the oid (1 .. 128), 0 ends
+     *     the document</li>
+     * <li>4 byte each sub-identifier</li>
+     * <li>1 byte the ASN1 type</li>
+     * <li>the value: 4 byte for ASN_INTEGER (signed), SMI_COUNTER,
+     *     SMI_GAUGE, SMI_TIMETICKS, SMI_UINTEGER and SMI_IPADDRESS, 8 byte
+     *     for SMI_COUNTER64, a 4 byte length (up to 65535) followed by the
+     *     octets for ASN_OCTET_STR and SMI_OPAQUE, nothing for ASN_NULL
+     *     (removed oid)</li>
+     * </ul>
+     *
+     * ParseExternalBinary are not MT-safe.
+     */
+    class ParseExternalBinary
+        : public ParseExternalOutput
+    {
+    public:
+        /**
+         * default constructor
+         */
+        ParseExternalBinary();
+        /**
+         * destructor
+         */
+        virtual ~ParseExternalBinary();
+
+        /**
+         * starts parsing a new document, previously parsed data is dropped
+         *
+         * @return int - 0 on success, -1 on error
+         */
+        virtual int begin();
+        /**
+         * decodes the next chunk of the document
+         *
+         * @param data - pointer to the chunk
+         * @param length - length of the chunk
+         *
+         * @return int - 0 on success, -1 on error
+         */
+        virtual int feed(const char *data, size_t length);
+        /**
+         * finishes parsing the document
+         *
+         * @return int - 0 when a complete document has been parsed, -1 on
+         *   error or when the document is incomplete
+         */
+        virtual int end();
+
+    protected:
+        //! parser state
+        enum {
+            pebHeader,
+            pebRecords,
+            pebDone
+        } mParserState;
+        //! begin of a record which is split over several chunks
+        string mPending;
+        //! minimum size of the pending record
+        size_t mNeeded;
+
+        /**
+         * decodes the signature or one record
+         *
+         * @param data - begin of the record
+         * @param length - available bytes
+         * @param needed - receives the minimum size of the record when
+         *   more data is required
+         *
+         * @return size_t - number of bytes consumed, 0 when more data is
+         *   required or on error (mFailed is set then)
+         */
+        size_t decode(const unsigned char *data, size_t length, size_t &needed);
+    };
+}
+
+#endif /* __SMART_SNMPD_PARSEEXTBINARY_H_INCLUDED__ */
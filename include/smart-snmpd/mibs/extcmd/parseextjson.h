@@ -17,11 +17,7 @@
 #ifndef __SMART_SNMPD_PARSEEXTJSON_H_INCLUDED__
 #define __SMART_SNMPD_PARSEEXTJSON_H_INCLUDED__
 
-#include <smart-snmpd/smart-snmpd.h>
-#include <agent_pp/snmp_pp_ext.h>
-
-#include <string>
-#include <vector>
+#include <smart-snmpd/mibs/extcmd/parseextoutput.h>
 
 #ifdef WITH_BUNDLED_LIBJSON
 #include <smart-snmpd/mibs/extcmd/json.h>
@@ -31,76 +27,6 @@
 
 namespace SmartSnmpd
 {
-    /**
-     * VarBind replacement for reusing on parsing
-     */
-    struct ExternalDataTuple
-    {
-        /**
-         * Oid part of the tuple
-         */
-        NS_AGENT Oidx Oid;
-        /**
-         * value part of the tuple - always owned by this instance
-         */
-        NS_SNMP SnmpSyntax *Datum;
-
-        /**
-         * default constructor
-         */
-        inline ExternalDataTuple()
-            : Oid()
-            , Datum(0)
-        {}
-
-        /**
-         * copy constructor - clones the Datum attribute of the source, if any
-         *
-         * @param ref - copy source
-         */
-        inline ExternalDataTuple(const ExternalDataTuple &ref)
-            : Oid( ref.Oid )
-            , Datum( ref.Datum ? ref.Datum->clone() : 0 )
-        {}
-
-        /**
-         * destructor
-         *
-         * owned Datum attribute is freed when the destructor is called
-         */
-        inline virtual ~ExternalDataTuple() { delete Datum; Datum = 0; }
-
-        /**
-         * assignes the attribute values of the referenced object to this object
-         *
-         * If the source object contains a Datum instance, this object
-         * will use a cloned copy of this instance.
-         *
-         * @param ref - reference to the instance to copy from
-         */
-        inline ExternalDataTuple & operator = (const ExternalDataTuple &ref)
-        {
-            if( &ref == this )
-                return *this;
-
-            Oid = ref.Oid;
-            delete Datum;
-            Datum = ref.Datum ? ref.Datum->clone() : 0;
-
-            return *this;
-        }
-
-        /**
-         * clears the content of this object
-         */
-        inline void clear()
-        {
-            Oid.clear();
-            delete Datum;
-            Datum = 0;
-        }
-    };
-
     /**
      * parses a json serialized list
      *
@@ -112,9 +38,14 @@ namespace SmartSnmpd
      * SMI_COUNTER, SMI_GAUGE, SMI_TIMETICKS, SMI_COUNTER64 or SMI_UINTEGER:
      * <code>[ [ ".1", 4, "foo" ], [ ".2", 2, 42 ], ... ]</code>
      *
+     * A differential document starts with the string "delta", removed
+     * oids have the type ASN_NULL and the value null:
+     * <code>[ "delta", [ ".1", 4, "bar" ], [ ".2", 5, null ] ]</code>
+     *
      * ParseExternalJson are not MT-safe.
      */
     class ParseExternalJson
+        : public ParseExternalOutput
     {
     public:
         /**
@@ -127,29 +58,27 @@ namespace SmartSnmpd
         virtual ~ParseExternalJson();
 
         /**
-         * parses content of specified string
-         *
-         * @param buf - string buffer containing json serialized content
+         * starts parsing a new document, previously parsed data is dropped
          *
          * @return int - 0 on success, -1 on error
          */
-        int parse(string const &buf);
-
+        virtual int begin();
         /**
-         * access the parsed data
+         * parses the next chunk of the json document
+         *
+         * @param data - pointer to the chunk
+         * @param length - length of the chunk
          *
-         * @return vector<ExternalDataTuple> const & - reference to vector containing the parsed data
+         * @return int - 0 on success, -1 on error
          */
-        inline vector<ExternalDataTuple> const & getData() const { return mData; }
-
+        virtual int feed(const char *data, size_t length);
         /**
-         * allows to reserve room to store expected data without reallocations during parsing
-         *
-         * @param n - amount of expected elements
+         * finishes parsing the json document
          *
-         * @return ParseExternalJson & - reference to this instance
+         * @return int - 0 when a complete document has been parsed, -1 on
+         *   error or when the document is incomplete
          */
-        inline ParseExternalJson & reserve(vector<ExternalDataTuple>::size_type n) { mData.reserve(n); return *this; }
+        virtual int end();
 
     protected:
         //! parser state
@@ -165,8 +94,6 @@ namespace SmartSnmpd
         struct json_parser mJsonParser;
         //! syntax format of next value to parse
         SmiUINT32 mSyntax;
-        //! parsed data
-        vector<ExternalDataTuple> mData;
 
         /**
          * parse routine called from json parser
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_PARSEEXTOUTPUT_H_INCLUDED__
+#define __SMART_SNMPD_PARSEEXTOUTPUT_H_INCLUDED__
+
+#include <smart-snmpd/smart-snmpd.h>
+#include <agent_pp/snmp_pp_ext.h>
+
+#include <string>
+#include <vector>
+
+namespace SmartSnmpd
+{
+    /**
+     * VarBind replacement for reusing on parsing
+     */
+    struct ExternalDataTuple
+    {
+        /**
+         * Oid part of the tuple
+         */
+        NS_AGENT Oidx Oid;
+        /**
+         * value part of the tuple - always owned by this instance, 0 for
+         * tuples removing the oid in a differential document
+         */
+        NS_SNMP SnmpSyntax *Datum;
+
+        /**
+         * default constructor
+         */
+        inline ExternalDataTuple()
+            : Oid()
+            , Datum(0)
+        {}
+
+        /**
+         * copy constructor - clones the Datum attribute of the source, if any
+         *
+         * @param ref - copy source
+         */
+        inline ExternalDataTuple(const ExternalDataTuple &ref)
+            : Oid( ref.Oid )
+            , Datum( ref.Datum ? ref.Datum->clone() : 0 )
+        {}
+
+        /**
+         * destructor
+         *
+         * owned Datum attribute is freed when the destructor is called
+         */
+        inline virtual ~ExternalDataTuple() { delete Datum; Datum = 0; }
+
+        /**
+         * assignes the attribute values of the referenced object to this object
+         *
+         * If the source object contains a Datum instance, this object
+         * will use a cloned copy of this instance.
+         *
+         * @param ref - reference to the instance to copy from
+         */
+        inline ExternalDataTuple & operator = (const ExternalDataTuple &ref)
+        {
+            if( &ref == this )
+                return *this;
+
+            Oid = ref.Oid;
+            delete Datum;
+            Datum = ref.Datum ? ref.Datum->clone() : 0;
+
+            return *this;
+        }
+
+        /**
+         * clears the content of this object
+         */
+        inline void clear()
+        {
+            Oid.clear();
+            delete Datum;
+            Datum = 0;
+        }
+    };
+
+    /**
+     * base class of the parsers for the output of external commands
+     *
+     * A document can be parsed at once by parse() or fed in chunks as
+     * they arrive using begin(), feed() and end() - no buffer for the
+     * complete document is needed then.
+     *
+     * A document is either complete or differential: a differential
+     * document contains only the tuples added, changed or removed since
+     * the previous document of the same command. Removed oids are sent
+     * with the type ASN_NULL and have no Datum.
+     *
+     * ParseExternalOutput are not MT-safe.
+     */
+    class ParseExternalOutput
+    {
+    public:
+        /**
+         * default constructor
+         */
+        ParseExternalOutput()
+            : mData()
+            , mFailed(false)
+            , mDelta(false)
+        {}
+        /**
+         * destructor
+         */
+        virtual ~ParseExternalOutput() {}
+
+        /**
+         * parses content of specified string
+         *
+         * @param buf - string buffer containing the serialized content
+         *
+         * @return int - 0 on success, -1 on error
+         */
+        inline int parse(string const &buf)
+        {
+            if( 0 != begin() )
+                return -1;
+
+            feed( buf.data(), buf.size() );
+
+            return end();
+        }
+
+        /**
+         * starts parsing a new document, previously parsed data is dropped
+         *
+         * @return int - 0 on success, -1 on error
+         */
+        virtual int begin() = 0;
+        /**
+         * parses the next chunk of the document
+         *
+         * Once an error occured, further chunks are ignored.
+         *
+         * @param data - pointer to the chunk
+         * @param length - length of the chunk
+         *
+         * @return int - 0 on success, -1 on error
+         */
+        virtual int feed(const char *data, size_t length) = 0;
+        /**
+         * finishes parsing the document
+         *
+         * @return int - 0 when a complete document has been parsed, -1 on
+         *   error or when the document is incomplete
+         */
+        virtual int end() = 0;
+
+        /**
+         * access the parsed data
+         *
+         * @return vector<ExternalDataTuple> const & - reference to vector containing the parsed data
+         */
+        inline vector<ExternalDataTuple> const & getData() const { return mData; }
+        /**
+         * tells whether the parsed document is differential
+         *
+         * @return bool - true when the document contains changes only
+         */
+        inline bool isDelta() const { return mDelta; }
+
+        /**
+         * allows to reserve room to store expected data without reallocations during parsing
+         *
+         * @param n - amount of expected elements
+         *
+         * @return ParseExternalOutput & - reference to this instance
+         */
+        inline ParseExternalOutput & reserve(vector<ExternalDataTuple>::size_type n) { mData.reserve(n); return *this; }
+
+    protected:
+        //! parsed data
+        vector<ExternalDataTuple> mData;
+        //! flag whether an error occured since begin()
+        bool mFailed;
+        //! flag whether the document is differential
+        bool mDelta;
+
+    private:
+        ParseExternalOutput(ParseExternalOutput const &);
+        ParseExternalOutput & operator = (ParseExternalOutput const &);
+    };
+}
+
+#endif /* __SMART_SNMPD_PARSEEXTOUTPUT_H_INCLUDED__ */
@@ -31,15 +31,24 @@ namespace SmartSnmpd
     class calc_diff<sg_cpu_stats>
     {
     public:
+        typedef sg_cpu_stats result_type;
+
         /**
          * diff operator for cpu statistics
          *
          * @param comperator - operand to compare against the most recent value
          * @param recent - the most recent value
+         * @param result - receives the calculated difference between given comperator and recent
+         */
+        inline void operator () ( sg_cpu_stats const &comperator, sg_cpu_stats const &recent, sg_cpu_stats &result ) const;
+
+        /**
+         * takes the statistics as they are
          *
-         * @return calculated difference between given comperator and recent
+         * @param recent - the most recent value
+         * @param result - receives the value
          */
-        inline sg_cpu_stats operator () ( sg_cpu_stats const &comperator, sg_cpu_stats const &recent ) const;
+        inline void assign( sg_cpu_stats const &recent, sg_cpu_stats &result ) const { result = recent; }
     };
 
     /**
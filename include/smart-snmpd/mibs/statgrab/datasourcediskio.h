@@ -33,15 +33,28 @@ namespace SmartSnmpd
     class calc_diff<sg_disk_io_stats *>
     {
     public:
+        typedef std::vector<sg_disk_io_stats> result_type;
+
         /**
          * diff operator for disk input/output statistics
          *
+         * Entries are matched by name, entries without counterpart in the
+         * comperator are taken as they are. Names of the result point into
+         * recent.
+         *
          * @param comperator - operand to compare against the most recent value
          * @param recent - the most recent value
+         * @param result - receives the calculated difference between given comperator and recent
+         */
+        inline void operator () ( sg_disk_io_stats * const &comperator, sg_disk_io_stats * const &recent, result_type &result ) const;
+
+        /**
+         * takes the statistics as they are
          *
-         * @return calculated difference between given comperator and recent
+         * @param recent - the most recent value
+         * @param result - receives a copy of the entries of recent
          */
-        inline sg_disk_io_stats * operator () ( sg_disk_io_stats * const &comperator, sg_disk_io_stats * const &recent ) const;
+        inline void assign( sg_disk_io_stats * const &recent, result_type &result ) const { result.assign( recent, recent + sg_get_nelements( recent ) ); }
     };
 
     /**
@@ -18,6 +18,7 @@
 #define __SMART_SNMPD_DATASOURCE_FILE_SYSTEM_H_INCLUDED__
 
 #include <smart-snmpd/mibs/statgrab/datasourcestatgrab.h>
+#include <smart-snmpd/mibs/statgrab/rowfilter.h>
 
 #include <agent_pp/mib.h>
 
@@ -69,11 +70,17 @@ namespace SmartSnmpd
         static void destroyInstance();
 
     protected:
+        /**
+         * selects the file systems put into smFileSystemTable
+         */
+        RowFilter mRowFilter;
+
         /**
          * default constructor
          */
         DataSourceFileSystem()
             : DataSourceStatgrab()
+            , mRowFilter()
         {}
 
 #if 0
@@ -19,13 +19,19 @@
 
 #include <smart-snmpd/mibs/statgrab/datasourcestatgrab.h>
 #include <smart-snmpd/datadiff.h>
+#include <smart-snmpd/ratehistory.h>
 
 #include <statgrab.h>
 
+#include <string>
+#include <vector>
+
 #include <agent_pp/mib.h>
 
 namespace SmartSnmpd
 {
+    class NetworkIoMib;
+
     /**
      * specialization to calculate differences between two sg_network_io_stats vectors
      */
@@ -33,15 +39,28 @@ namespace SmartSnmpd
     class calc_diff<sg_network_io_stats *>
     {
     public:
+        typedef std::vector<sg_network_io_stats> result_type;
+
         /**
          * diff operator for network input/output statistics
          *
+         * Entries are matched by name, entries without counterpart in the
+         * comperator are taken as they are. Names of the result point into
+         * recent.
+         *
          * @param comperator - operand to compare against the most recent value
          * @param recent - the most recent value
+         * @param result - receives the calculated difference between given comperator and recent
+         */
+        inline void operator () ( sg_network_io_stats * const &comperator, sg_network_io_stats * const &recent, result_type &result ) const;
+
+        /**
+         * takes the statistics as they are
          *
-         * @return calculated difference between given comperator and recent
+         * @param recent - the most recent value
+         * @param result - receives a copy of the entries of recent
          */
-        inline sg_network_io_stats * operator () ( sg_network_io_stats * const &comperator, sg_network_io_stats * const &recent ) const;
+        inline void assign( sg_network_io_stats * const &recent, result_type &result ) const { result.assign( recent, recent + sg_get_nelements( recent ) ); }
     };
 
     /**
@@ -112,14 +131,46 @@ namespace SmartSnmpd
         static void destroyInstance();
 
     protected:
+        /**
+         * rates of an interface aggregated over the configured windows
+         */
+        struct InterfaceRates
+        {
+            std::string Name;
+            //! counters of the previous update
+            unsigned long long LastTx, LastRx;
+            //! monotonic time of the previous update in milliseconds
+            unsigned long long LastUpdate;
+            //! flag whether the interface has been seen during the current update
+            bool Seen;
+            //! transmitted/received bytes per second
+            RateHistory Tx, Rx;
+        };
+
         /**
          * default constructor
          */
         DataSourceNetworkIO()
             : DataSourceStatgrab()
             , DataDiff< sg_network_io_stats * >()
+            , mInterfaceRates()
         {}
 
+        /**
+         * adds the rates since the previous update to the windows of each
+         * interface and fills the rate table
+         *
+         * @param networkIoStats - current network i/o statistics
+         * @param entries - number of elements in networkIoStats
+         * @param networkIoMib - the mib to fill
+         */
+        void updateRates( sg_network_io_stats const *networkIoStats, size_t entries, NetworkIoMib &networkIoMib );
+
+        /**
+         * rates of the known interfaces - dropped when the configuration changes
+         */
+        std::vector<InterfaceRates> mInterfaceRates;
+
         /**
          * initialize controlled mib object
          *
@@ -17,11 +17,17 @@
 #ifndef __SMART_SNMPD_DATASOURCE_PROCESS_H_INCLUDED__
 #define __SMART_SNMPD_DATASOURCE_PROCESS_H_INCLUDED__
 
+#include <smart-snmpd/oids.h>
 #include <smart-snmpd/mibs/statgrab/datasourcestatgrab.h>
+#include <smart-snmpd/mibs/statgrab/mibprocess.h>
+#include <smart-snmpd/mibs/statgrab/procfsprocess.h>
+#include <smart-snmpd/mibs/statgrab/rowfilter.h>
 #include <smart-snmpd/pwent.h>
 
 #include <agent_pp/mib.h>
 
+#include <map>
+
 namespace SmartSnmpd
 {
     /**
@@ -51,8 +57,9 @@ namespace SmartSnmpd
          * updates the managed mib object
          *
          * This method fetches the current process statistics via the
-         * sg_get_process_stats function from the statgrab library and updates
-         * the desired mib leafs.
+         * sg_get_process_stats function from the statgrab library or, when
+         * configured and available, directly from /proc and updates the
+         * desired mib leafs.
          *
          * @return bool - true when successful, false otherwise
          */
@@ -70,23 +77,116 @@ namespace SmartSnmpd
         static void destroyInstance();
 
     protected:
-#if 0
+        /**
+         * row of a process in mProcessRows and the values it has been
+         * derived from, remembered between two refreshes
+         */
+        struct ProcessCacheEntry
+        {
+            time_t StartTime;
+            uid_t Uid;
+            gid_t Gid;
+            uid_t EffectiveUid;
+            gid_t EffectiveGid;
+            double CpuPercent;
+            unsigned long Generation;
+            //! position of the row in mProcessRows, noRow when there is none
+            std::vector<unsigned long>::size_type RowPos;
+            ProcessDetails Details;
+        };
+
+        //! ProcessCacheEntry::RowPos of processes without a row
+        static const std::vector<unsigned long>::size_type noRow = (std::vector<unsigned long>::size_type)(-1);
+
         /**
          * system user information accessor
          */
         SystemUserInfo mSysUserInfo;
-#endif
+        /**
+         * derived row data by process id
+         */
+        std::map<pid_t, ProcessCacheEntry> mProcessCache;
+        /**
+         * rows of smProcessTable indexed by process id, updated in place
+         * and copied into the content on each refresh
+         */
+        MibObject::ContentManagerType mProcessRows;
+        /**
+         * columns mProcessCache and mProcessRows have been filled for
+         */
+        std::vector<unsigned long> mProcessCacheColumns;
+        /**
+         * generation counter of refreshes, used to detect exited processes
+         */
+        unsigned long mGeneration;
+        /**
+         * collector used instead of libstatgrab for process-collector = procfs
+         */
+        ProcfsProcessCollector mProcfsCollector;
+        /**
+         * selects the processes put into smProcessTable
+         */
+        RowFilter mRowFilter;
+        /**
+         * processes eligible for the top process tables, valid during updateMibObj() only
+         */
+        std::vector<sg_process_stats const *> mTopCandidates;
+        /**
+         * working copy of mTopCandidates partially sorted for one ranking
+         */
+        std::vector<sg_process_stats const *> mTopRanking;
 
         /**
          * default constructor
          */
         DataSourceProcess()
             : DataSourceStatgrab()
-#if 0
             , mSysUserInfo()
-#endif
+            , mProcessCache()
+            , mProcessRows( SM_PROCESS_STATUS )
+            , mProcessCacheColumns()
+            , mGeneration(0)
+            , mProcfsCollector()
+            , mRowFilter()
+            , mTopCandidates()
+            , mTopRanking()
         {}
 
+        /**
+         * adds the top process tables for the collected candidates
+         *
+         * Each ranking selects its first rows with std::nth_element in
+         * linear time and sorts only those, the whole process list is
+         * never sorted.
+         *
+         * @param processMib - mib content receiving the rows
+         * @param count - number of rows per ranking
+         */
+        void addTopRows( ProcessMib &processMib, size_t count );
+
+        /**
+         * adds or updates the row of the given process in mProcessRows
+         *
+         * The derived data of processes known from the previous refresh
+         * (same process id and start time) is reused, only values which
+         * changed are re-resolved or re-formatted, and only cells whose
+         * value changed are written. Values of columns which aren't
+         * published are left empty.
+         *
+         * @param rows - table view of mProcessRows
+         * @param proc - statistics of the process
+         * @param cfg - configuration of the managed mib object
+         */
+        void updateProcessRow( MibObject::ContentManagerType::TableType &rows, sg_process_stats const &proc, MibObjectConfig const &cfg );
+
+        /**
+         * removes the rows and the derived data of processes which weren't
+         * seen (or filtered out) during the current refresh
+         *
+         * @param rows - storage of mProcessRows
+         */
+        void expireProcessCache( MibContainerTableData &rows );
+
 #if 0
         /**
          * initialize controlled mib object
@@ -33,15 +33,24 @@ namespace SmartSnmpd
     class calc_diff<sg_page_stats>
     {
     public:
+        typedef sg_page_stats result_type;
+
         /**
          * diff operator for swap input/ouput statistics
          *
          * @param comperator - operand to compare against the most recent value
          * @param recent - the most recent value
+         * @param result - receives the calculated difference between given comperator and recent
+         */
+        inline void operator () ( sg_page_stats const &comperator, sg_page_stats const &recent, sg_page_stats &result ) const;
+
+        /**
+         * takes the statistics as they are
          *
-         * @return calculated difference between given comperator and recent
+         * @param recent - the most recent value
+         * @param result - receives the value
          */
-        inline sg_page_stats operator () ( sg_page_stats const &comperator, sg_page_stats const &recent ) const;
+        inline void assign( sg_page_stats const &recent, sg_page_stats &result ) const { result = recent; }
     };
 
     /**
@@ -29,7 +29,7 @@ namespace SmartSnmpd
         virtual ~CpuMib() {}
 
         virtual CpuMib &setTotalCpuStats( sg_cpu_stats const &cpuStats ) = 0;
-        virtual CpuMib &setIntervalCpuStats( unsigned long long fromSecsSinceEpoch, unsigned long long untilSecsSinceEpoch, sg_cpu_stats const &cpuStats ) = 0;
+        virtual CpuMib &setIntervalCpuStats( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch, sg_cpu_stats const &cpuStats ) = 0;
         virtual CpuMib &setUpdateTimestamp( unsigned long long secsSinceEpoch ) = 0;
 
     protected:
@@ -59,6 +59,8 @@ namespace SmartSnmpd
 
             , mIntervalFrom( aCntMgr, SM_CPU_INTERVAL_FROM_KEY )
             , mIntervalUntil( aCntMgr, SM_CPU_INTERVAL_UNTIL_KEY )
+            , mIntervalFromMs( aCntMgr, SM_CPU_INTERVAL_FROM_MS_KEY )
+            , mIntervalUntilMs( aCntMgr, SM_CPU_INTERVAL_UNTIL_MS_KEY )
 
             , mIntervalUserTime( aCntMgr, SM_CPU_USER_TIME_INTERVAL_KEY )
             , mIntervalKernelTime( aCntMgr, SM_CPU_KERNEL_TIME_INTERVAL_KEY )
@@ -109,10 +111,12 @@ namespace SmartSnmpd
             return *this;
         }
 
-        virtual CpuMib &setIntervalCpuStats( unsigned long long fromSecsSinceEpoch, unsigned long long untilSecsSinceEpoch, sg_cpu_stats const &cpuStats )
+        virtual CpuMib &setIntervalCpuStats( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch, sg_cpu_stats const &cpuStats )
         {
-            mIntervalFrom.set( fromSecsSinceEpoch );
-            mIntervalUntil.set( untilSecsSinceEpoch );
+            mIntervalFrom.set( fromMsSinceEpoch / 1000 );
+            mIntervalUntil.set( untilMsSinceEpoch / 1000 );
+            mIntervalFromMs.set( fromMsSinceEpoch );
+            mIntervalUntilMs.set( untilMsSinceEpoch );
 
             mIntervalUserTime.set( cpuStats.user );
             mIntervalKernelTime.set( cpuStats.kernel );
@@ -157,6 +161,8 @@ namespace SmartSnmpd
 
         MibObject::ContentManagerType::LeafType mIntervalFrom;
         MibObject::ContentManagerType::LeafType mIntervalUntil;
+        MibObject::ContentManagerType::LeafType mIntervalFromMs;
+        MibObject::ContentManagerType::LeafType mIntervalUntilMs;
 
         MibObject::ContentManagerType::LeafType mIntervalUserTime;
         MibObject::ContentManagerType::LeafType mIntervalKernelTime;
@@ -19,6 +19,7 @@
 
 #include <smart-snmpd/mibs/statgrab/datasourcedaemonstatus.h>
 #include <smart-snmpd/mibobject.h>
+#include <smart-snmpd/updatescheduler.h>
 
 #include <statgrab.h>
 
@@ -35,6 +36,7 @@ namespace SmartSnmpd
         virtual DaemonStatusMib & setHandledRequests( unsigned long long reqs ) = 0;
         virtual DaemonStatusMib & setDaemonUptime( unsigned long long secs ) = 0;
         virtual DaemonStatusMib & setDaemonCpuTime( unsigned long long secs ) = 0;
+        virtual DaemonStatusMib & addUpdateJob( std::string const &mibObjectOid, UpdateJobStatus const &status, UpdateTime now ) = 0;
 
         virtual DaemonStatusMib & setUpdateTimestamp( unsigned long long secsSinceEpoch ) = 0;
 
@@ -64,6 +66,7 @@ namespace SmartSnmpd
             , mHandledRequests( aCntMgr, SM_HANDLED_REQUESTS_KEY )
             , mDaemonUptime( aCntMgr, SM_DAEMON_UPTIME_KEY )
             , mDaemonCpuTime( aCntMgr, SM_DAEMON_CPUTIME_KEY )
+            , mUpdateJobs( aCntMgr, SM_UPDATE_JOB_TABLE_KEY, 7 )
         {}
 
         virtual ~SmartSnmpdDaemonStatusMib() {}
@@ -113,6 +116,22 @@ namespace SmartSnmpd
             return *this;
         }
 
+        virtual DaemonStatusMib & addUpdateJob( std::string const &mibObjectOid, UpdateJobStatus const &status, UpdateTime now )
+        {
+            MibObject::ContentManagerType::TableType::RowType row = mUpdateJobs.addRow();
+
+            // times are published relative to now, the scheduler clock has no meaningful origin
+            row.setCurrentColumn( Counter64( row.getCurrentRowIndex() ) )
+               .setCurrentColumn( mibObjectOid )
+               .setCurrentColumn( Counter64( ( status.Running || ( status.NextRun <= now ) ) ? 0 : status.NextRun - now ) )
+               .setCurrentColumn( Counter64( status.Runs ? now - status.LastRun : 0 ) )
+               .setCurrentColumn( Counter64( status.LastDuration ) )
+               .setCurrentColumn( Counter64( status.Runs ) )
+               .setCurrentColumn( SnmpUInt32( status.Running ? 1 : 0 ) );
+
+            return *this;
+        }
+
         virtual DaemonStatusMib & setUpdateTimestamp( unsigned long long secsSinceEpoch )
         {
             mUpdateTimestamp.set( secsSinceEpoch );
@@ -140,6 +159,8 @@ namespace SmartSnmpd
         MibObject::ContentManagerType::LeafType mHandledRequests;
         MibObject::ContentManagerType::LeafType mDaemonUptime;
         MibObject::ContentManagerType::LeafType mDaemonCpuTime;
+
+        MibObject::ContentManagerType::TableType mUpdateJobs;
     };
 }
 
@@ -30,7 +30,7 @@ namespace SmartSnmpd
 
         virtual DiskIoMib & setCount( unsigned long long nelem ) = 0;
         virtual DiskIoMib & addTotalRow( sg_disk_io_stats const &diskIo ) = 0;
-        virtual DiskIoMib & setIntervalSpec( time_t fromSecsSinceEpoch, time_t untilSecsSinceEpoch ) = 0;
+        virtual DiskIoMib & setIntervalSpec( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch ) = 0;
         virtual DiskIoMib & addIntervalRow( sg_disk_io_stats const &diskIo ) = 0;
         virtual DiskIoMib & setUpdateTimestamp( unsigned long long secsSinceEpoch ) = 0;
 
@@ -49,6 +49,8 @@ namespace SmartSnmpd
             , mTotalIoStats( aCntMgr, SM_DISK_IO_TOTAL_TABLE_KEY, 4 )
             , mIntervalFrom( aCntMgr, SM_DISK_IO_INTERVAL_FROM_KEY )
             , mIntervalUntil( aCntMgr, SM_DISK_IO_INTERVAL_UNTIL_KEY )
+            , mIntervalFromMs( aCntMgr, SM_DISK_IO_INTERVAL_FROM_MS_KEY )
+            , mIntervalUntilMs( aCntMgr, SM_DISK_IO_INTERVAL_UNTIL_MS_KEY )
             , mIntervalIoStats( aCntMgr, SM_DISK_IO_INTERVAL_TABLE_KEY, 4 )
         {}
 
@@ -73,10 +75,12 @@ namespace SmartSnmpd
             return *this;
         }
 
-        virtual DiskIoMib & setIntervalSpec( time_t fromSecsSinceEpoch, time_t untilSecsSinceEpoch )
+        virtual DiskIoMib & setIntervalSpec( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch )
         {
-            mIntervalFrom.set( fromSecsSinceEpoch );
-            mIntervalUntil.set( untilSecsSinceEpoch );
+            mIntervalFrom.set( fromMsSinceEpoch / 1000 );
+            mIntervalUntil.set( untilMsSinceEpoch / 1000 );
+            mIntervalFromMs.set( fromMsSinceEpoch );
+            mIntervalUntilMs.set( untilMsSinceEpoch );
 
             return *this;
         }
@@ -108,6 +112,8 @@ namespace SmartSnmpd
 
         MibObject::ContentManagerType::LeafType mIntervalFrom;
         MibObject::ContentManagerType::LeafType mIntervalUntil;
+        MibObject::ContentManagerType::LeafType mIntervalFromMs;
+        MibObject::ContentManagerType::LeafType mIntervalUntilMs;
         MibObject::ContentManagerType::TableType mIntervalIoStats;
 
     private:
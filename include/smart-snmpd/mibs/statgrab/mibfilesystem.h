@@ -40,12 +40,16 @@ namespace SmartSnmpd
         : public FilesystemMib
     {
     public:
-        SmartSnmpdFilesystemMib( MibObject::ContentManagerType &aCntMgr )
+        SmartSnmpdFilesystemMib( MibObject::ContentManagerType &aCntMgr, RowIndexing aRowIndexing = rowIndexSequential,
+                                 std::vector<unsigned long> const &aColumns = std::vector<unsigned long>() )
             : FilesystemMib()
+            , mRowIndexing( aRowIndexing )
             , mUpdateTimestamp( aCntMgr, SM_LAST_UPDATE_MIB_KEY )
             , mRowCount( aCntMgr, SM_FILE_SYSTEM_COUNT_KEY )
             , mFsStats( aCntMgr, SM_FILE_SYSTEM_TABLE_KEY, 20 )
-        {}
+        {
+            mFsStats.setEnabledColumns( aColumns );
+        }
 
         virtual ~SmartSnmpdFilesystemMib() {}
 
@@ -57,26 +61,30 @@ namespace SmartSnmpd
 
         virtual FilesystemMib & addRow( sg_fs_stats const &fs )
         {
-            mFsStats.addRow().setCurrentColumn( Counter64( mFsStats.getLastRowIndex() + 1 ) )
-                             .setCurrentColumn( fs.mnt_point ? OctetStr( fs.mnt_point ) : OctetStr() )
-                             .setCurrentColumn( fs.device_name ? OctetStr( fs.device_name ) : OctetStr() )
-                             .setCurrentColumn() // mount options aren't determined at the moment
-                             .setCurrentColumn( fs.fs_type ? OctetStr( fs.fs_type ) : OctetStr() )
-                             .setCurrentColumn( SnmpUInt32( (unsigned)(fs.device_type) ) )
-                             .setCurrentColumn( Counter64(fs.size) )
-                             .setCurrentColumn( Counter64(fs.used) )
-                             .setCurrentColumn( Counter64(fs.free) ) // XXX was: fs.size - fs.used
-                             .setCurrentColumn( Counter64(fs.avail) )
-                             .setCurrentColumn( Counter64(fs.total_inodes) )
-                             .setCurrentColumn( Counter64(fs.used_inodes) )
-                             .setCurrentColumn( Counter64(fs.free_inodes) )
-                             .setCurrentColumn( Counter64(fs.avail_inodes) )
-                             .setCurrentColumn( Counter64(fs.total_blocks) )
-                             .setCurrentColumn( Counter64(fs.used_blocks) )
-                             .setCurrentColumn( Counter64(fs.free_blocks) )
-                             .setCurrentColumn( Counter64(fs.avail_blocks) )
-                             .setCurrentColumn( Counter64(fs.block_size) )
-                             .setCurrentColumn( Counter64(fs.io_size) );
+            MibObject::ContentManagerType::TableType::RowType row = ( mRowIndexing == rowIndexStable )
+                                                                  ? mFsStats.addRow( rowKey( fs ) )
+                                                                  : mFsStats.addRow();
+
+            row.setCurrentColumn( Counter64( row.getCurrentRowIndex() ) )
+               .setCurrentColumn( fs.mnt_point )
+               .setCurrentColumn( fs.device_name )
+               .setCurrentColumn() // mount options aren't determined at the moment
+               .setCurrentColumn( fs.fs_type )
+               .setCurrentColumn( SnmpUInt32( (unsigned)(fs.device_type) ) )
+               .setCurrentColumn( Counter64(fs.size) )
+               .setCurrentColumn( Counter64(fs.used) )
+               .setCurrentColumn( Counter64(fs.free) ) // XXX was: fs.size - fs.used
+               .setCurrentColumn( Counter64(fs.avail) )
+               .setCurrentColumn( Counter64(fs.total_inodes) )
+               .setCurrentColumn( Counter64(fs.used_inodes) )
+               .setCurrentColumn( Counter64(fs.free_inodes) )
+               .setCurrentColumn( Counter64(fs.avail_inodes) )
+               .setCurrentColumn( Counter64(fs.total_blocks) )
+               .setCurrentColumn( Counter64(fs.used_blocks) )
+               .setCurrentColumn( Counter64(fs.free_blocks) )
+               .setCurrentColumn( Counter64(fs.avail_blocks) )
+               .setCurrentColumn( Counter64(fs.block_size) )
+               .setCurrentColumn( Counter64(fs.io_size) );
 
             return *this;
         }
@@ -87,7 +95,23 @@ namespace SmartSnmpd
             return *this;
         }
 
+        /**
+         * key the stable row index of a file system is derived from:
+         * the mount point, the device name when there is none
+         */
+        static std::string rowKey( sg_fs_stats const &fs )
+        {
+            if( fs.mnt_point )
+                return fs.mnt_point;
+            if( fs.device_name )
+                return std::string( "device:" ) + fs.device_name;
+
+            return std::string();
+        }
+
     protected:
+        RowIndexing mRowIndexing;
+
         MibObject::ContentManagerType::LeafType mUpdateTimestamp;
         MibObject::ContentManagerType::LeafType mRowCount;
         MibObject::ContentManagerType::TableType mFsStats;
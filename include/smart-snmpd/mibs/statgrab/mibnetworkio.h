@@ -18,9 +18,12 @@
 #define __SMART_SNMPD_MIB_NETWORKIO_H_INCLUDED__
 
 #include <smart-snmpd/mibobject.h>
+#include <smart-snmpd/ratehistory.h>
 
 #include <statgrab.h>
 
+#include <net/if.h>
+
 namespace SmartSnmpd
 {
     class NetworkIoMib
@@ -30,8 +33,9 @@ namespace SmartSnmpd
 
         virtual NetworkIoMib & setCount( unsigned long long nelem ) = 0;
         virtual NetworkIoMib & addTotalRow( sg_network_io_stats const &networkIo ) = 0;
-        virtual NetworkIoMib & setIntervalSpec( unsigned long long fromSecsSinceEpoch, unsigned long long untilSecsSinceEpoch ) = 0;
+        virtual NetworkIoMib & setIntervalSpec( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch ) = 0;
         virtual NetworkIoMib & addIntervalRow( sg_network_io_stats const &networkIo ) = 0;
+        virtual NetworkIoMib & addRateRow( char const *interfaceName, unsigned long windowMs, RateHistory::Summary const &tx, RateHistory::Summary const &rx ) = 0;
         virtual NetworkIoMib & setUpdateTimestamp( unsigned long long secsSinceEpoch ) = 0;
 
     protected:
@@ -42,15 +46,24 @@ namespace SmartSnmpd
         : public NetworkIoMib
     {
     public:
-        SmartSnmpdNetworkIoMib( MibObject::ContentManagerType &aCntMgr )
+        SmartSnmpdNetworkIoMib( MibObject::ContentManagerType &aCntMgr, RowIndexing aRowIndexing = rowIndexSequential,
+                                std::vector<unsigned long> const &aColumns = std::vector<unsigned long>() )
             : NetworkIoMib()
+            , mRowIndexing( aRowIndexing )
             , mUpdateTimestamp( aCntMgr, SM_LAST_UPDATE_MIB_KEY )
             , mRowCount( aCntMgr, SM_NETWORK_IO_COUNT_KEY )
             , mTotalIoStats( aCntMgr, SM_NETWORK_IO_TABLE_KEY, 9 )
             , mIntervalFrom( aCntMgr, SM_NETWORK_IO_INTERVAL_FROM_KEY )
             , mIntervalUntil( aCntMgr, SM_NETWORK_IO_INTERVAL_UNTIL_KEY )
+            , mIntervalFromMs( aCntMgr, SM_NETWORK_IO_INTERVAL_FROM_MS_KEY )
+            , mIntervalUntilMs( aCntMgr, SM_NETWORK_IO_INTERVAL_UNTIL_MS_KEY )
             , mIntervalIoStats( aCntMgr, SM_NETWORK_IO_INTERVAL_TABLE_KEY, 9 )
-        {}
+            , mRates( aCntMgr, SM_NETWORK_IO_RATE_TABLE_KEY, 12 )
+        {
+            // the total and interval table share their layout, the rate table isn't restricted
+            mTotalIoStats.setEnabledColumns( aColumns );
+            mIntervalIoStats.setEnabledColumns( aColumns );
+        }
 
         virtual ~SmartSnmpdNetworkIoMib() {}
 
@@ -64,24 +77,28 @@ namespace SmartSnmpd
         {
             if( networkIo.interface_name )
             {
-                mTotalIoStats.addRow().setCurrentColumn( Counter64( mTotalIoStats.getLastRowIndex() + 1 ) )
-                                      .setCurrentColumn( OctetStr( networkIo.interface_name ) )
-                                      .setCurrentColumn( Counter64( networkIo.tx ) )
-                                      .setCurrentColumn( Counter64( networkIo.rx ) )
-                                      .setCurrentColumn( Counter64( networkIo.ipackets ) )
-                                      .setCurrentColumn( Counter64( networkIo.opackets ) )
-                                      .setCurrentColumn( Counter64( networkIo.ierrors ) )
-                                      .setCurrentColumn( Counter64( networkIo.oerrors ) )
-                                      .setCurrentColumn( Counter64( networkIo.collisions ) );
+                MibObject::ContentManagerType::TableType::RowType row = addRow( mTotalIoStats, networkIo );
+
+                row.setCurrentColumn( Counter64( row.getCurrentRowIndex() ) )
+                   .setCurrentColumn( networkIo.interface_name )
+                   .setCurrentColumn( Counter64( networkIo.tx ) )
+                   .setCurrentColumn( Counter64( networkIo.rx ) )
+                   .setCurrentColumn( Counter64( networkIo.ipackets ) )
+                   .setCurrentColumn( Counter64( networkIo.opackets ) )
+                   .setCurrentColumn( Counter64( networkIo.ierrors ) )
+                   .setCurrentColumn( Counter64( networkIo.oerrors ) )
+                   .setCurrentColumn( Counter64( networkIo.collisions ) );
             }
 
             return *this;
         }
 
-        virtual NetworkIoMib & setIntervalSpec( unsigned long long fromSecsSinceEpoch, unsigned long long untilSecsSinceEpoch )
+        virtual NetworkIoMib & setIntervalSpec( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch )
         {
-            mIntervalFrom.set( fromSecsSinceEpoch );
-            mIntervalUntil.set( untilSecsSinceEpoch );
+            mIntervalFrom.set( fromMsSinceEpoch / 1000 );
+            mIntervalUntil.set( untilMsSinceEpoch / 1000 );
+            mIntervalFromMs.set( fromMsSinceEpoch );
+            mIntervalUntilMs.set( untilMsSinceEpoch );
 
             return *this;
         }
@@ -90,20 +107,42 @@ namespace SmartSnmpd
         {
             if( networkIo.interface_name )
             {
-                mIntervalIoStats.addRow().setCurrentColumn( Counter64( mIntervalIoStats.getLastRowIndex() + 1 ) )
-                                         .setCurrentColumn( OctetStr( networkIo.interface_name ) )
-                                         .setCurrentColumn( Counter64( networkIo.tx ) )
-                                         .setCurrentColumn( Counter64( networkIo.rx ) )
-                                         .setCurrentColumn( Counter64( networkIo.ipackets ) )
-                                         .setCurrentColumn( Counter64( networkIo.opackets ) )
-                                         .setCurrentColumn( Counter64( networkIo.ierrors ) )
-                                         .setCurrentColumn( Counter64( networkIo.oerrors ) )
-                                         .setCurrentColumn( Counter64( networkIo.collisions ) );
+                MibObject::ContentManagerType::TableType::RowType row = addRow( mIntervalIoStats, networkIo );
+
+                row.setCurrentColumn( Counter64( row.getCurrentRowIndex() ) )
+                   .setCurrentColumn( networkIo.interface_name )
+                   .setCurrentColumn( Counter64( networkIo.tx ) )
+                   .setCurrentColumn( Counter64( networkIo.rx ) )
+                   .setCurrentColumn( Counter64( networkIo.ipackets ) )
+                   .setCurrentColumn( Counter64( networkIo.opackets ) )
+                   .setCurrentColumn( Counter64( networkIo.ierrors ) )
+                   .setCurrentColumn( Counter64( networkIo.oerrors ) )
+                   .setCurrentColumn( Counter64( networkIo.collisions ) );
             }
 
             return *this;
         }
 
+        virtual NetworkIoMib & addRateRow( char const *interfaceName, unsigned long windowMs, RateHistory::Summary const &tx, RateHistory::Summary const &rx )
+        {
+            MibObject::ContentManagerType::TableType::RowType row = mRates.addRow();
+
+            row.setCurrentColumn( Counter64( row.getCurrentRowIndex() ) )
+               .setCurrentColumn( OctetStr( interfaceName ) )
+               .setCurrentColumn( Counter64( windowMs / 1000 ) )
+               .setCurrentColumn( Counter64( tx.Samples ) )
+               .setCurrentColumn( Counter64( tx.Min ) )
+               .setCurrentColumn( Counter64( tx.Avg ) )
+               .setCurrentColumn( Counter64( tx.Max ) )
+               .setCurrentColumn( Counter64( tx.Percentile ) )
+               .setCurrentColumn( Counter64( rx.Min ) )
+               .setCurrentColumn( Counter64( rx.Avg ) )
+               .setCurrentColumn( Counter64( rx.Max ) )
+               .setCurrentColumn( Counter64( rx.Percentile ) );
+
+            return *this;
+        }
+
         virtual NetworkIoMib & setUpdateTimestamp( unsigned long long secsSinceEpoch )
         {
             mUpdateTimestamp.set( secsSinceEpoch );
@@ -111,6 +150,8 @@ namespace SmartSnmpd
         }
 
     protected:
+        RowIndexing mRowIndexing;
+
         MibObject::ContentManagerType::LeafType mUpdateTimestamp;
         MibObject::ContentManagerType::LeafType mRowCount;
 
@@ -118,8 +159,31 @@ namespace SmartSnmpd
 
         MibObject::ContentManagerType::LeafType mIntervalFrom;
         MibObject::ContentManagerType::LeafType mIntervalUntil;
+        MibObject::ContentManagerType::LeafType mIntervalFromMs;
+        MibObject::ContentManagerType::LeafType mIntervalUntilMs;
         MibObject::ContentManagerType::TableType mIntervalIoStats;
 
+        MibObject::ContentManagerType::TableType mRates;
+
+        /**
+         * adds a row for the given interface to the specified table -
+         * indexed by the interface index when stable indexing is requested
+         */
+        MibObject::ContentManagerType::TableType::RowType addRow( MibObject::ContentManagerType::TableType &table, sg_network_io_stats const &networkIo )
+        {
+            if( mRowIndexing == rowIndexStable )
+            {
+                unsigned int ifIdx = if_nametoindex( networkIo.interface_name );
+                if( ifIdx )
+                    return table.addRow( (unsigned long)ifIdx );
+
+                // interface vanished meanwhile or isn't a kernel interface
+                return table.addRow( std::string( networkIo.interface_name ) );
+            }
+
+            return table.addRow();
+        }
+
     private:
         SmartSnmpdNetworkIoMib();
     };
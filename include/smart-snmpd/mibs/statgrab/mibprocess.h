@@ -27,13 +27,42 @@
 
 namespace SmartSnmpd
 {
+    /**
+     * values of a process table row which are derived from the raw
+     * process statistics (resolved names, formatted values)
+     */
+    struct ProcessDetails
+    {
+        std::string UserName;
+        std::string GroupName;
+        std::string EffectiveUserName;
+        std::string EffectiveGroupName;
+        std::string CpuPercent;
+    };
+
+    /**
+     * rankings of the processes with the highest resource usage
+     */
+    enum ProcessTopList
+    {
+        //! by cpu_percent (smProcessTopCpuTable)
+        processTopCpu,
+        //! by proc_resident (smProcessTopRSizeTable)
+        processTopResident,
+        //! by time_spent (smProcessTopCpuTimeTable)
+        processTopCpuTime,
+        //! number of rankings
+        processTopListCount
+    };
+
     class ProcessMib
     {
     public:
         virtual ~ProcessMib() {}
 
         virtual ProcessMib & setCounts( sg_process_count const &procCounts ) = 0;
-        virtual ProcessMib & addRow( sg_process_stats const &proc ) = 0;
+        virtual ProcessMib & setRows( MibObject::ContentManagerType::TableType const &rows ) = 0;
+        virtual ProcessMib & addTopRow( ProcessTopList list, sg_process_stats const &proc, std::string const &userName ) = 0;
         virtual ProcessMib & setUpdateTimestamp( unsigned long long secsSinceEpoch ) = 0;
 
     protected:
@@ -44,9 +73,10 @@ namespace SmartSnmpd
         : public ProcessMib
     {
     public:
-        SmartSnmpdProcessMib( MibObject::ContentManagerType &aCntMgr )
+        SmartSnmpdProcessMib( MibObject::ContentManagerType &aCntMgr, RowIndexing aRowIndexing = rowIndexSequential,
+                              std::vector<unsigned long> const &aColumns = std::vector<unsigned long>() )
             : ProcessMib()
-            , mSysUserInfo()
+            , mRowIndexing( aRowIndexing )
             , mUpdateTimestamp( aCntMgr, SM_LAST_UPDATE_MIB_KEY )
             , mTotalProcCount( aCntMgr, SM_PROCESS_TOTAL_KEY )
             , mRunningProcCount( aCntMgr, SM_PROCESS_RUNNING_KEY )
@@ -54,7 +84,13 @@ namespace SmartSnmpd
             , mStoppedProcCount( aCntMgr, SM_PROCESS_STOPPED_KEY )
             , mZombieProcCount( aCntMgr, SM_PROCESS_ZOMBIE_KEY )
             , mProcList( aCntMgr, SM_PROCESS_TABLE_KEY, 19 )
-        {}
+            , mTopCpu( aCntMgr, SM_PROCESS_TOP_CPU_TABLE_KEY, 7 )
+            , mTopResident( aCntMgr, SM_PROCESS_TOP_RSIZE_TABLE_KEY, 7 )
+            , mTopCpuTime( aCntMgr, SM_PROCESS_TOP_CPU_TIME_TABLE_KEY, 7 )
+        {
+            // the rankings are small, only the process table is restricted
+            mProcList.setEnabledColumns( aColumns );
+        }
 
         virtual ~SmartSnmpdProcessMib() {}
 
@@ -69,27 +105,69 @@ namespace SmartSnmpd
             return *this;
         }
 
-        virtual ProcessMib & addRow( sg_process_stats const &proc )
+        /**
+         * publishes the rows of smProcessTable maintained by the data source
+         *
+         * The rows are indexed by the process id, for sequential row
+         * indexing they're renumbered in that order.
+         *
+         * @param rows - rows filled by setRowColumns()
+         */
+        virtual ProcessMib & setRows( MibObject::ContentManagerType::TableType const &rows )
         {
-            mProcList.addRow().setCurrentColumn( SnmpUInt32(proc.pid) )
-                              .setCurrentColumn( SnmpUInt32(proc.parent) )
-                              .setCurrentColumn( proc.process_name ? OctetStr(proc.process_name) : OctetStr() )
-                              .setCurrentColumn( proc.proctitle ? OctetStr(proc.proctitle) : OctetStr() )
-                              .setCurrentColumn( SnmpUInt32(proc.state) )
-                              .setCurrentColumn( Counter64( proc.proc_size ) )
-                              .setCurrentColumn( Counter64( proc.proc_resident ) )
-                              .setCurrentColumn( Counter64( proc.start_time ) )
-                              .setCurrentColumn( Counter64( proc.time_spent ) )
-                              .setCurrentColumn( SnmpUInt32( proc.uid ) )
-                              .setCurrentColumn( mSysUserInfo.getusernamebyuid( proc.uid ) )
-                              .setCurrentColumn( SnmpUInt32( proc.gid ) )
-                              .setCurrentColumn( mSysUserInfo.getgroupnamebygid( proc.gid ) )
-                              .setCurrentColumn( SnmpUInt32( proc.euid ) )
-                              .setCurrentColumn( mSysUserInfo.getusernamebyuid( proc.euid ) )
-                              .setCurrentColumn( SnmpUInt32( proc.egid ) )
-                              .setCurrentColumn( mSysUserInfo.getgroupnamebygid( proc.egid ) )
-                              .setCurrentColumn( SnmpInt32( proc.nice ) )
-                              .setCurrentColumn( fmtPercent( proc.cpu_percent ) );
+            mProcList.assignRows( rows );
+            if( mRowIndexing != rowIndexStable )
+                mProcList.renumberRows();
+
+            return *this;
+        }
+
+        /**
+         * sets the columns of a row of smProcessTable, rows returned by
+         * MibContainerTable::updateRow() get only the changed values written
+         *
+         * @param row - the row to fill
+         * @param proc - statistics of the process
+         * @param details - derived values of the process
+         */
+        static void setRowColumns( MibObject::ContentManagerType::TableType::RowType &row, sg_process_stats const &proc, ProcessDetails const &details )
+        {
+            row.setCurrentColumn( SnmpUInt32(proc.pid) )
+               .setCurrentColumn( SnmpUInt32(proc.parent) )
+               .setCurrentColumn( proc.process_name )
+               .setCurrentColumn( proc.proctitle )
+               .setCurrentColumn( SnmpUInt32(proc.state) )
+               .setCurrentColumn( Counter64( proc.proc_size ) )
+               .setCurrentColumn( Counter64( proc.proc_resident ) )
+               .setCurrentColumn( Counter64( proc.start_time ) )
+               .setCurrentColumn( Counter64( proc.time_spent ) )
+               .setCurrentColumn( SnmpUInt32( proc.uid ) )
+               .setCurrentColumn( details.UserName )
+               .setCurrentColumn( SnmpUInt32( proc.gid ) )
+               .setCurrentColumn( details.GroupName )
+               .setCurrentColumn( SnmpUInt32( proc.euid ) )
+               .setCurrentColumn( details.EffectiveUserName )
+               .setCurrentColumn( SnmpUInt32( proc.egid ) )
+               .setCurrentColumn( details.EffectiveGroupName )
+               .setCurrentColumn( SnmpInt32( proc.nice ) )
+               .setCurrentColumn( details.CpuPercent );
+        }
+
+        virtual ProcessMib & addTopRow( ProcessTopList list, sg_process_stats const &proc, std::string const &userName )
+        {
+            MibObject::ContentManagerType::TableType &table = ( list == processTopCpu )
+                                                            ? mTopCpu
+                                                            : ( list == processTopResident ) ? mTopResident : mTopCpuTime;
+            // the row index is the rank
+            MibObject::ContentManagerType::TableType::RowType row = table.addRow();
+
+            row.setCurrentColumn( SnmpUInt32( row.getCurrentRowIndex() ) )
+               .setCurrentColumn( SnmpUInt32( proc.pid ) )
+               .setCurrentColumn( proc.process_name )
+               .setCurrentColumn( userName )
+               .setCurrentColumn( Counter64( proc.proc_resident ) )
+               .setCurrentColumn( Counter64( proc.time_spent ) )
+               .setCurrentColumn( fmtPercent( proc.cpu_percent ) );
 
             return *this;
         }
@@ -100,20 +178,6 @@ namespace SmartSnmpd
             return *this;
         }
 
-    protected:
-        /**
-         * system user information accessor
-         */
-        SystemUserInfo mSysUserInfo;
-
-        MibObject::ContentManagerType::LeafType mUpdateTimestamp;
-        MibObject::ContentManagerType::LeafType mTotalProcCount;
-        MibObject::ContentManagerType::LeafType mRunningProcCount;
-        MibObject::ContentManagerType::LeafType mSleepingProcCount;
-        MibObject::ContentManagerType::LeafType mStoppedProcCount;
-        MibObject::ContentManagerType::LeafType mZombieProcCount;
-        MibObject::ContentManagerType::TableType mProcList;
-
         static std::string fmtPercent( double d, int precision = 2 )
         {
             ostringstream oss;
@@ -125,6 +189,20 @@ namespace SmartSnmpd
             return oss.str();
         }
 
+    protected:
+        RowIndexing mRowIndexing;
+
+        MibObject::ContentManagerType::LeafType mUpdateTimestamp;
+        MibObject::ContentManagerType::LeafType mTotalProcCount;
+        MibObject::ContentManagerType::LeafType mRunningProcCount;
+        MibObject::ContentManagerType::LeafType mSleepingProcCount;
+        MibObject::ContentManagerType::LeafType mStoppedProcCount;
+        MibObject::ContentManagerType::LeafType mZombieProcCount;
+        MibObject::ContentManagerType::TableType mProcList;
+        MibObject::ContentManagerType::TableType mTopCpu;
+        MibObject::ContentManagerType::TableType mTopResident;
+        MibObject::ContentManagerType::TableType mTopCpuTime;
+
     private:
         SmartSnmpdProcessMib();
     };
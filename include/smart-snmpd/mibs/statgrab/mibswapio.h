@@ -29,7 +29,7 @@ namespace SmartSnmpd
         virtual ~SwapIoMib() {}
 
         virtual SwapIoMib &setTotalSwapIoStats( sg_page_stats const &pageStats ) = 0;
-        virtual SwapIoMib &setIntervalSwapIoStats( unsigned long long fromSecsSinceEpoch, unsigned long long untilSecsSinceEpoch, sg_page_stats const &pageStats ) = 0;
+        virtual SwapIoMib &setIntervalSwapIoStats( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch, sg_page_stats const &pageStats ) = 0;
         virtual SwapIoMib &setUpdateTimestamp( unsigned long long secsSinceEpoch ) = 0;
 
     protected:
@@ -47,6 +47,8 @@ namespace SmartSnmpd
             , mPagesOutTotal( aCntMgr, SM_SWAP_PAGES_OUT_TOTAL_KEY )
             , mIntervalFrom( aCntMgr, SM_SWAP_IO_INTERVAL_FROM_KEY )
             , mIntervalUntil( aCntMgr, SM_SWAP_IO_INTERVAL_UNTIL_KEY )
+            , mIntervalFromMs( aCntMgr, SM_SWAP_IO_INTERVAL_FROM_MS_KEY )
+            , mIntervalUntilMs( aCntMgr, SM_SWAP_IO_INTERVAL_UNTIL_MS_KEY )
             , mPagesInInterval( aCntMgr, SM_SWAP_PAGES_IN_INTERVAL_KEY )
             , mPagesOutInterval( aCntMgr, SM_SWAP_PAGES_OUT_INTERVAL_KEY )
         {}
@@ -61,10 +63,12 @@ namespace SmartSnmpd
             return *this;
         }
 
-        virtual SwapIoMib &setIntervalSwapIoStats( unsigned long long fromSecsSinceEpoch, unsigned long long untilSecsSinceEpoch, sg_page_stats const &pageStats )
+        virtual SwapIoMib &setIntervalSwapIoStats( unsigned long long fromMsSinceEpoch, unsigned long long untilMsSinceEpoch, sg_page_stats const &pageStats )
         {
-            mIntervalFrom.set( fromSecsSinceEpoch );
-            mIntervalUntil.set( untilSecsSinceEpoch );
+            mIntervalFrom.set( fromMsSinceEpoch / 1000 );
+            mIntervalUntil.set( untilMsSinceEpoch / 1000 );
+            mIntervalFromMs.set( fromMsSinceEpoch );
+            mIntervalUntilMs.set( untilMsSinceEpoch );
 
             mPagesInInterval.set( pageStats.pages_pagein );
             mPagesOutInterval.set( pageStats.pages_pageout );
@@ -85,6 +89,8 @@ namespace SmartSnmpd
         MibObject::ContentManagerType::LeafType mPagesOutTotal;
         MibObject::ContentManagerType::LeafType mIntervalFrom;
         MibObject::ContentManagerType::LeafType mIntervalUntil;
+        MibObject::ContentManagerType::LeafType mIntervalFromMs;
+        MibObject::ContentManagerType::LeafType mIntervalUntilMs;
         MibObject::ContentManagerType::LeafType mPagesInInterval;
         MibObject::ContentManagerType::LeafType mPagesOutInterval;
 
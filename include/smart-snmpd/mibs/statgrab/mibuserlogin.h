@@ -41,13 +41,15 @@ namespace SmartSnmpd
         : public UserLoginMib
     {
     public:
-        SmartSnmpdUserLoginMib( MibObject::ContentManagerType &aCntMgr )
+        SmartSnmpdUserLoginMib( MibObject::ContentManagerType &aCntMgr, std::vector<unsigned long> const &aColumns = std::vector<unsigned long>() )
             : UserLoginMib()
             , mSysUserInfo()
             , mUpdateTimestamp( aCntMgr, SM_LAST_UPDATE_MIB_KEY )
             , mRowCount( aCntMgr, SM_USER_LOGIN_COUNT_KEY )
             , mUserLogins( aCntMgr, SM_USER_LOGIN_TABLE_KEY, 10 )
-        {}
+        {
+            mUserLogins.setEnabledColumns( aColumns );
+        }
 
         virtual ~SmartSnmpdUserLoginMib() {}
 
@@ -59,16 +61,21 @@ namespace SmartSnmpd
 
         virtual UserLoginMib & addRow( sg_user_stats const &login )
         {
+            // resolve the user id only when it's published
+            unsigned long uid = ( login.login_name && mUserLogins.isColumnEnabled( 3 ) )
+                              ? (unsigned long)( mSysUserInfo.getuseridbyname( login.login_name ) )
+                              : (unsigned long)(-1);
+
             mUserLogins.addRow().setCurrentColumn( mUserLogins.getLastRowIndex() + 1 )
-                                .setCurrentColumn( login.login_name ? OctetStr( login.login_name ) : OctetStr() )
-                                .setCurrentColumn( login.login_name ? SnmpUInt32( mSysUserInfo.getuseridbyname( login.login_name ) ) : SnmpUInt32((unsigned long)(-1)) )
-                                .setCurrentColumn( login.device ? OctetStr( login.device ) : OctetStr()  )
+                                .setCurrentColumn( login.login_name )
+                                .setCurrentColumn( SnmpUInt32( uid ) )
+                                .setCurrentColumn( login.device )
                                 .setCurrentColumn( Counter64(login.login_time) )
                                 .setCurrentColumn() // SM_USER_LOGIN_IDLE_TIME_KEY
                                 .setCurrentColumn() // SM_USER_LOGIN_JCPU_TIME_KEY
                                 .setCurrentColumn() // SM_USER_LOGIN_PCPU_TIME_KEY
                                 .setCurrentColumn() // SM_USER_LOGIN_WHAT_KEY
-                                .setCurrentColumn( login.hostname ? OctetStr( login.hostname ) : OctetStr() );
+                                .setCurrentColumn( login.hostname );
 
             return *this;
         }
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_PROCFS_PROCESS_H_INCLUDED__
+#define __SMART_SNMPD_PROCFS_PROCESS_H_INCLUDED__
+
+#include <statgrab.h>
+
+#include <sys/types.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+namespace SmartSnmpd
+{
+    struct ProcfsScanJob;
+
+    /**
+     * collects process statistics directly from the Linux /proc file system
+     *
+     * The collector delivers the same sg_process_stats records as
+     * sg_get_process_stats_r() but reads only the files of a process
+     * which are required for the requested fields: stat always, status
+     * for the credentials and cmdline for the arguments. The /proc
+     * directory is kept open and the files are opened relative to it.
+     * Each scan thread reuses its read buffer and result storage over
+     * refreshes.
+     *
+     * The collector isn't synchronized, the owner has to serialize calls
+     * to collect() and the access to the collected records.
+     */
+    class ProcfsProcessCollector
+    {
+    public:
+        /**
+         * optional process details to collect
+         */
+        enum Fields
+        {
+            //! real and effective user and group ids (/proc/<pid>/status)
+            fieldCredentials = 1,
+            //! process title (/proc/<pid>/cmdline)
+            fieldArguments = 2,
+            //! all of the above
+            fieldAll = fieldCredentials | fieldArguments
+        };
+
+        /**
+         * default constructor
+         */
+        ProcfsProcessCollector();
+        /**
+         * destructor
+         */
+        ~ProcfsProcessCollector();
+
+        /**
+         * tells whether the collector is supported on this platform
+         *
+         * @return bool - true when /proc can be scanned
+         */
+        static bool isAvailable();
+
+        /**
+         * scans all processes
+         *
+         * @param fields - bit mask of Fields to collect in addition to /proc/<pid>/stat
+         * @param threads - number of threads to split the process ids over
+         *
+         * @return int - 0 on success, errno code on error
+         */
+        int collect( unsigned fields, unsigned threads );
+
+        /**
+         * accessor to the collected records (valid until the next collect())
+         *
+         * @return sg_process_stats const * - first record, NULL when none
+         */
+        sg_process_stats const * getStats() const { return mStats.empty() ? NULL : &mStats[0]; }
+        /**
+         * number of collected records
+         *
+         * @return size_t - number of records delivered by getStats()
+         */
+        size_t getCount() const { return mStats.size(); }
+
+    protected:
+        /**
+         * file descriptor of the opened /proc directory
+         */
+        int mProcFd;
+        /**
+         * system boot time in seconds since epoch (/proc/stat btime)
+         */
+        time_t mBootTime;
+        /**
+         * process ids found by the latest scan
+         */
+        std::vector<pid_t> mPids;
+        /**
+         * scan jobs, kept to reuse their buffers
+         */
+        std::vector<ProcfsScanJob *> mJobs;
+        /**
+         * collected records, merged from the scan jobs
+         */
+        std::vector<sg_process_stats> mStats;
+
+        /**
+         * reads the process ids from /proc into mPids
+         *
+         * @return int - 0 on success, errno code on error
+         */
+        int readPids();
+
+    private:
+        ProcfsProcessCollector(ProcfsProcessCollector const &);
+        ProcfsProcessCollector & operator = (ProcfsProcessCollector const &);
+    };
+}
+
+#endif /* __SMART_SNMPD_PROCFS_PROCESS_H_INCLUDED__ */
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_ROW_FILTER_H_INCLUDED__
+#define __SMART_SNMPD_ROW_FILTER_H_INCLUDED__
+
+#include <smart-snmpd/config.h>
+
+#include <statgrab.h>
+
+#include <regex.h>
+
+#include <string>
+
+namespace SmartSnmpd
+{
+    /**
+     * decides which processes or file systems are put into a table
+     *
+     * The filter is built from the RowFilterConfig of a mib object, the
+     * regular expressions are compiled once and kept until the
+     * configuration changes. Not synchronized, the owning data source
+     * has to serialize configure() and the matching.
+     */
+    class RowFilter
+    {
+    public:
+        /**
+         * default constructor - accepts everything
+         */
+        RowFilter();
+        /**
+         * destructor
+         */
+        ~RowFilter();
+
+        /**
+         * (re-)builds the filter when the configuration has changed
+         *
+         * @param cfg - filter configuration of the mib object
+         */
+        void configure( RowFilterConfig const &cfg );
+
+        /**
+         * tells whether the process owner's name is required for matching
+         */
+        bool hasUserPattern() const { return mHasUser; }
+
+        /**
+         * checks a process against all criteria except the owner
+         *
+         * @param proc - statistics of the process
+         * @return bool - true when the process passes
+         */
+        bool matchProcess( sg_process_stats const &proc ) const;
+        /**
+         * checks the name of a process owner
+         *
+         * @param userName - name of the user owning the process
+         * @return bool - true when the name passes
+         */
+        bool matchUser( std::string const &userName ) const;
+        /**
+         * checks a file system against the type and mount point criteria
+         *
+         * @param fs - statistics of the file system
+         * @return bool - true when the file system passes
+         */
+        bool matchFilesystem( sg_fs_stats const &fs ) const;
+
+    protected:
+        RowFilterConfig mConfig;
+        regex_t mName;
+        regex_t mUser;
+        bool mHasName;
+        bool mHasUser;
+        //! bit mask of accepted sg_process_state values, 0 for any
+        unsigned mStates;
+
+        void release();
+        bool compile( regex_t &re, std::string const &pattern );
+
+    private:
+        RowFilter(RowFilter const &);
+        RowFilter & operator = (RowFilter const &);
+    };
+}
+
+#endif /* __SMART_SNMPD_ROW_FILTER_H_INCLUDED__ */
@@ -22,11 +22,14 @@
 #include <smart-snmpd/config.h>
 #include <smart-snmpd/functional.h>
 #include <smart-snmpd/property.h>
+#include <smart-snmpd/mibutils/mibcontainertabledata.h>
 
 #include <agent_pp/mib_complex_entry.h>
 
+#include <algorithm>
+#include <list>
 #include <string>
-#include <set>
+#include <vector>
 #include <stdexcept>
 
 namespace SmartSnmpd
@@ -37,6 +40,19 @@ namespace SmartSnmpd
 
     /**
      * base class for smart-snmpd mib-trees
+     *
+     * The content is kept in a flat vector which is sorted by the object
+     * identifiers of the contained variable bindings. While a container
+     * is filled (e.g. between MibObject::beginContentUpdate() and
+     * MibObject::commitContentUpdate()) new entries are simply appended,
+     * sort() brings them into order once before the content is published.
+     * The request handlers (find_succ(), get_request()) rely on published,
+     * sorted content and never modify it, so any number of readers can
+     * share a snapshot.
+     *
+     * Tables (see MibContainerTable) are stored column-major in separate
+     * MibContainerTableData instances, their cells are turned into Vbx
+     * instances only when they're requested.
      */
     class MibContainer
         : public NS_AGENT ThreadManager
@@ -45,7 +61,8 @@ namespace SmartSnmpd
         typedef MibContainerItem ItemType;
         typedef MibContainerLeaf LeafType;
         typedef MibContainerTable TableType;
-        typedef std::set<NS_AGENT Vbx> ContainerType;
+        typedef std::vector<NS_AGENT Vbx> ContainerType;
+        typedef std::list<MibContainerTableData> TableDataContainerType;
 
         /**
          * last update timestamp
@@ -57,6 +74,8 @@ namespace SmartSnmpd
             , mLastUpdate( *this, &SmartSnmpd::MibContainer::readLastUpdate, &SmartSnmpd::MibContainer::writeLastUpdate )
             , mBaseOid( oid )
             , mContent()
+            , mSorted( true )
+            , mTables()
         {}
 
         MibContainer(MibContainer const &other)
@@ -64,6 +83,8 @@ namespace SmartSnmpd
             , mLastUpdate( *this, &SmartSnmpd::MibContainer::readLastUpdate, &SmartSnmpd::MibContainer::writeLastUpdate )
             , mBaseOid( other.mBaseOid )
             , mContent( other.mContent )
+            , mSorted( other.mSorted )
+            , mTables( other.mTables )
         {}
 
         /**
@@ -111,12 +132,46 @@ namespace SmartSnmpd
          */
         void remove(NS_AGENT Oidx const &o, bool suffixOnly = true)
         {
-            set<NS_AGENT Vbx>::iterator i = findItem(o, suffixOnly);
+            // drop older duplicates first, otherwise one of them survives
+            sort();
+
+            ContainerType::iterator i = findItem(o, suffixOnly);
 
             if( i != mContent.end() )
                 mContent.erase( i );
         }
 
+        /**
+         * Remove several instances at once - cheaper than removing them
+         * one by one. (NOT SYNCHRONIZED)
+         *
+         * @param suffixes
+         *    the OID suffixes of the entries to be removed.
+         *
+         * @return reference to this instance
+         */
+        MibContainer & remove( std::vector<NS_AGENT Oidx> const &suffixes );
+
+        /**
+         * Puts the entries of another container below the entries added
+         * so far: for oids contained in both, the entry of this container
+         * wins after the next sort(). (NOT SYNCHRONIZED)
+         *
+         * @param base - container to take the entries from
+         *
+         * @return reference to this instance
+         */
+        MibContainer & underlay( MibContainer const &base )
+        {
+            if( !base.mContent.empty() )
+            {
+                mSorted = mContent.empty() && base.mSorted;
+                mContent.insert( mContent.begin(), base.mContent.begin(), base.mContent.end() );
+            }
+
+            return *this;
+        }
+
         /**
          * Get the entry instance with the given OID. If suffixOnly 
          * is false (the default), the specified OID must be the full 
@@ -135,7 +190,7 @@ namespace SmartSnmpd
          */
         ContainerType::const_iterator get(NS_AGENT Oidx const &o, bool suffixOnly = false) const
         {
-            set<NS_AGENT Vbx>::const_iterator i = findItem(o, suffixOnly);
+            ContainerType::const_iterator i = findItem(o, suffixOnly);
             return i;
         }
 
@@ -157,7 +212,7 @@ namespace SmartSnmpd
          */
         ContainerType::iterator get(NS_AGENT Oidx const &o, bool suffixOnly = false)
         {
-            set<NS_AGENT Vbx>::iterator i = findItem(o, suffixOnly);
+            ContainerType::iterator i = findItem(o, suffixOnly);
             return i;
         }
 
@@ -170,8 +225,54 @@ namespace SmartSnmpd
 
         /**
          * Clear the table.
+         *
+         * The allocated storage is kept to avoid reallocations when the
+         * container is refilled by the next update.
          */
-        void clear() { mContent.clear(); }
+        void clear()
+        {
+            mContent.clear();
+            mSorted = true;
+            for( TableDataContainerType::iterator i = mTables.begin(); i != mTables.end(); ++i )
+                i->clear();
+        }
+
+        /**
+         * Get the column-major storage of the table with the specified
+         * entry oid, creates it when it doesn't exist. (NOT SYNCHRONIZED)
+         *
+         * @param aTableEntryOid - oid of the table entry relative to the container
+         * @param aColumnCount - amount of columns of the table
+         *
+         * @return MibContainerTableData & - storage of the table
+         */
+        MibContainerTableData & getTableData( NS_AGENT Oidx const &aTableEntryOid, unsigned long aColumnCount )
+        {
+            for( TableDataContainerType::iterator i = mTables.begin(); i != mTables.end(); ++i )
+            {
+                if( i->getTableEntryOid() == aTableEntryOid )
+                    return *i;
+            }
+
+            mTables.push_back( MibContainerTableData( aTableEntryOid, aColumnCount ) );
+            return mTables.back();
+        }
+
+        /**
+         * Reserve storage for at least the specified number of entries.
+         *
+         * @param n - expected number of entries
+         */
+        void reserve( ContainerType::size_type n ) { mContent.reserve( n ); }
+
+        /**
+         * Sorts the entries appended since the last sort by their object
+         * identifiers and removes duplicates - the most recently added
+         * entry for an object identifier wins. (NOT SYNCHRONIZED)
+         *
+         * return reference to this instance
+         */
+        MibContainer & sort();
 
         /**
          * Resets the content of the container to its state right after
@@ -192,6 +293,8 @@ namespace SmartSnmpd
         MibContainer & swap( MibContainer &other )
         {
             mContent.swap( other.mContent );
+            std::swap( mSorted, other.mSorted );
+            mTables.swap( other.mTables );
             return *this;
         }
 
@@ -208,7 +311,7 @@ namespace SmartSnmpd
          *    otherwise (if no successor exists or is out of scope) 
          *    a zero length oid is returned
          */
-        virtual Oidx find_succ( NS_AGENT Oidx const &o, NS_AGENT Request *aReq = 0 );
+        virtual Oidx find_succ( NS_AGENT Oidx const &o, NS_AGENT Request *aReq = 0 ) const;
 
         /**
          * Let the receiver process a SNMP GET subrequest
@@ -216,7 +319,7 @@ namespace SmartSnmpd
          * @param req - A pointer to the whole SNMP GET request.
          * @param idx - The index of the subrequest to be processed.
          */
-        virtual void get_request( NS_AGENT Request *aReq, int idx );
+        virtual void get_request( NS_AGENT Request *aReq, int idx ) const;
 
         /**
          * Let the receiver process a SNMP GETNEXT subrequest
@@ -224,81 +327,90 @@ namespace SmartSnmpd
          * @param req - A pointer to the whole SNMP GETNEXT request.
          * @param idx - The index of the subrequest to be processed.
          */
-        virtual void get_next_request( NS_AGENT Request *aReq, int idx )
+        virtual void get_next_request( NS_AGENT Request *aReq, int idx ) const
         {
             return get_request( aReq, idx );
         }
         
      protected:
         NS_AGENT Oidx const mBaseOid;
-        std::set<NS_AGENT Vbx> mContent;
+        ContainerType mContent;
+        /**
+         * true as long as no entry has been appended after the last sort()
+         */
+        bool mSorted;
+        TableDataContainerType mTables;
 
-        inline set<NS_AGENT Vbx>::iterator insert_or_update( NS_AGENT Vbx const &ref )
+        inline ContainerType::iterator insert_or_update( NS_AGENT Vbx const &ref )
         {
-            std::set<NS_AGENT Vbx>::iterator i = mContent.lower_bound(ref);
-            if( ( i == mContent.end() ) || ( mContent.key_comp()(ref, *i ) ) )
+            if( mSorted && !mContent.empty() && !( mContent.back() < ref ) )
             {
-                i = mContent.insert( i, ref );
+                if( !( ref < mContent.back() ) )
+                {
+                    // update of the most recently added entry
+                    mContent.back().set_value( ref );
+                    return mContent.end() - 1;
+                }
+
+                mSorted = false;
             }
-            else
-            {
-                NS_AGENT Vbx &vb = const_cast<NS_AGENT Vbx &>(*i);
-                vb.set_value(ref);
-            }
-            return i;
+
+            mContent.push_back( ref );
+            return mContent.end() - 1;
         }
 
-        inline set<NS_AGENT Vbx>::iterator insert_or_update( NS_AGENT Oidx const &o, NS_SNMP SnmpSyntax const &syn )
+        inline ContainerType::iterator insert_or_update( NS_AGENT Oidx const &o, NS_SNMP SnmpSyntax const &syn )
         {
-            std::set<NS_AGENT Vbx>::iterator i = mContent.lower_bound( Vbx(o) );
-            if( ( i == mContent.end() ) || ( mContent.key_comp()( Vbx(o), *i ) ) )
+            Vbx tmpvb( o );
+            tmpvb.set_value( syn );
+            return insert_or_update( tmpvb );
+        }
+
+        /**
+         * searches the entry for given suffix oid - using binary search
+         * when the content is sorted or a reverse linear search (finding
+         * the most recently added entry) while the content is filled
+         */
+        template<class Iter>
+        static inline Iter findEntry( Iter first, Iter last, bool sorted, NS_AGENT Vbx const &key )
+        {
+            if( sorted )
             {
-                Vbx tmpvb( o );
-                tmpvb.set_value( syn );
-                i = mContent.insert( i, tmpvb );
+                Iter i = std::lower_bound( first, last, key );
+                if( ( i != last ) && !( key < *i ) )
+                    return i;
             }
             else
             {
-                NS_AGENT Vbx &vb = const_cast<NS_AGENT Vbx &>(*i);
-                vb.set_value(syn);
+                for( Iter i = last; i != first; )
+                {
+                    --i;
+                    if( !( key < *i ) && !( *i < key ) )
+                        return i;
+                }
             }
-            return i;
+
+            return last;
         }
 
-        inline std::set<NS_AGENT Vbx>::iterator findItem( Oidx const &o, bool suffixOnly )
+        inline ContainerType::iterator findItem( Oidx const &o, bool suffixOnly )
         {
-            std::set<NS_AGENT Vbx>::iterator i = mContent.end();
             if( suffixOnly || !mBaseOid.is_root_of( o ) )
             {
-                i = mContent.find( Vbx( o ) );
-            }
-            else
-            {
-                Vbx tmpvb;
-                Oidx tmpoid( o.cut_left( mBaseOid.len() ) );
-                tmpvb.set_oid( tmpoid );
-                i = mContent.find( tmpvb );
+                return findEntry( mContent.begin(), mContent.end(), mSorted, Vbx( o ) );
             }
 
-            return i;
+            return findEntry( mContent.begin(), mContent.end(), mSorted, Vbx( o.cut_left( mBaseOid.len() ) ) );
         }
 
-        inline std::set<NS_AGENT Vbx>::const_iterator findItem( Oidx const &o, bool suffixOnly ) const
+        inline ContainerType::const_iterator findItem( Oidx const &o, bool suffixOnly ) const
         {
-            std::set<NS_AGENT Vbx>::const_iterator i = mContent.end();
             if( suffixOnly || !mBaseOid.is_root_of( o ) )
             {
-                i = mContent.find( Vbx( o ) );
-            }
-            else
-            {
-                Vbx tmpvb;
-                Oidx tmpoid( o.cut_left( mBaseOid.len() ) );
-                tmpvb.set_oid( tmpoid );
-                i = mContent.find( tmpvb );
+                return findEntry( mContent.begin(), mContent.end(), mSorted, Vbx( o ) );
             }
 
-            return i;
+            return findEntry( mContent.begin(), mContent.end(), mSorted, Vbx( o.cut_left( mBaseOid.len() ) ) );
         }
 
         /**
@@ -310,7 +422,7 @@ namespace SmartSnmpd
          */
         time_t readLastUpdate() const
         { 
-            std::set<NS_AGENT Vbx>::iterator i = mContent.find( Vbx( SM_LAST_UPDATE_MIB_KEY ) );
+            ContainerType::const_iterator i = findEntry( mContent.begin(), mContent.end(), mSorted, Vbx( SM_LAST_UPDATE_MIB_KEY ) );
             if( i != mContent.end() )
             {
                 Counter64 cntr64;
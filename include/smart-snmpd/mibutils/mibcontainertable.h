@@ -47,6 +47,8 @@ namespace SmartSnmpd
             , mColumnCount( aColumnCount )
             , mLastRow( 0 )
             // , mRows()
+            , mData( aContainer.getTableData( mTableEntryOid, aColumnCount ) )
+            , mHashedRows()
         {
             if( scanForRows )
                 scanContainerForRows();
@@ -58,6 +60,8 @@ namespace SmartSnmpd
             , mColumnCount( ref.mColumnCount )
             , mLastRow( ref.mLastRow )
             // , mRows( ref.mRows )
+            , mData( ref.mData )
+            , mHashedRows( ref.mHashedRows )
         {}
 
         virtual ~MibContainerTable() {}
@@ -77,17 +81,115 @@ namespace SmartSnmpd
          */
         MibContainerTableRow & getRow(unsigned long aRow);
 
+        /**
+         * appends a row using the next sequential row index, indices of
+         * rows added by key are skipped
+         */
         inline MibContainerTableRow addRow();
+        /**
+         * appends a row using the specified row index
+         *
+         * Rows can be added in any order, when a row index is used twice
+         * the most recently added row wins.
+         *
+         * @param aRowIdx - index of the new row
+         */
+        inline MibContainerTableRow addRow( unsigned long aRowIdx );
+        /**
+         * appends a row using an index derived from the specified key
+         *
+         * The index is a hash of the key, so the same key results in the
+         * same index over all refreshes as long as no collision occures.
+         * Hashed indices are taken from the upper half of the index range
+         * (HashedRowBase and above) to stay clear of sequential indices and
+         * indices assigned by the caller (e.g. interface indices). A
+         * candidate index used by any row of the table is skipped for the
+         * next free one - to resolve collisions independent of the order
+         * the data has been collected in, add keyed rows ordered by key.
+         *
+         * @param aRowKey - key identifying the row (e.g. a mount point)
+         */
+        inline MibContainerTableRow addRow( std::string const &aRowKey );
+        /**
+         * returns a row added before for changing its values, only cells
+         * whose value differs are written
+         *
+         * @param aRowPos - position of the row in the storage of the table
+         *   (see MibContainerTableRow::getRowPosition())
+         */
+        inline MibContainerTableRow updateRow( std::vector<unsigned long>::size_type aRowPos );
+
+        /**
+         * replaces all rows by the rows of another table with the same
+         * entry oid, e.g. rows maintained over several updates outside of
+         * the published content
+         *
+         * @param aSource - table to copy the rows from
+         */
+        void assignRows( MibContainerTable const &aSource )
+        {
+            mData = aSource.mData;
+            mLastRow = aSource.mLastRow;
+            mHashedRows = aSource.mHashedRows;
+        }
+        /**
+         * assigns the row indices 1 .. n in the order the rows are stored
+         */
+        void renumberRows()
+        {
+            mData.renumberRows();
+            mLastRow = mData.getRowCount();
+            mHashedRows.clear();
+        }
 
         unsigned long getLastRowIndex() const { return mLastRow; }
 
+        /**
+         * reserves storage for the expected amount of rows
+         *
+         * @param n - expected amount of rows
+         */
+        void reserve( std::vector<unsigned long>::size_type n ) { mData.reserve( n ); }
+
+        /**
+         * restricts the columns stored for the rows added afterwards,
+         * values set for other columns are dropped
+         *
+         * @param aColumns - sorted indices of the columns to store, empty for all
+         */
+        void setEnabledColumns( std::vector<unsigned long> const &aColumns ) { mData.setEnabledColumns( aColumns ); }
+
+        /**
+         * tells whether values of the specified column are stored
+         *
+         * @param aCol - column index (1 .. column count)
+         */
+        bool isColumnEnabled( unsigned long aCol ) const { return mData.isColumnEnabled( aCol ); }
+
     protected:
         static const NS_AGENT Oidx TableEntryKey;
+        //! first row index used for rows added by key
+        static const unsigned long HashedRowBase = 0x40000000UL;
 
         const NS_AGENT Oidx mTableEntryOid;
         const unsigned long mColumnCount;
         unsigned long mLastRow;
         // vector<unsigned long> mRows;
+        MibContainerTableData &mData;
+        std::set<unsigned long> mHashedRows;
+
+        static unsigned long hashRowKey( std::string const &aRowKey )
+        {
+            // FNV-1a, reduced to HashedRowBase .. 0x7FFFFFFF
+            unsigned long h = 2166136261UL;
+            for( std::string::const_iterator i = aRowKey.begin(); i != aRowKey.end(); ++i )
+            {
+                h ^= (unsigned char)(*i);
+                h = ( h * 16777619UL ) & 0xFFFFFFFFUL;
+            }
+
+            return HashedRowBase | ( h & ( HashedRowBase - 1 ) );
+        }
 
         void scanContainerForRows() { throw std::runtime_error( "MibContainerTable::scanContainerForRows is not implemented" ); }
 
@@ -104,7 +206,39 @@ namespace SmartSnmpd
     inline MibContainerTableRow
     MibContainerTable::addRow()
     {
-        return MibContainerTableRow( *this, mColumnCount, ++mLastRow );
+        do
+        {
+            ++mLastRow;
+        } while( !mHashedRows.empty() && mHashedRows.count( mLastRow ) );
+
+        return MibContainerTableRow( *this, mColumnCount, mLastRow );
+    }
+
+    inline MibContainerTableRow
+    MibContainerTable::addRow( unsigned long aRowIdx )
+    {
+        if( aRowIdx > mLastRow )
+            mLastRow = aRowIdx;
+
+        return MibContainerTableRow( *this, mColumnCount, aRowIdx );
+    }
+
+    inline MibContainerTableRow
+    MibContainerTable::addRow( std::string const &aRowKey )
+    {
+        unsigned long rowIdx = hashRowKey( aRowKey );
+        while( mHashedRows.count( rowIdx ) || mData.hasRowIndex( rowIdx ) )
+            rowIdx = ( rowIdx < 0x7FFFFFFFUL ) ? rowIdx + 1 : HashedRowBase;
+        mHashedRows.insert( rowIdx );
+
+        // doesn't advance the sequential row index
+        return MibContainerTableRow( *this, mColumnCount, rowIdx );
+    }
+
+    inline MibContainerTableRow
+    MibContainerTable::updateRow( std::vector<unsigned long>::size_type aRowPos )
+    {
+        return MibContainerTableRow( *this, mColumnCount, aRowPos, true );
     }
 }
 
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_MIB_CONTAINER_TABLE_DATA_H_INCLUDED__
+#define __SMART_SNMPD_MIB_CONTAINER_TABLE_DATA_H_INCLUDED__
+
+#include <smart-snmpd/smart-snmpd.h>
+
+#include <agent_pp/snmp_pp_ext.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace SmartSnmpd
+{
+    /**
+     * column-major storage of a table held by a MibContainer
+     *
+     * Each column is a vector of typed cells: numbers are stored as plain
+     * integers, octet strings as offset/length into a string arena shared
+     * by all cells of the table. Vbx instances are only materialized when
+     * a cell is requested. Rows are appended in any order, sort() brings
+     * them in order of their row index (most recently added row wins for
+     * duplicate indices). Disabled columns hold no cells at all.
+     *
+     * Storage kept over several updates can be patched in place: the
+     * updateCell() methods write only values which differ, removeRows()
+     * drops rows and compact() reclaims arena space of replaced strings.
+     */
+    class MibContainerTableData
+    {
+    public:
+        /**
+         * how the value of a cell is stored
+         */
+        enum CellStorage
+        {
+            csUnset = 0,        //!< cell not set - skipped during access
+            csNull,             //!< cell without value (NULL syntax)
+            csNumber,           //!< Value holds the number
+            csString,           //!< Value/Length address the string arena
+            csForeign           //!< Value indexes mForeign
+        };
+
+        struct Cell
+        {
+            unsigned char Storage;
+            SmiUINT32 Syntax;
+            unsigned long Length;
+            unsigned long long Value;
+
+            Cell()
+                : Storage( csUnset )
+                , Syntax( sNMP_SYNTAX_NULL )
+                , Length( 0 )
+                , Value( 0 )
+            {}
+        };
+
+        typedef std::vector<Cell> ColumnType;
+
+        /**
+         * constructs storage for a table
+         *
+         * @param aTableEntryOid - oid of the table entry relative to the container
+         * @param aColumnCount - amount of columns in the table
+         */
+        MibContainerTableData( NS_AGENT Oidx const &aTableEntryOid, unsigned long aColumnCount )
+            : mTableEntryOid( aTableEntryOid )
+            , mRowIndices()
+            , mColumns( aColumnCount )
+            , mColumnEnabled( aColumnCount, true )
+            , mStrings()
+            , mForeign()
+            , mSorted( true )
+            , mStringGarbage( 0 )
+        {}
+
+        MibContainerTableData( MibContainerTableData const &ref );
+
+        ~MibContainerTableData() { clearForeign(); }
+
+        MibContainerTableData & operator = ( MibContainerTableData const &ref );
+
+        NS_AGENT Oidx const & getTableEntryOid() const { return mTableEntryOid; }
+        unsigned long getColumnCount() const { return mColumns.size(); }
+        std::vector<unsigned long>::size_type getRowCount() const { return mRowIndices.size(); }
+        /**
+         * returns the index of the row at the specified storage position
+         *
+         * @param aRowPos - position of the row (0 .. getRowCount() - 1)
+         */
+        unsigned long getRowIndex( std::vector<unsigned long>::size_type aRowPos ) const { return mRowIndices[aRowPos]; }
+        /**
+         * tells whether the rows are stored in order of their index
+         */
+        bool isSorted() const { return mSorted; }
+
+        /**
+         * tells whether a row with the specified index has been added
+         *
+         * @param aRowIdx - row index to look for
+         */
+        bool hasRowIndex( unsigned long aRowIdx ) const
+        {
+            if( mSorted )
+                return std::binary_search( mRowIndices.begin(), mRowIndices.end(), aRowIdx );
+
+            return std::find( mRowIndices.begin(), mRowIndices.end(), aRowIdx ) != mRowIndices.end();
+        }
+
+        /**
+         * tells whether values of the specified column are stored
+         *
+         * @param aColIdx - column index (1 .. getColumnCount())
+         */
+        bool isColumnEnabled( unsigned long aColIdx ) const
+        {
+            return ( aColIdx >= 1 ) && ( aColIdx <= mColumnEnabled.size() ) && mColumnEnabled[aColIdx - 1];
+        }
+
+        /**
+         * restricts the stored columns
+         *
+         * @param aColumns - sorted indices of the columns to store, empty for all
+         */
+        void setEnabledColumns( std::vector<unsigned long> const &aColumns );
+
+        /**
+         * removes all rows but keeps allocated storage for reuse
+         */
+        void clear();
+
+        /**
+         * reserves storage for the specified amount of rows
+         */
+        void reserve( std::vector<unsigned long>::size_type n );
+
+        /**
+         * appends a new row with all cells unset
+         *
+         * @param aRowIdx - index of the new row
+         * @return position of the new row in the storage
+         */
+        std::vector<unsigned long>::size_type appendRow( unsigned long aRowIdx );
+
+        /**
+         * sets a cell of a row appended before
+         *
+         * @param aRowPos - position of the row (as returned by appendRow)
+         * @param aColIdx - column index (1 .. getColumnCount())
+         * @param syn - value to store
+         */
+        void setCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, NS_SNMP SnmpSyntax const &syn );
+
+        /**
+         * marks a cell of a row appended before as being present without a value
+         */
+        void setNullCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx );
+
+        void setCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SmiUINT32 syntax, unsigned long long value );
+        void setCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, char const *s, unsigned long len );
+
+        /**
+         * sets a cell of a row appended before unless it already holds
+         * the specified value
+         *
+         * @param aRowPos - position of the row (as returned by appendRow)
+         * @param aColIdx - column index (1 .. getColumnCount())
+         * @param syn - value to store
+         *
+         * @return bool - true when the cell has been changed
+         */
+        bool updateCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, NS_SNMP SnmpSyntax const &syn );
+        bool updateCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SmiUINT32 syntax, unsigned long long value );
+        bool updateCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, char const *s, unsigned long len );
+
+        /**
+         * removes rows, the order of the remaining rows is kept
+         *
+         * @param aRowPositions - ascending positions of the rows to remove
+         */
+        void removeRows( std::vector<std::vector<unsigned long>::size_type> const &aRowPositions );
+
+        /**
+         * assigns the row indices 1 .. getRowCount() in storage order
+         */
+        void renumberRows();
+
+        /**
+         * rebuilds the string arena when more than half of it is taken by
+         * strings which have been replaced or removed
+         */
+        void compact();
+
+        /**
+         * sorts rows by their index and removes duplicates
+         */
+        void sort();
+
+        /**
+         * finds the cell addressed by given oid (relative to the container)
+         *
+         * @param o - oid relative to the container base oid
+         * @param vb - receives the materialized cell when found
+         * @return true when the cell exists, false otherwise
+         */
+        bool get( NS_AGENT Oidx const &o, NS_AGENT Vbx &vb ) const;
+
+        /**
+         * finds the oid of the first cell behind the given oid
+         *
+         * @param o - oid relative to the container base oid
+         * @param succ - receives the oid of the successor (relative to the container)
+         * @return true when a successor exists in this table
+         */
+        bool find_succ( NS_AGENT Oidx const &o, NS_AGENT Oidx &succ ) const;
+
+    protected:
+        NS_AGENT Oidx mTableEntryOid;
+        std::vector<unsigned long> mRowIndices;
+        std::vector<ColumnType> mColumns;
+        std::vector<bool> mColumnEnabled;
+        std::string mStrings;
+        std::vector<NS_SNMP SnmpSyntax *> mForeign;
+        bool mSorted;
+        //! bytes of mStrings which aren't referenced by any cell
+        std::string::size_type mStringGarbage;
+
+        void clearForeign();
+        Cell & cellAt( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx );
+        bool storeCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, NS_SNMP SnmpSyntax const &syn, bool onlyChanged );
+        bool storeCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SmiUINT32 syntax, unsigned long long value, bool onlyChanged );
+        bool storeCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, char const *s, unsigned long len, bool onlyChanged );
+        /**
+         * accounts the arena space of a string cell about to be overwritten
+         */
+        void releaseCell( Cell const &cell ) { if( cell.Storage == csString ) mStringGarbage += cell.Length; }
+        bool firstCellFrom( unsigned long aColIdx, std::vector<unsigned long>::size_type aRowPos, NS_AGENT Oidx &succ ) const;
+        void materialize( Cell const &cell, NS_AGENT Vbx &vb ) const;
+
+    private:
+        MibContainerTableData();
+    };
+}
+
+#endif /* __SMART_SNMPD_MIB_CONTAINER_TABLE_DATA_H_INCLUDED__ */
@@ -25,6 +25,7 @@
 #include <smart-snmpd/log.h>
 
 #include <string>
+#include <string.h>
 #include <set>
 #include <stdexcept>
 
@@ -62,6 +63,21 @@ namespace SmartSnmpd
             , mColumnCount( aColumnCount )
             , mRowIdx( aRowIdx )
             , mColIdx( 1 )
+            , mRowPos( aTable.mData.appendRow( aRowIdx ) )
+            , mUpdate( false )
+        {}
+
+        /**
+         * addresses a row appended before for changing its values - only
+         * cells whose value differs are written (see MibContainerTable::updateRow())
+         */
+        MibContainerTableRow( MibContainerTable &aTable, unsigned long aColumnCount, std::vector<unsigned long>::size_type aRowPos, bool )
+            : mTable( aTable )
+            , mColumnCount( aColumnCount )
+            , mRowIdx( aTable.mData.getRowIndex( aRowPos ) )
+            , mColIdx( 1 )
+            , mRowPos( aRowPos )
+            , mUpdate( true )
         {}
 
         MibContainerTableRow( MibContainerTableRow const &ref )
@@ -69,11 +85,24 @@ namespace SmartSnmpd
             , mColumnCount( ref.mColumnCount )
             , mRowIdx( ref.mRowIdx )
             , mColIdx( ref.mColIdx )
+            , mRowPos( ref.mRowPos )
+            , mUpdate( ref.mUpdate )
         {}
 
         virtual ~MibContainerTableRow() {}
 
         unsigned long long getCurrentRowIndex() const { return mRowIdx; }
+        /**
+         * returns the position of the row in the storage of the table
+         */
+        std::vector<unsigned long>::size_type getRowPosition() const { return mRowPos; }
+
+        /**
+         * tells whether the value for the specified column is stored
+         *
+         * @param aCol - column index (1 .. column count)
+         */
+        bool isColumnEnabled( unsigned long aCol ) const { return mTable.isColumnEnabled( aCol ); }
 
         MibContainerTableRow & operator () (NS_SNMP SnmpSyntax const &syn) { return setCurrentColumn(syn); }
         MibContainerTableRow & operator () (int i) { return setCurrentColumn(i); }
@@ -82,50 +111,62 @@ namespace SmartSnmpd
         MibContainerTableRow & operator () (unsigned long lu) { return setCurrentColumn(lu); }
         MibContainerTableRow & operator () (unsigned long long llu) { return setCurrentColumn(llu); }
         MibContainerTableRow & operator () ( std::string const &s ) { return setCurrentColumn(s); }
+        MibContainerTableRow & operator () ( char const *s ) { return setCurrentColumn(s); }
 
         MibContainerTableRow & setCurrentColumn(NS_SNMP SnmpSyntax const &syn)
         {
-            // XXX assert mColIdx < mColumnCount
-            if( mColIdx > mColumnCount )
-                throw InvalidColumnIndex( mColIdx, mColumnCount, mTable.getTableEntryOid() );
-
-#if 0
-            NS_AGENT Oidx curColOid( mTable.getTableEntryOid() );
-            curColOid += mColIdx;
-            curColOid += mRowIdx;
+            if( skipCurrentColumn() )
+                return *this;
+            if( mUpdate )
+                (void)mTable.mData.updateCell( mRowPos, mColIdx, syn );
+            else
+                mTable.mData.setCell( mRowPos, mColIdx, syn );
+            ++mColIdx;
 
-            mTable.mContainer.add( curColOid, syn );
-#endif
-            mTable.mContainer.add( Oidx( mTable.getTableEntryOid(), Oidx( &mColIdx, 1 ), Oidx( &mRowIdx, 1 ) ), syn );
+            return *this;
+        }
 
+        MibContainerTableRow & setCurrentColumn(int i) { return setCurrentColumn( sNMP_SYNTAX_INT32, (unsigned long long)(long long)i ); }
+        MibContainerTableRow & setCurrentColumn(long l) { return setCurrentColumn( sNMP_SYNTAX_INT32, (unsigned long long)(long long)l ); }
+        MibContainerTableRow & setCurrentColumn(unsigned int u) { return setCurrentColumn( sNMP_SYNTAX_UINT32, (unsigned long long)u ); }
+        MibContainerTableRow & setCurrentColumn(unsigned long lu) { return setCurrentColumn( sNMP_SYNTAX_UINT32, (unsigned long long)lu ); }
+        MibContainerTableRow & setCurrentColumn(unsigned long long llu) { return setCurrentColumn( sNMP_SYNTAX_CNTR64, llu ); }
+        MibContainerTableRow & setCurrentColumn( std::string const &s )
+        {
+            if( skipCurrentColumn() )
+                return *this;
+            if( mUpdate )
+                (void)mTable.mData.updateCell( mRowPos, mColIdx, s.data(), s.length() );
+            else
+                mTable.mData.setCell( mRowPos, mColIdx, s.data(), s.length() );
             ++mColIdx;
 
             return *this;
         }
 
-        MibContainerTableRow & setCurrentColumn(int i) { return setCurrentColumn( SnmpInt32(i) ); }
-        MibContainerTableRow & setCurrentColumn(long l) { return setCurrentColumn( SnmpInt32(l) ); }
-        MibContainerTableRow & setCurrentColumn(unsigned int u) { return setCurrentColumn( SnmpUInt32(u) ); }
-        MibContainerTableRow & setCurrentColumn(unsigned long lu) { return setCurrentColumn( SnmpUInt32(lu) ); }
-        MibContainerTableRow & setCurrentColumn(unsigned long long llu) { return setCurrentColumn( Counter64(llu) ); }
-        MibContainerTableRow & setCurrentColumn( std::string const &s ) { return setCurrentColumn( OctetStr( s.c_str() ) ); }
+        /**
+         * sets an octet string column from a C string, NULL results in an empty string
+         */
+        MibContainerTableRow & setCurrentColumn( char const *s )
+        {
+            if( skipCurrentColumn() )
+                return *this;
+            if( mUpdate )
+                (void)mTable.mData.updateCell( mRowPos, mColIdx, s ? s : "", s ? strlen( s ) : 0 );
+            else
+                mTable.mData.setCell( mRowPos, mColIdx, s ? s : "", s ? strlen( s ) : 0 );
+            ++mColIdx;
+
+            return *this;
+        }
 
         MibContainerTableRow & operator () () { return setCurrentColumn(); }
 
         MibContainerTableRow & setCurrentColumn()
         {
-            // XXX assert mColIdx < mColumnCount
-            if( mColIdx > mColumnCount )
-                throw InvalidColumnIndex( mColIdx, mColumnCount, mTable.getTableEntryOid() );
-
-#if 0
-            NS_AGENT Oidx curColOid( mTable.getTableEntryOid() );
-            curColOid += mColIdx;
-            curColOid += mRowIdx;
-
-            mTable.mContainer.add( NS_AGENT Vbx( curColOid ) );
-#endif
-            mTable.mContainer.add( NS_AGENT Vbx( Oidx( mTable.getTableEntryOid(), Oidx( &mColIdx, 1 ), Oidx( &mRowIdx, 1 ) ) ) );
+            if( skipCurrentColumn() )
+                return *this;
+            mTable.mData.setNullCell( mRowPos, mColIdx );
             ++mColIdx;
 
             return *this;
@@ -142,6 +183,44 @@ namespace SmartSnmpd
         const unsigned long mColumnCount;
         const unsigned long mRowIdx;
         unsigned long mColIdx;
+        const std::vector<unsigned long>::size_type mRowPos;
+        //! only cells whose value differs are written
+        const bool mUpdate;
+
+        void checkCurrentColumn() const
+        {
+            // XXX assert mColIdx < mColumnCount
+            if( mColIdx > mColumnCount )
+                throw InvalidColumnIndex( mColIdx, mColumnCount, mTable.getTableEntryOid() );
+        }
+
+        /**
+         * advances over the current column when it isn't stored
+         *
+         * @return bool - true when the value for the current column has to be dropped
+         */
+        bool skipCurrentColumn()
+        {
+            checkCurrentColumn();
+            if( mTable.mData.isColumnEnabled( mColIdx ) )
+                return false;
+
+            ++mColIdx;
+            return true;
+        }
+
+        MibContainerTableRow & setCurrentColumn( SmiUINT32 syntax, unsigned long long value )
+        {
+            if( skipCurrentColumn() )
+                return *this;
+            if( mUpdate )
+                (void)mTable.mData.updateCell( mRowPos, mColIdx, syntax, value );
+            else
+                mTable.mData.setCell( mRowPos, mColIdx, syntax, value );
+            ++mColIdx;
+
+            return *this;
+        }
 
     private:
         MibContainerTableRow();
@@ -260,6 +260,23 @@
 #define SM_MEAN_VIRTUAL_MEMORY_ERR_OK		SM_DAEMON_STATUS	SM_MEAN_VIRTUAL_MEMORY_ERR_OK_KEY
 #define SM_MEAN_RESIDENT_MEMORY_ERR_OK_KEY				".16"
 #define SM_MEAN_RESIDENT_MEMORY_ERR_OK		SM_DAEMON_STATUS	SM_MEAN_RESIDENT_MEMORY_ERR_OK_KEY
+#define SM_UPDATE_JOB_INDEX_KEY						".1"
+#define SM_UPDATE_JOB_MIB_OBJECT_KEY					".2"
+#define SM_UPDATE_JOB_NEXT_RUN_KEY					".3"
+#define SM_UPDATE_JOB_LAST_RUN_KEY					".4"
+#define SM_UPDATE_JOB_LAST_DURATION_KEY					".5"
+#define SM_UPDATE_JOB_RUNS_KEY						".6"
+#define SM_UPDATE_JOB_RUNNING_KEY					".7"
+#define SM_UPDATE_JOB_TABLE_KEY						".17"
+#define SM_UPDATE_JOB_TABLE			SM_DAEMON_STATUS	SM_UPDATE_JOB_TABLE_KEY
+#define SM_UPDATE_JOB_ENTRY			SM_UPDATE_JOB_TABLE	SM_TABLE_ENTRY_KEY
+#define SM_UPDATE_JOB_INDEX			SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_INDEX_KEY
+#define SM_UPDATE_JOB_MIB_OBJECT		SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_MIB_OBJECT_KEY
+#define SM_UPDATE_JOB_NEXT_RUN			SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_NEXT_RUN_KEY
+#define SM_UPDATE_JOB_LAST_RUN			SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_LAST_RUN_KEY
+#define SM_UPDATE_JOB_LAST_DURATION		SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_LAST_DURATION_KEY
+#define SM_UPDATE_JOB_RUNS			SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_RUNS_KEY
+#define SM_UPDATE_JOB_RUNNING			SM_UPDATE_JOB_ENTRY	SM_UPDATE_JOB_RUNNING_KEY
 
 #define SM_HOST_INFO				SM_MIB_OBJECTS		".2"
 #define SM_LAST_UPDATE_HOST_INFO		SM_HOST_INFO		SM_LAST_UPDATE_MIB_KEY
@@ -293,6 +310,10 @@
 #define SM_CPU_INTERVAL_FROM			SM_CPU_USAGE		SM_CPU_INTERVAL_FROM_KEY
 #define SM_CPU_INTERVAL_UNTIL_KEY					".3"
 #define SM_CPU_INTERVAL_UNTIL			SM_CPU_USAGE		SM_CPU_INTERVAL_UNTIL_KEY
+#define SM_CPU_INTERVAL_FROM_MS_KEY					".6"
+#define SM_CPU_INTERVAL_FROM_MS			SM_CPU_USAGE		SM_CPU_INTERVAL_FROM_MS_KEY
+#define SM_CPU_INTERVAL_UNTIL_MS_KEY					".7"
+#define SM_CPU_INTERVAL_UNTIL_MS		SM_CPU_USAGE		SM_CPU_INTERVAL_UNTIL_MS_KEY
 #define SM_CPU_TOTAL_KEY						".4"
 #define SM_CPU_USER_TIME_TOTAL_KEY		SM_CPU_TOTAL_KEY	".1"
 #define SM_CPU_USER_TIME_TOTAL			SM_CPU_USAGE		SM_CPU_USER_TIME_TOTAL_KEY
@@ -486,6 +507,44 @@
 #define SM_PROCESS_NICE				SM_PROCESS_ENTRY	SM_PROCESS_NICE_KEY
 #define SM_PROCESS_CPU_PERCENT			SM_PROCESS_ENTRY	SM_PROCESS_CPU_PERCENT_KEY
 
+#define SM_PROCESS_TOP_RANK_KEY					".1"
+#define SM_PROCESS_TOP_PID_KEY					".2"
+#define SM_PROCESS_TOP_EXE_KEY					".3"
+#define SM_PROCESS_TOP_USERNAME_KEY				".4"
+#define SM_PROCESS_TOP_RSIZE_KEY				".5"
+#define SM_PROCESS_TOP_CPU_TIME_KEY				".6"
+#define SM_PROCESS_TOP_CPU_PERCENT_KEY				".7"
+#define SM_PROCESS_TOP_CPU_TABLE_KEY				".8"
+#define SM_PROCESS_TOP_CPU_TABLE	SM_PROCESS_STATUS	SM_PROCESS_TOP_CPU_TABLE_KEY
+#define SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_CPU_TABLE	SM_TABLE_ENTRY_KEY
+#define SM_PROCESS_TOP_CPU_RANK		SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_RANK_KEY
+#define SM_PROCESS_TOP_CPU_PID		SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_PID_KEY
+#define SM_PROCESS_TOP_CPU_EXE		SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_EXE_KEY
+#define SM_PROCESS_TOP_CPU_USERNAME	SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_USERNAME_KEY
+#define SM_PROCESS_TOP_CPU_RSIZE	SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_RSIZE_KEY
+#define SM_PROCESS_TOP_CPU_CPU_TIME	SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_CPU_TIME_KEY
+#define SM_PROCESS_TOP_CPU_CPU_PERCENT	SM_PROCESS_TOP_CPU_ENTRY	SM_PROCESS_TOP_CPU_PERCENT_KEY
+#define SM_PROCESS_TOP_RSIZE_TABLE_KEY				".9"
+#define SM_PROCESS_TOP_RSIZE_TABLE	SM_PROCESS_STATUS	SM_PROCESS_TOP_RSIZE_TABLE_KEY
+#define SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_RSIZE_TABLE	SM_TABLE_ENTRY_KEY
+#define SM_PROCESS_TOP_RSIZE_RANK	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_RANK_KEY
+#define SM_PROCESS_TOP_RSIZE_PID	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_PID_KEY
+#define SM_PROCESS_TOP_RSIZE_EXE	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_EXE_KEY
+#define SM_PROCESS_TOP_RSIZE_USERNAME	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_USERNAME_KEY
+#define SM_PROCESS_TOP_RSIZE_RSIZE	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_RSIZE_KEY
+#define SM_PROCESS_TOP_RSIZE_CPU_TIME	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_CPU_TIME_KEY
+#define SM_PROCESS_TOP_RSIZE_CPU_PERCENT	SM_PROCESS_TOP_RSIZE_ENTRY	SM_PROCESS_TOP_CPU_PERCENT_KEY
+#define SM_PROCESS_TOP_CPU_TIME_TABLE_KEY			".10"
+#define SM_PROCESS_TOP_CPU_TIME_TABLE	SM_PROCESS_STATUS	SM_PROCESS_TOP_CPU_TIME_TABLE_KEY
+#define SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_CPU_TIME_TABLE	SM_TABLE_ENTRY_KEY
+#define SM_PROCESS_TOP_CPU_TIME_RANK	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_RANK_KEY
+#define SM_PROCESS_TOP_CPU_TIME_PID	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_PID_KEY
+#define SM_PROCESS_TOP_CPU_TIME_EXE	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_EXE_KEY
+#define SM_PROCESS_TOP_CPU_TIME_USERNAME	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_USERNAME_KEY
+#define SM_PROCESS_TOP_CPU_TIME_RSIZE	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_RSIZE_KEY
+#define SM_PROCESS_TOP_CPU_TIME_CPU_TIME	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_CPU_TIME_KEY
+#define SM_PROCESS_TOP_CPU_TIME_CPU_PERCENT	SM_PROCESS_TOP_CPU_TIME_ENTRY	SM_PROCESS_TOP_CPU_PERCENT_KEY
+
 #define SM_FILE_SYSTEM_USAGE			SM_MIB_OBJECTS		".8"
 #define SM_LAST_UPDATE_FILE_SYSTEM_USAGE	SM_FILE_SYSTEM_USAGE	SM_LAST_UPDATE_MIB_KEY
 #define SM_FILE_SYSTEM_COUNT_KEY					".2"
@@ -553,6 +612,10 @@
 #define SM_DISK_IO_INTERVAL_FROM		SM_DISK_IO_STATUS	SM_DISK_IO_INTERVAL_FROM_KEY
 #define SM_DISK_IO_INTERVAL_UNTIL_KEY					".5"
 #define SM_DISK_IO_INTERVAL_UNTIL		SM_DISK_IO_STATUS	SM_DISK_IO_INTERVAL_UNTIL_KEY
+#define SM_DISK_IO_INTERVAL_FROM_MS_KEY					".7"
+#define SM_DISK_IO_INTERVAL_FROM_MS		SM_DISK_IO_STATUS	SM_DISK_IO_INTERVAL_FROM_MS_KEY
+#define SM_DISK_IO_INTERVAL_UNTIL_MS_KEY				".8"
+#define SM_DISK_IO_INTERVAL_UNTIL_MS		SM_DISK_IO_STATUS	SM_DISK_IO_INTERVAL_UNTIL_MS_KEY
 #define SM_DISK_IO_INTERVAL_TABLE_KEY					".6"
 #define SM_DISK_IO_INTERVAL_TABLE		SM_DISK_IO_STATUS	SM_DISK_IO_INTERVAL_TABLE_KEY
 #define SM_DISK_IO_INTERVAL_ENTRY		SM_DISK_IO_INTERVAL_TABLE	SM_TABLE_ENTRY_KEY
@@ -590,6 +653,10 @@
 #define SM_NETWORK_IO_INTERVAL_FROM		SM_NETWORK_IO_STATUS	SM_NETWORK_IO_INTERVAL_FROM_KEY
 #define SM_NETWORK_IO_INTERVAL_UNTIL_KEY				".5"
 #define SM_NETWORK_IO_INTERVAL_UNTIL		SM_NETWORK_IO_STATUS	SM_NETWORK_IO_INTERVAL_UNTIL_KEY
+#define SM_NETWORK_IO_INTERVAL_FROM_MS_KEY				".7"
+#define SM_NETWORK_IO_INTERVAL_FROM_MS		SM_NETWORK_IO_STATUS	SM_NETWORK_IO_INTERVAL_FROM_MS_KEY
+#define SM_NETWORK_IO_INTERVAL_UNTIL_MS_KEY				".8"
+#define SM_NETWORK_IO_INTERVAL_UNTIL_MS		SM_NETWORK_IO_STATUS	SM_NETWORK_IO_INTERVAL_UNTIL_MS_KEY
 #define SM_NETWORK_IO_INTERVAL_TABLE_KEY				".6"
 #define SM_NETWORK_IO_INTERVAL_TABLE		SM_NETWORK_IO_STATUS	SM_NETWORK_IO_INTERVAL_TABLE_KEY
 #define SM_NETWORK_IO_INTERVAL_ENTRY		SM_NETWORK_IO_INTERVAL_TABLE	SM_TABLE_ENTRY_KEY
@@ -602,6 +669,33 @@
 #define SM_NETWORK_IO_INTERVAL_INERRORS		SM_NETWORK_IO_INTERVAL_ENTRY	SM_NETWORK_IO_INERRORS_KEY
 #define SM_NETWORK_IO_INTERVAL_OUTERRORS	SM_NETWORK_IO_INTERVAL_ENTRY	SM_NETWORK_IO_OUTERRORS_KEY
 #define SM_NETWORK_IO_INTERVAL_COLLISIONS	SM_NETWORK_IO_INTERVAL_ENTRY	SM_NETWORK_IO_COLLISIONS_KEY
+#define SM_NETWORK_IO_RATE_TABLE_KEY					".9"
+#define SM_NETWORK_IO_RATE_TABLE		SM_NETWORK_IO_STATUS	SM_NETWORK_IO_RATE_TABLE_KEY
+#define SM_NETWORK_IO_RATE_ENTRY		SM_NETWORK_IO_RATE_TABLE	SM_TABLE_ENTRY_KEY
+#define SM_NETWORK_IO_RATE_INDEX_KEY					".1"
+#define SM_NETWORK_IO_RATE_INTERFACE_KEY				".2"
+#define SM_NETWORK_IO_RATE_WINDOW_KEY					".3"
+#define SM_NETWORK_IO_RATE_SAMPLES_KEY					".4"
+#define SM_NETWORK_IO_RATE_TX_MIN_KEY					".5"
+#define SM_NETWORK_IO_RATE_TX_AVG_KEY					".6"
+#define SM_NETWORK_IO_RATE_TX_MAX_KEY					".7"
+#define SM_NETWORK_IO_RATE_TX_PERCENTILE_KEY				".8"
+#define SM_NETWORK_IO_RATE_RX_MIN_KEY					".9"
+#define SM_NETWORK_IO_RATE_RX_AVG_KEY					".10"
+#define SM_NETWORK_IO_RATE_RX_MAX_KEY					".11"
+#define SM_NETWORK_IO_RATE_RX_PERCENTILE_KEY				".12"
+#define SM_NETWORK_IO_RATE_INDEX		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_INDEX_KEY
+#define SM_NETWORK_IO_RATE_INTERFACE		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_INTERFACE_KEY
+#define SM_NETWORK_IO_RATE_WINDOW		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_WINDOW_KEY
+#define SM_NETWORK_IO_RATE_SAMPLES		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_SAMPLES_KEY
+#define SM_NETWORK_IO_RATE_TX_MIN		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_TX_MIN_KEY
+#define SM_NETWORK_IO_RATE_TX_AVG		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_TX_AVG_KEY
+#define SM_NETWORK_IO_RATE_TX_MAX		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_TX_MAX_KEY
+#define SM_NETWORK_IO_RATE_TX_PERCENTILE	SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_TX_PERCENTILE_KEY
+#define SM_NETWORK_IO_RATE_RX_MIN		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_RX_MIN_KEY
+#define SM_NETWORK_IO_RATE_RX_AVG		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_RX_AVG_KEY
+#define SM_NETWORK_IO_RATE_RX_MAX		SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_RX_MAX_KEY
+#define SM_NETWORK_IO_RATE_RX_PERCENTILE	SM_NETWORK_IO_RATE_ENTRY	SM_NETWORK_IO_RATE_RX_PERCENTILE_KEY
 
 #define SM_SWAP_IO_STATUS			SM_MIB_OBJECTS		".22"
 #define SM_LAST_UPDATE_SWAP_IO_STATUS		SM_SWAP_IO_STATUS	SM_LAST_UPDATE_MIB_KEY
@@ -609,6 +703,10 @@
 #define SM_SWAP_IO_INTERVAL_FROM		SM_SWAP_IO_STATUS	SM_SWAP_IO_INTERVAL_FROM_KEY
 #define SM_SWAP_IO_INTERVAL_UNTIL_KEY					".3"
 #define SM_SWAP_IO_INTERVAL_UNTIL		SM_SWAP_IO_STATUS	SM_SWAP_IO_INTERVAL_UNTIL_KEY
+#define SM_SWAP_IO_INTERVAL_FROM_MS_KEY					".6"
+#define SM_SWAP_IO_INTERVAL_FROM_MS		SM_SWAP_IO_STATUS	SM_SWAP_IO_INTERVAL_FROM_MS_KEY
+#define SM_SWAP_IO_INTERVAL_UNTIL_MS_KEY				".7"
+#define SM_SWAP_IO_INTERVAL_UNTIL_MS		SM_SWAP_IO_STATUS	SM_SWAP_IO_INTERVAL_UNTIL_MS_KEY
 #define SM_SWAP_IO_TOTAL_KEY						".4"
 #define SM_SWAP_IO_TOTAL			SM_SWAP_IO_STATUS	SM_SWAP_IO_TOTAL_KEY
 #define SM_SWAP_PAGES_IN_TOTAL_KEY		SM_SWAP_IO_TOTAL_KEY	".1"
@@ -634,6 +732,10 @@
 #define SM_EXTERNAL_COMMAND_LAST_EXIT_SIGNAL				"8"
 #define SM_EXTERNAL_COMMAND_ERROR_CODE					"9"
 #define SM_EXTERNAL_COMMAND_ERROR_MESSAGE				"10"
+#define SM_EXTERNAL_COMMAND_STDOUT_BYTES				"11"
+#define SM_EXTERNAL_COMMAND_STDERR_BYTES				"12"
+#define SM_EXTERNAL_COMMAND_DISCARDED_BYTES				"13"
+#define SM_EXTERNAL_COMMAND_OUTPUT_OVERFLOWS				"14"
 #define SM_EXTERNAL_COMMAND_DATA					"100"
 
 #define SM_APP_MONITORING			SM_EXTERNAL_COMMANDS	".1"
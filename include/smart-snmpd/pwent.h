@@ -21,6 +21,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #ifndef WIN32
 #include <sys/types.h>
@@ -30,6 +31,11 @@ namespace SmartSnmpd
 {
     /**
      * provides access to information of system user accounts
+     *
+     * The resolved information is kept in a cache shared by all
+     * instances. Entries expire after the configured time (failed lookups
+     * after a shorter one), the whole cache is dropped when /etc/passwd or
+     * /etc/group are modified or invalidate() is called (eg. on SIGHUP).
      */
     class SystemUserInfo
     {
@@ -46,16 +52,31 @@ namespace SmartSnmpd
         typedef ::gid_t gid_t;
 #endif
 
+        /**
+         * identity of a user account to run processes with
+         */
+        struct Credentials
+        {
+            inline Credentials()
+                : Uid((uid_t)-1)
+                , Gid((gid_t)-1)
+                , Groups()
+            {}
+
+            //! user id
+            uid_t Uid;
+            //! primary group id
+            gid_t Gid;
+            //! supplementary group ids (including the primary group)
+            std::vector<gid_t> Groups;
+        };
+
         /**
          * default constructor
          */
         inline SystemUserInfo()
-            : mPwNameCache()
-            , mPwUidCache()
-            , mGrNameCache()
-            , mGrGidCache()
 #ifndef WIN32
-            , mSysBuf( guess_pwent_bufsize() )
+            : mSysBuf( guess_pwent_bufsize() )
 #endif
         {}
 
@@ -72,10 +93,10 @@ namespace SmartSnmpd
          * the same object from different threads.
          *
          * @param id - user id
-         * @return string const & - reference to a string containing the
-         *  user name, the string is empty if no name could resolved
+         * @return string - the user name, the string is empty if no name
+         *  could resolved
          */
-        string const & getusernamebyuid(uid_t id);
+        string getusernamebyuid(uid_t id);
         /**
          * delivers the group name from the group id
          *
@@ -84,10 +105,10 @@ namespace SmartSnmpd
          * the same object from different threads.
          *
          * @param id - group id
-         * @return string const & - reference to a string containing the
-         *  group name, the string is empty if no name could resolved
+         * @return string - the group name, the string is empty if no name
+         *  could resolved
          */
-        string const & getgroupnamebygid(gid_t id);
+        string getgroupnamebygid(gid_t id);
         /**
          * delivers the user id from the user name
          *
@@ -110,12 +131,36 @@ namespace SmartSnmpd
          * @return gid_t - group id, (gid_t)-1 if no id could resolved
          */
         gid_t getgroupidbyname(string const &name);
+        /**
+         * delivers user id, primary group id and supplementary groups of
+         * a user
+         *
+         * This method tries to resolve the identity of given user name.
+         * The local used buffer objects are not reentrant. Avoid using
+         * the same object from different threads.
+         *
+         * @param name - string containing the user name to resolve
+         * @param cred - receives the identity of the user
+         * @return bool - true when the user could be resolved
+         */
+        bool getusercredentials(string const &name, Credentials &cred);
+
+        /**
+         * drops all cached user and group information of all instances
+         * (SYNCHRONIZED)
+         */
+        static void invalidate();
+        /**
+         * sets how long resolved information is cached (SYNCHRONIZED)
+         *
+         * @param positive - time in milliseconds to keep resolved names
+         *  and ids, 0 disables caching
+         * @param negative - time in milliseconds to remember failed
+         *  lookups, 0 disables caching
+         */
+        static void setCacheTimeouts(unsigned long positive, unsigned long negative);
 
     protected:
-        std::map<string, uid_t> mPwNameCache;
-        std::map<uid_t, string> mPwUidCache;
-        std::map<string, gid_t> mGrNameCache;
-        std::map<gid_t, string> mGrGidCache;
 #ifndef WIN32
         /**
          * buffer object to allow reentrant system calls to store data
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_RATE_HISTORY_H_INCLUDED__
+#define __SMART_SNMPD_RATE_HISTORY_H_INCLUDED__
+
+#include <vector>
+#include <algorithm>
+
+namespace SmartSnmpd
+{
+    /**
+     * aggregation of rates over several sliding windows
+     *
+     * All windows share one ring buffer sized for the largest window,
+     * each window covers the rates added within its length before the
+     * most recent one. Rates are evicted by their timestamp, so a window
+     * covers the configured time even when the rates aren't added at the
+     * expected sample interval. The sums used for the average are updated
+     * incrementally when a rate is added, minimum, maximum and percentile
+     * are calculated when a summary is requested. Memory is only allocated
+     * by setup().
+     */
+    class RateHistory
+    {
+    public:
+        /**
+         * aggregated rates of one window
+         */
+        struct Summary
+        {
+            unsigned long long Min;
+            unsigned long long Max;
+            unsigned long long Avg;
+            unsigned long long Percentile;
+            //! number of rates in the window
+            size_t Samples;
+        };
+
+        /**
+         * default constructor - no windows are configured
+         */
+        RateHistory()
+            : mRates()
+            , mTimestamps()
+            , mNext(0)
+            , mCount(0)
+            , mWindows()
+            , mWindowCounts()
+            , mWindowSums()
+            , mPercentile(95)
+            , mScratch()
+        {}
+
+        /**
+         * (re-)configures the windows, previously added rates are dropped
+         *
+         * @param aSampleInterval - expected time between two rates in
+         *    milliseconds, used to size the ring buffer
+         * @param aWindows - length of the windows in milliseconds
+         * @param aPercentile - percentile to calculate (1 .. 100)
+         */
+        void setup( unsigned long aSampleInterval, std::vector<unsigned long> const &aWindows, unsigned aPercentile )
+        {
+            size_t capacity = 1;
+
+            mWindows = aWindows;
+            mWindowCounts.assign( mWindows.size(), 0 );
+            mWindowSums.assign( mWindows.size(), 0 );
+            for( size_t i = 0; i < mWindows.size(); ++i )
+            {
+                // one more for the rate at the edge of the window
+                size_t samples = ( aSampleInterval ? mWindows[i] / aSampleInterval : 0 ) + 1;
+                capacity = std::max( capacity, samples );
+            }
+
+            mRates.assign( capacity, 0 );
+            mTimestamps.assign( capacity, 0 );
+            mScratch.reserve( capacity );
+            mNext = mCount = 0;
+            mPercentile = aPercentile;
+        }
+
+        /**
+         * adds the rate of the most recent sample interval and evicts the
+         * rates which have left a window
+         *
+         * When rates are added faster than expected and the ring buffer is
+         * full, the oldest rate is dropped from all windows.
+         *
+         * @param aRate - the rate to add
+         * @param aTimestamp - time at the end of the sample interval in
+         *    milliseconds, must not decrease
+         */
+        void add( unsigned long long aRate, unsigned long long aTimestamp )
+        {
+            if( mRates.empty() || mWindows.empty() )
+                return;
+
+            if( mCount == mRates.size() )
+            {
+                // mNext points to the oldest rate
+                for( size_t i = 0; i < mWindows.size(); ++i )
+                {
+                    if( mWindowCounts[i] == mCount )
+                    {
+                        mWindowSums[i] -= mRates[mNext];
+                        --mWindowCounts[i];
+                    }
+                }
+                --mCount;
+            }
+
+            mRates[mNext] = aRate;
+            mTimestamps[mNext] = aTimestamp;
+            mNext = ( mNext + 1 ) % mRates.size();
+            ++mCount;
+
+            for( size_t i = 0; i < mWindows.size(); ++i )
+            {
+                mWindowSums[i] += aRate;
+                ++mWindowCounts[i];
+
+                // the most recent rate is always kept
+                while( mWindowCounts[i] > 1 )
+                {
+                    size_t oldest = position( mWindowCounts[i] );
+                    if( mTimestamps[oldest] + mWindows[i] > aTimestamp )
+                        break;
+
+                    mWindowSums[i] -= mRates[oldest];
+                    --mWindowCounts[i];
+                }
+            }
+        }
+
+        /**
+         * number of configured windows
+         *
+         * @return size_t - number of windows
+         */
+        size_t getWindowCount() const { return mWindows.size(); }
+        /**
+         * length of a window
+         *
+         * @param aWindow - index of the window
+         *
+         * @return unsigned long - length in milliseconds
+         */
+        unsigned long getWindow( size_t aWindow ) const { return mWindows[aWindow]; }
+
+        /**
+         * aggregates the rates of a window
+         *
+         * @param aWindow - index of the window
+         * @param aSummary - receives the aggregated rates
+         *
+         * @return bool - true when the window contains any rates
+         */
+        bool summarize( size_t aWindow, Summary &aSummary ) const
+        {
+            size_t n = mWindowCounts[aWindow];
+            if( 0 == n )
+                return false;
+
+            mScratch.clear(); // capacity reserved by setup()
+            for( size_t i = n; i > 0; --i )
+                mScratch.push_back( mRates[position( i )] );
+
+            aSummary.Min = *std::min_element( mScratch.begin(), mScratch.end() );
+            aSummary.Max = *std::max_element( mScratch.begin(), mScratch.end() );
+            aSummary.Avg = mWindowSums[aWindow] / n;
+            aSummary.Samples = n;
+
+            // nearest rank
+            size_t rank = ( n * mPercentile + 99 ) / 100;
+            std::vector<unsigned long long>::iterator nth = mScratch.begin() + ( rank ? rank - 1 : 0 );
+            std::nth_element( mScratch.begin(), nth, mScratch.end() );
+            aSummary.Percentile = *nth;
+
+            return true;
+        }
+
+    protected:
+        //! ring buffer of the rates, sized for the largest window
+        std::vector<unsigned long long> mRates;
+        //! time each rate in mRates has been added at
+        std::vector<unsigned long long> mTimestamps;
+        //! position the next rate is stored at
+        size_t mNext;
+        //! number of rates in mRates
+        size_t mCount;
+        //! length of the windows in milliseconds
+        std::vector<unsigned long> mWindows;
+        //! number of the most recent rates covered by each window
+        std::vector<size_t> mWindowCounts;
+        //! sum of the rates in each window
+        std::vector<unsigned long long> mWindowSums;
+        //! percentile to calculate
+        unsigned mPercentile;
+        //! working copy of a window for the percentile calculation
+        mutable std::vector<unsigned long long> mScratch;
+
+        /**
+         * position of the n-th most recent rate in the ring buffer
+         *
+         * @param n - 1 for the most recent rate, up to mCount
+         *
+         * @return size_t - index into mRates
+         */
+        size_t position( size_t n ) const { return ( mNext + mRates.size() - n ) % mRates.size(); }
+    };
+}
+
+#endif /* __SMART_SNMPD_RATE_HISTORY_H_INCLUDED__ */
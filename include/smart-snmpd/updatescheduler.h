@@ -0,0 +1,306 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __SMART_SNMPD_UPDATE_SCHEDULER_H_INCLUDED__
+#define __SMART_SNMPD_UPDATE_SCHEDULER_H_INCLUDED__
+
+#include <agent_pp/threads.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SmartSnmpd
+{
+    class DataSource;
+    class UpdateScheduler;
+
+    /**
+     * milliseconds of a monotonic clock - only differences are meaningful
+     */
+    typedef unsigned long long UpdateTime;
+
+    /**
+     * scheduling parameters of an update job
+     */
+    struct UpdateJobConfig
+    {
+        inline UpdateJobConfig()
+            : Interval(30000)
+            , Jitter(0)
+            , Priority(0)
+        {}
+
+        //! time between two updates in milliseconds
+        UpdateTime Interval;
+        //! maximum random delay added to each run in percent of Interval
+        unsigned Jitter;
+        //! jobs with higher priority are run first when several are due
+        int Priority;
+    };
+
+    /**
+     * run time information of an update job
+     */
+    struct UpdateJobStatus
+    {
+        inline UpdateJobStatus()
+            : NextRun(0)
+            , LastRun(0)
+            , LastDuration(0)
+            , Runs(0)
+            , Running(false)
+        {}
+
+        //! time when the job is run next (see UpdateScheduler::now())
+        UpdateTime NextRun;
+        //! time when the job was started last
+        UpdateTime LastRun;
+        //! duration of the last run in milliseconds
+        UpdateTime LastDuration;
+        //! number of runs since the job has been scheduled
+        unsigned long Runs;
+        //! flag whether the job is currently run by a worker
+        bool Running;
+    };
+
+    /**
+     * worker thread of the update scheduler
+     */
+    class UpdateWorker
+        : public NS_AGENT Thread
+    {
+    public:
+        /**
+         * constructor
+         *
+         * @param aScheduler - scheduler to fetch the jobs from
+         */
+        explicit UpdateWorker( UpdateScheduler &aScheduler )
+            : NS_AGENT Thread()
+            , mScheduler( aScheduler )
+        {}
+
+        //! destructor
+        virtual ~UpdateWorker() {}
+
+        //! thread main method
+        virtual void run();
+
+    protected:
+        //! scheduler delivering the jobs to run
+        UpdateScheduler &mScheduler;
+
+    private:
+        UpdateWorker();
+        UpdateWorker( UpdateWorker const & );
+        UpdateWorker & operator = ( UpdateWorker const & );
+    };
+
+    /**
+     * central scheduler for asynchronous updates of data sources
+     *
+     * All data sources which are updated in background are run by a
+     * small pool of worker threads. Due jobs are taken from a min-heap
+     * ordered by the next run time, jobs which are due at the same time
+     * are run by their priority.
+     */
+    class UpdateScheduler
+        : public NS_AGENT Synchronized
+    {
+        friend class UpdateWorker;
+
+    public:
+        //! destructor - stops the worker threads
+        virtual ~UpdateScheduler();
+
+        /**
+         * singleton accessor
+         *
+         * @return UpdateScheduler & - the scheduler instance
+         */
+        static UpdateScheduler & getInstance();
+
+        /**
+         * current time of the monotonic clock used for scheduling
+         *
+         * @return UpdateTime - milliseconds since an unspecified point in time
+         */
+        static UpdateTime now();
+
+        /**
+         * starts the worker threads (SYNCHRONIZED)
+         *
+         * @param aNumberOfWorkers - size of the worker pool
+         *
+         * @return bool - true when at least one worker is running
+         */
+        bool start( unsigned aNumberOfWorkers );
+        /**
+         * stops the worker threads after they finished their current job
+         */
+        void stop();
+
+        /**
+         * add a data source to the schedule or update its scheduling
+         * parameters (SYNCHRONIZED)
+         *
+         * The first update is done immediately (delayed by the configured
+         * jitter).
+         *
+         * @param aDataSource - data source to update regularly
+         * @param aJobConfig - scheduling parameters
+         *
+         * @return bool - true when scheduled, false when no worker is running
+         */
+        bool schedule( DataSource &aDataSource, UpdateJobConfig const &aJobConfig );
+        /**
+         * removes a data source from the schedule (SYNCHRONIZED)
+         *
+         * When the data source is currently updated, the method waits
+         * until the update has been finished.
+         *
+         * @param aDataSource - data source to remove
+         */
+        void unschedule( DataSource &aDataSource );
+        /**
+         * requests an update of a data source as soon as possible (SYNCHRONIZED)
+         *
+         * A scheduled data source is pulled forward, otherwise a one-shot
+         * job is added. Nothing is done when an update of the data source
+         * is already pending or running, unless aAfterRunning is set: then
+         * a running update is repeated immediately after it has been finished.
+         *
+         * @param aDataSource - data source to update
+         * @param aAfterRunning - repeat a currently running update
+         *
+         * @return bool - true when the update is run by a worker, false
+         *    when no worker is running
+         */
+        bool trigger( DataSource &aDataSource, bool aAfterRunning = false );
+        /**
+         * checks whether a data source is scheduled (SYNCHRONIZED)
+         *
+         * @param aDataSource - data source to check for
+         *
+         * @return bool - true when the data source is scheduled
+         */
+        bool isScheduled( DataSource const &aDataSource );
+        /**
+         * deliver run time information of all jobs (SYNCHRONIZED)
+         *
+         * @param aJobs - receives the object identifier of the mib object
+         *    updated by each job together with the job status, ordered by
+         *    the object identifiers
+         */
+        void getJobStatuses( std::vector< std::pair<std::string, UpdateJobStatus> > &aJobs );
+
+    protected:
+        //! scheduled update of a data source
+        struct Job
+        {
+            UpdateJobConfig Config;
+            UpdateJobStatus Status;
+            //! identifies the heap entries belonging to the current schedule
+            unsigned long Generation;
+            //! set while unschedule() waits for the running update
+            bool Removing;
+            //! job has been added by trigger() and is removed after its run
+            bool OneShot;
+            //! job is run again immediately after the running update
+            bool Retrigger;
+        };
+
+        //! entry in the timer or ready heap
+        struct HeapEntry
+        {
+            UpdateTime Due;
+            int Priority;
+            DataSource *Source;
+            unsigned long Generation;
+        };
+
+        //! orders the timer heap - earliest due entry on top
+        struct DueLater
+        {
+            bool operator () ( HeapEntry const &a, HeapEntry const &b ) const { return a.Due > b.Due; }
+        };
+
+        //! orders the ready heap - highest priority on top, earliest due first within a priority
+        struct LessUrgent
+        {
+            bool operator () ( HeapEntry const &a, HeapEntry const &b ) const
+            {
+                return ( a.Priority != b.Priority ) ? ( a.Priority < b.Priority ) : ( a.Due > b.Due );
+            }
+        };
+
+        typedef std::map<DataSource const *, Job> JobContainerType;
+
+        //! default constructor - see getInstance()
+        UpdateScheduler();
+
+        /**
+         * computes the next run of a job and pushes it to the timer heap (NOT SYNCHRONIZED)
+         *
+         * @param aDataSource - data source of the job
+         * @param aJob - the job to schedule
+         * @param aDue - time when the job is due (without jitter)
+         * @param aWithJitter - add the configured jitter to aDue
+         */
+        void enqueue( DataSource &aDataSource, Job &aJob, UpdateTime aDue, bool aWithJitter = true );
+        /**
+         * fetch the next job to run and mark it running, waits when no
+         * job is due (NOT SYNCHRONIZED - called with lock held)
+         *
+         * @return DataSource * - data source to update or 0 when stopped
+         */
+        DataSource * fetch();
+        /**
+         * mark the job of the specified data source as finished and
+         * reschedule it (NOT SYNCHRONIZED - called with lock held)
+         *
+         * @param aDataSource - data source which has been updated
+         * @param aStarted - time the update has been started
+         * @param aFinished - time the update has been finished
+         */
+        void finish( DataSource &aDataSource, UpdateTime aStarted, UpdateTime aFinished );
+
+        //! scheduled jobs
+        JobContainerType mJobs;
+        //! jobs waiting for their next run
+        std::vector<HeapEntry> mTimerHeap;
+        //! due jobs waiting for a worker
+        std::vector<HeapEntry> mReadyHeap;
+        //! worker pool
+        std::vector<UpdateWorker *> mWorkers;
+        //! next job generation
+        unsigned long mGeneration;
+        //! seed for jitter
+        unsigned int mSeed;
+        //! flag whether the workers shall run
+        bool mRunning;
+
+        static UpdateScheduler *mInstance;
+
+    private:
+        UpdateScheduler( UpdateScheduler const & );
+        UpdateScheduler & operator = ( UpdateScheduler const & );
+    };
+}
+
+#endif /* __SMART_SNMPD_UPDATE_SCHEDULER_H_INCLUDED__ */
@@ -21,6 +21,7 @@
 #include <smart-snmpd/config.h>
 #include <smart-snmpd/cmndline.h>
 #include <smart-snmpd/agent.h>
+#include <smart-snmpd/updatescheduler.h>
 
 #include <snmp_pp/log.h>
 
@@ -60,6 +61,13 @@ Agent::Agent()
     , mRunning( false )
     , mMibModules()
 {
+    if( !UpdateScheduler::getInstance().start( Config::getInstance().getNumberOfUpdateThreads() ) )
+    {
+        LOG_BEGIN(loggerModuleName, ERROR_LOG | 0);
+        LOG("Agent::Init(): failed to start update scheduler - asynchronous updates are disabled");
+        LOG_END;
+    }
+
     for( size_t i = 0; i < (lengthof(moduleInfoFuncs) - 1); ++i )
     {
         MibModule *modInfo = moduleInfoFuncs[i]();
@@ -207,6 +215,8 @@ Agent::~Agent()
 {
     Snmp::socket_cleanup();  // Shut down socket subsystem
 
+    UpdateScheduler::getInstance().stop(); // let running updates finish before mibs are removed
+
     for( vector<MibModule *>::size_type i = 0; i < mMibModules.size(); ++i )
     {
         MibModule *modInfo = mMibModules[i];
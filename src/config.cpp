@@ -30,6 +30,8 @@
 
 #include <stdarg.h>
 #include <fcntl.h>
+#include <ctype.h>
+#include <regex.h>
 
 #include <iostream>
 #include <sstream>
@@ -72,6 +74,11 @@ extern "C"
     int cb_verify_v1v2_access( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
     int cb_verify_rlimit( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
     int cb_verify_onfatal( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
+    int cb_verify_rowindex( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
+    int cb_verify_outputformat( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
+    int cb_verify_outputoverflow( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
+    int cb_verify_duration( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
+    int cb_verify_processcollector( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result );
 
     void cb_free_rlimit(void *ptr);
 }
@@ -87,34 +94,80 @@ static struct cfg_opt_t resource_opts[] = {
     CFG_END()
 };
 
+static struct cfg_opt_t row_filter_opts[] = {
+    CFG_STR("name", 0, CFGF_NONE),
+    CFG_STR("user", 0, CFGF_NONE),
+    CFG_STR_LIST("state", 0, CFGF_NONE),
+    CFG_INT("min-rss", 0, CFGF_NONE),
+    CFG_FLOAT("min-cpu", 0, CFGF_NONE),
+    CFG_STR_LIST("fs-type", 0, CFGF_NONE),
+    CFG_STR_LIST("mount-prefix", 0, CFGF_NONE),
+    CFG_END()
+};
+
 static struct cfg_opt_t mibobject_opts[] = {
     CFG_BOOL("mib-enabled", cfg_true, CFGF_NONE),
     CFG_BOOL("async-update", cfg_false, CFGF_NONE),
-    CFG_INT("cache-timeout", 30, CFGF_NONE),
+    CFG_INT_CB("cache-timeout", 30000, CFGF_NONE, &cb_verify_duration),
+    CFG_INT("update-jitter", 0, CFGF_NONE),
+    CFG_INT("update-priority", 0, CFGF_NONE),
+    CFG_BOOL("stale-while-revalidate", cfg_false, CFGF_NONE),
+    CFG_INT_CB("max-staleness", 0, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_CB("row-index", rowIndexSequential, CFGF_NONE, &cb_verify_rowindex),
+    CFG_INT_LIST("columns", 0, CFGF_NONE),
+    CFG_SEC("filter", row_filter_opts, CFGF_NONE),
     CFG_END()
 };
 static struct cfg_opt_t inrmibobject_opts[] = {
     CFG_BOOL("mib-enabled", cfg_true, CFGF_NONE),
     CFG_BOOL("async-update", cfg_false, CFGF_NONE),
-    CFG_INT("cache-timeout", 30, CFGF_NONE),
-    CFG_INT("mr-interval", 0, CFGF_NONE),
+    CFG_INT_CB("cache-timeout", 30000, CFGF_NONE, &cb_verify_duration),
+    CFG_INT("update-jitter", 0, CFGF_NONE),
+    CFG_INT("update-priority", 0, CFGF_NONE),
+    CFG_BOOL("stale-while-revalidate", cfg_false, CFGF_NONE),
+    CFG_INT_CB("max-staleness", 0, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_CB("mr-interval", 0, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_LIST_CB("rate-windows", "{1m, 5m, 15m}", CFGF_NONE, &cb_verify_duration),
+    CFG_INT("rate-percentile", 95, CFGF_NONE),
+    CFG_INT_CB("row-index", rowIndexSequential, CFGF_NONE, &cb_verify_rowindex),
+    CFG_INT_LIST("columns", 0, CFGF_NONE),
     CFG_END()
 };
 static struct cfg_opt_t extmibobject_opts[] = {
     CFG_BOOL("mib-enabled", cfg_true, CFGF_NONE),
     CFG_BOOL("async-update", cfg_false, CFGF_NONE),
-    CFG_INT("cache-timeout", 30, CFGF_NONE),
+    CFG_INT_CB("cache-timeout", 30000, CFGF_NONE, &cb_verify_duration),
+    CFG_INT("update-jitter", 0, CFGF_NONE),
+    CFG_INT("update-priority", 0, CFGF_NONE),
+    CFG_BOOL("stale-while-revalidate", cfg_false, CFGF_NONE),
+    CFG_INT_CB("max-staleness", 0, CFGF_NONE, &cb_verify_duration),
     CFG_STR("command", 0, CFGF_NONE),
     CFG_STR_LIST("args", NULL, CFGF_NONE),
+    CFG_INT_CB("timeout", 0, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_CB("kill-grace", 5000, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_CB("output-format", outputFormatJson, CFGF_NONE, &cb_verify_outputformat),
+    CFG_INT("max-stdout", 0, CFGF_NONE),
+    CFG_INT("max-stderr", 65536, CFGF_NONE),
+    CFG_INT_CB("output-overflow", outputOverflowTruncate, CFGF_NONE, &cb_verify_outputoverflow),
+    CFG_BOOL("persistent", cfg_false, CFGF_NONE),
+    CFG_BOOL("differential", cfg_false, CFGF_NONE),
+    CFG_INT_CB("request-timeout", 10000, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_CB("restart-backoff", 1000, CFGF_NONE, &cb_verify_duration),
+    CFG_INT_CB("restart-backoff-max", 300000, CFGF_NONE, &cb_verify_duration),
 #ifdef WITH_SU_CMD
     CFG_STR("user", 0, CFGF_NONE),
 #endif
     CFG_INT("sub-oid", 0, CFGF_NONE),
+    CFG_STR("oid-prefix", 0, CFGF_NONE),
     CFG_SEC("rlimits", resource_opts, CFGF_NONE),
     CFG_END()
 };
 static struct cfg_opt_t statgrab_opts[] = {
     CFG_STR_LIST("valid-filesystems", 0, CFGF_NONE),
+    CFG_INT_CB("process-collector", processCollectorStatgrab, CFGF_NONE, &cb_verify_processcollector),
+    CFG_INT("process-threads", 1, CFGF_NONE),
+    CFG_INT("process-top-count", 0, CFGF_NONE),
+    CFG_BOOL("process-delta-update", cfg_true, CFGF_NONE),
     CFG_END()
 };
 static struct cfg_opt_t usm_entry_opts[] = {
@@ -264,6 +317,31 @@ validate_root_cfg( cfg_t *cfg )
     }
 #endif
 
+    long int updatethreads = cfg_getint( cfg, "update-threads" );
+    if( updatethreads <= 0 )
+    {
+        cfg_error( cfg, "validate root-configuration: invalid value for 'update-threads', must be greater than 0\n" );
+        rc = -1;
+    }
+
+    if( cfg_getint( cfg, "extcmd-concurrency" ) <= 0 )
+    {
+        cfg_error( cfg, "validate root-configuration: invalid value for 'extcmd-concurrency', must be greater than 0\n" );
+        rc = -1;
+    }
+
+    if( cfg_getint( cfg_getsec( cfg, "statgrab" ), "process-threads" ) <= 0 )
+    {
+        cfg_error( cfg, "validate root-configuration: invalid value for 'statgrab/process-threads', must be greater than 0\n" );
+        rc = -1;
+    }
+
+    if( cfg_getint( cfg_getsec( cfg, "statgrab" ), "process-top-count" ) < 0 )
+    {
+        cfg_error( cfg, "validate root-configuration: invalid value for 'statgrab/process-top-count', must not be negative\n" );
+        rc = -1;
+    }
+
 #ifdef WITH_SU_CMD
     // XXX check if su-cmd is executable and su-args contains 2 "%s"
     fn = cfg_getstr( cfg, "su-cmd" );
@@ -361,6 +439,25 @@ validate_mibobject( cfg_t *cfg, cfg_opt_t *opt, bool check_oid = true )
         return -1;
     }
 
+    long int jitter = cfg_getint( sec, "update-jitter" );
+    if( jitter < 0 || jitter > 100 )
+    {
+        cfg_error( cfg, "validate mibobject: update-jitter must be in (0 .. 100)" );
+        return -1;
+    }
+
+    long int max_staleness = cfg_getint( sec, "max-staleness" );
+    if( max_staleness < 0 )
+    {
+        cfg_error( cfg, "validate mibobject: max-staleness must not be negative" );
+        return -1;
+    }
+    if( max_staleness && ( max_staleness < cfg_getint( sec, "cache-timeout" ) ) )
+    {
+        cfg_error( cfg, "validate mibobject: max-staleness must not be smaller than cache-timeout" );
+        return -1;
+    }
+
     if( check_oid )
     {
         // XXX validate title
@@ -386,10 +483,112 @@ validate_mibobject( cfg_t *cfg, cfg_opt_t *opt, bool check_oid = true )
     return 0;
 }
 
+static int
+validate_regex( cfg_t *cfg, cfg_t *sec, char const *name )
+{
+    char const *pattern = cfg_getstr( sec, name );
+    if( !pattern || !*pattern )
+        return 0;
+
+    regex_t re;
+    int rc = regcomp( &re, pattern, REG_EXTENDED | REG_NOSUB );
+    if( 0 != rc )
+    {
+        char errbuf[256];
+        regerror( rc, &re, errbuf, sizeof(errbuf) );
+        cfg_error( cfg, "validate mibobject: filter %s '%s': %s", name, pattern, errbuf );
+        return -1;
+    }
+
+    regfree( &re );
+    return 0;
+}
+
+static int
+validate_columns( cfg_t *cfg, cfg_opt_t *opt )
+{
+    cfg_t *sec = cfg_opt_getnsec( opt, cfg_opt_size(opt) - 1 );
+    unsigned int n = cfg_size( sec, "columns" );
+    for( unsigned int i = 0; i < n; ++i )
+    {
+        if( cfg_getnint( sec, "columns", i ) <= 0 )
+        {
+            cfg_error( cfg, "validate mibobject: columns must be greater than 0" );
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int
+validate_row_filter( cfg_t *cfg, cfg_opt_t *opt )
+{
+    cfg_t *sec = cfg_opt_getnsec( opt, cfg_opt_size(opt) - 1 );
+    cfg_t *filter = cfg_getsec( sec, "filter" );
+    if( !filter )
+        return 0;
+
+    // the section always exists - criteria differing from the defaults tell whether it's used
+    bool process_criteria = cfg_getstr( filter, "name" ) || cfg_getstr( filter, "user" ) || cfg_size( filter, "state" ) ||
+                            cfg_getint( filter, "min-rss" ) || ( 0.0 != cfg_getfloat( filter, "min-cpu" ) );
+    bool fs_criteria = cfg_size( filter, "fs-type" ) || cfg_size( filter, "mount-prefix" );
+    if( !process_criteria && !fs_criteria )
+        return 0;
+
+    // title has been checked by validate_mibobject()
+    char const *title = cfg_title( sec );
+    Oidx oid( title );
+    if( 0 == oid.len() )
+        oid = FindOidForMibName( title );
+
+    if( process_criteria && ( oid != Oidx( SM_PROCESS_STATUS ) ) )
+    {
+        cfg_error( cfg, "validate mibobject: filter name, user, state, min-rss and min-cpu are only supported by ProcessStatus" );
+        return -1;
+    }
+    if( fs_criteria && ( oid != Oidx( SM_FILE_SYSTEM_USAGE ) ) )
+    {
+        cfg_error( cfg, "validate mibobject: filter fs-type and mount-prefix are only supported by FileSystemUsage" );
+        return -1;
+    }
+
+    if( ( 0 != validate_regex( cfg, filter, "name" ) ) || ( 0 != validate_regex( cfg, filter, "user" ) ) )
+        return -1;
+
+    static char const * const states[] = { "running", "sleeping", "stopped", "zombie", "unknown" };
+    unsigned int n = cfg_size( filter, "state" );
+    for( unsigned int i = 0; i < n; ++i )
+    {
+        char const *state = cfg_getnstr( filter, "state", i );
+        size_t j = 0;
+        while( ( j < lengthof(states) ) && ( 0 != strcasecmp( state, states[j] ) ) )
+            ++j;
+        if( j == lengthof(states) )
+        {
+            cfg_error( cfg, "validate mibobject: invalid filter state '%s'", state );
+            return -1;
+        }
+    }
+
+    if( ( cfg_getint( filter, "min-rss" ) < 0 ) || ( cfg_getfloat( filter, "min-cpu" ) < 0.0 ) )
+    {
+        cfg_error( cfg, "validate mibobject: filter min-rss and min-cpu must not be negative" );
+        return -1;
+    }
+
+    return 0;
+}
+
 int
 cb_validate_mibobject( cfg_t *cfg, cfg_opt_t *opt )
 {
-    return validate_mibobject( cfg, opt, true );
+    if( 0 != validate_mibobject( cfg, opt, true ) )
+        return -1;
+    if( 0 != validate_columns( cfg, opt ) )
+        return -1;
+
+    return validate_row_filter( cfg, opt );
 }
 
 int
@@ -399,6 +598,8 @@ cb_validate_inrmibobject( cfg_t *cfg, cfg_opt_t *opt )
     cfg_t *sec = cfg_opt_getnsec( opt, cfg_opt_size(opt) - 1 );
     if( 0 != validate_mibobject( cfg, opt, true ) )
         return -1;
+    if( 0 != validate_columns( cfg, opt ) )
+        return -1;
 
     if( 0 != ( cache_timeout = cfg_getint( sec, "cache-timeout" ) ) )
     {
@@ -421,6 +622,24 @@ cb_validate_inrmibobject( cfg_t *cfg, cfg_opt_t *opt )
         }
     }
     /* else assume one comparing item to diff against */
+
+    long int percentile = cfg_getint( sec, "rate-percentile" );
+    if( percentile < 1 || percentile > 100 )
+    {
+        cfg_error( cfg, "validate inrobject: rate-percentile must be in (1 .. 100)" );
+        return -1;
+    }
+
+    unsigned int n = cfg_size( sec, "rate-windows" );
+    for( unsigned int i = 0; i < n; ++i )
+    {
+        if( cfg_getnint( sec, "rate-windows", i ) < cache_timeout )
+        {
+            cfg_error( cfg, "validate inrobject: rate-windows must not be smaller than cache-timeout" );
+            return -1;
+        }
+    }
+
     if( !cfg_getbool( sec, "async-update" ) )
         cfg_error( cfg, "validate inrobject: it's strongly recommended to update interval data asynchronous" );
 
@@ -447,6 +666,32 @@ cb_validate_extmibobject( cfg_t *cfg, cfg_opt_t *opt )
         return -1;
     }
 
+    if( ( cfg_getint( sec, "max-stdout" ) < 0 ) || ( cfg_getint( sec, "max-stderr" ) < 0 ) )
+    {
+        cfg_error( cfg, "validate extobject: max-stdout and max-stderr must not be negative" );
+        return -1;
+    }
+
+    if( cfg_getbool( sec, "persistent" ) )
+    {
+        if( 0 == cfg_getint( sec, "request-timeout" ) )
+        {
+            cfg_error( cfg, "validate extobject: request-timeout must be greater than 0" );
+            return -1;
+        }
+
+        if( cfg_getint( sec, "restart-backoff-max" ) < cfg_getint( sec, "restart-backoff" ) )
+        {
+            cfg_error( cfg, "validate extobject: restart-backoff-max must not be smaller than restart-backoff" );
+            return -1;
+        }
+    }
+    else if( cfg_getbool( sec, "differential" ) )
+    {
+        cfg_error( cfg, "validate extobject: differential requires persistent" );
+        return -1;
+    }
+
 #ifdef WITH_SU_CMD
     if( !cfg_getstr( sec, "user" ) ) // XXX getpwnam to verify user - but only if set!
     {
@@ -461,6 +706,27 @@ cb_validate_extmibobject( cfg_t *cfg, cfg_opt_t *opt )
         return -1;
     }
 
+    if( ( f = cfg_getstr( sec, "oid-prefix" ) ) )
+    {
+        // sub-identifiers separated by dots, optionally with leading dot
+        bool valid = ( '.' == *f ) ? ( '\0' != *++f ) : ( '\0' != *f );
+        for( bool digit = false; valid && *f; ++f )
+        {
+            if( isdigit( (unsigned char)*f ) )
+                digit = true;
+            else if( ( '.' == *f ) && digit && f[1] )
+                digit = false;
+            else
+                valid = false;
+        }
+
+        if( !valid )
+        {
+            cfg_error( cfg, "validate extobject: invalid oid-prefix entry" );
+            return -1;
+        }
+    }
+
     return 0;
 }
 
@@ -1004,6 +1270,109 @@ cb_verify_onfatal( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result )
     return 0;
 }
 
+int
+cb_verify_rowindex( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result )
+{
+    if(strcasecmp(value, "sequential") == 0)
+        *(long int *)result = rowIndexSequential;
+    else if(strcasecmp(value, "stable") == 0)
+        *(long int *)result = rowIndexStable;
+    else
+    {
+        cfg_error(cfg, "Invalid value for option %s: %s", opt->name, value);
+        return -1;
+    }
+    return 0;
+}
+
+int
+cb_verify_outputformat( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result )
+{
+    if(strcasecmp(value, "json") == 0)
+        *(long int *)result = outputFormatJson;
+    else if(strcasecmp(value, "binary") == 0)
+        *(long int *)result = outputFormatBinary;
+    else
+    {
+        cfg_error(cfg, "Invalid value for option %s: %s", opt->name, value);
+        return -1;
+    }
+    return 0;
+}
+
+int
+cb_verify_processcollector( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result )
+{
+    if(strcasecmp(value, "statgrab") == 0)
+        *(long int *)result = processCollectorStatgrab;
+    else if(strcasecmp(value, "procfs") == 0)
+        *(long int *)result = processCollectorProcfs;
+    else
+    {
+        cfg_error(cfg, "Invalid value for option %s: %s", opt->name, value);
+        return -1;
+    }
+    return 0;
+}
+
+int
+cb_verify_outputoverflow( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result )
+{
+    if(strcasecmp(value, "truncate") == 0)
+        *(long int *)result = outputOverflowTruncate;
+    else if(strcasecmp(value, "abort") == 0)
+        *(long int *)result = outputOverflowAbort;
+    else
+    {
+        cfg_error(cfg, "Invalid value for option %s: %s", opt->name, value);
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * durations are given as number with an optional unit (ms, s, m, h) and
+ * stored in milliseconds - a number without unit means seconds
+ */
+int
+cb_verify_duration( cfg_t *cfg, cfg_opt_t *opt, const char *value, void *result )
+{
+    char *unit = 0;
+    double duration = strtod( value, &unit );
+
+    if( ( unit == value ) || ( duration < 0 ) )
+    {
+        cfg_error(cfg, "Invalid value for option %s: %s", opt->name, value);
+        return -1;
+    }
+
+    while( isspace( *unit ) )
+        ++unit;
+
+    if( ( *unit == '\0' ) || ( strcasecmp(unit, "s") == 0 ) )
+        duration *= 1000;
+    else if( strcasecmp(unit, "ms") == 0 )
+        ;
+    else if( strcasecmp(unit, "m") == 0 )
+        duration *= 60 * 1000;
+    else if( strcasecmp(unit, "h") == 0 )
+        duration *= 60 * 60 * 1000;
+    else
+    {
+        cfg_error(cfg, "Invalid unit for option %s: %s (use ms, s, m or h)", opt->name, value);
+        return -1;
+    }
+
+    if( duration > LONG_MAX )
+    {
+        cfg_error(cfg, "Value for option %s out of range: %s", opt->name, value);
+        return -1;
+    }
+
+    *(long int *)result = (long int)( duration + 0.5 );
+    return 0;
+}
+
 Config *Config::mInstance = 0;
 
 Config::~Config()
@@ -1018,6 +1387,45 @@ Config::createInstance()
     mInstance = &instance;
 }
 
+static void
+ReadColumns( cfg_t *sec, vector<unsigned long> &columns )
+{
+    columns.clear();
+    for( unsigned int i = 0; i < cfg_size( sec, "columns" ); ++i )
+        columns.push_back( (unsigned long)( cfg_getnint( sec, "columns", i ) ) );
+
+    sort( columns.begin(), columns.end() );
+    columns.erase( unique( columns.begin(), columns.end() ), columns.end() );
+}
+
+static void
+ReadRowFilter( cfg_t *sec, RowFilterConfig &rowFilter )
+{
+    rowFilter = RowFilterConfig();
+
+    cfg_t *filter = cfg_getsec( sec, "filter" );
+    if( !filter )
+        return;
+
+    char const *str;
+    if( NULL != ( str = cfg_getstr( filter, "name" ) ) )
+        rowFilter.Name = str;
+    if( NULL != ( str = cfg_getstr( filter, "user" ) ) )
+        rowFilter.User = str;
+    for( unsigned int i = 0; i < cfg_size( filter, "state" ); ++i )
+    {
+        string state = cfg_getnstr( filter, "state", i );
+        transform( state.begin(), state.end(), state.begin(), ::tolower );
+        rowFilter.States.push_back( state );
+    }
+    rowFilter.MinResident = (unsigned long long)( cfg_getint( filter, "min-rss" ) );
+    rowFilter.MinCpuPercent = cfg_getfloat( filter, "min-cpu" );
+    for( unsigned int i = 0; i < cfg_size( filter, "fs-type" ); ++i )
+        rowFilter.FsTypes.push_back( cfg_getnstr( filter, "fs-type", i ) );
+    for( unsigned int i = 0; i < cfg_size( filter, "mount-prefix" ); ++i )
+        rowFilter.MountPrefixes.push_back( cfg_getnstr( filter, "mount-prefix", i ) );
+}
+
 static void
 ReadResourceLimits( cfg_t *sec, ResourceLimits &resourceLimits )
 {
@@ -1099,6 +1507,10 @@ Config::Read()
 #ifdef AGENTPP_USE_THREAD_POOL
         CFG_INT("job-threads", 16, CFGF_NONE),
 #endif
+        CFG_INT("update-threads", 4, CFGF_NONE),
+        CFG_INT("extcmd-concurrency", 8, CFGF_NONE),
+        CFG_INT_CB("user-cache-timeout", 300000, CFGF_NONE, &cb_verify_duration),
+        CFG_INT_CB("user-cache-negative-timeout", 60000, CFGF_NONE, &cb_verify_duration),
         CFG_SEC("rlimits", resource_opts, CFGF_NONE),
         CFG_INT_CB("on-fatal", onfKill, CFGF_NONE, &cb_verify_onfatal),
         CFG_SEC("mibobject", mibobject_opts, CFGF_MULTI | CFGF_TITLE),
@@ -1212,6 +1624,10 @@ Config::Read()
 #ifdef AGENTPP_USE_THREAD_POOL
     mNumberOfJobThreads = cfg_getint( cfg, "job-threads" );
 #endif
+    mNumberOfUpdateThreads = cfg_getint( cfg, "update-threads" );
+    mExternalCommandConcurrency = cfg_getint( cfg, "extcmd-concurrency" );
+    mUserCacheTimeout = cfg_getint( cfg, "user-cache-timeout" );
+    mUserCacheNegativeTimeout = cfg_getint( cfg, "user-cache-negative-timeout" );
 
     {
         cfg_t *sec = cfg_getsec( cfg, "rlimits" );
@@ -1240,7 +1656,14 @@ Config::Read()
         mibObjCfg.MibEnabled = cfg_getbool( cfge, "mib-enabled" );
         if( !mibObjCfg.MibEnabled )
             mibObjCfg.AsyncUpdate = false;
-        mibObjCfg.CacheTime = cfg_getint( cfge, "cache-timeout" );
+        mibObjCfg.CacheTime = (unsigned long)( cfg_getint( cfge, "cache-timeout" ) );
+        mibObjCfg.UpdateJitter = cfg_getint( cfge, "update-jitter" );
+        mibObjCfg.UpdatePriority = cfg_getint( cfge, "update-priority" );
+        mibObjCfg.StaleWhileRevalidate = cfg_getbool( cfge, "stale-while-revalidate" );
+        mibObjCfg.MaxStaleness = (unsigned long)( cfg_getint( cfge, "max-staleness" ) );
+        mibObjCfg.RowIndex = (RowIndexing)(cfg_getint( cfge, "row-index" ));
+        ReadColumns( cfge, mibObjCfg.Columns );
+        ReadRowFilter( cfge, mibObjCfg.RowFilter );
         map<string, MibObjectConfig>::iterator iter = mMibObjectConfigs.find(mibOid);
         if( iter != mMibObjectConfigs.end() )
             iter->second = mibObjCfg;
@@ -1265,8 +1688,17 @@ Config::Read()
         mibObjCfg.MibEnabled = cfg_getbool( cfge, "mib-enabled" );
         if( !mibObjCfg.MibEnabled )
             mibObjCfg.AsyncUpdate = false;
-        mibObjCfg.CacheTime = cfg_getint( cfge, "cache-timeout" );
-        mibObjCfg.MostRecentIntervalTime = cfg_getint( cfge, "mr-interval" );
+        mibObjCfg.CacheTime = (unsigned long)( cfg_getint( cfge, "cache-timeout" ) );
+        mibObjCfg.UpdateJitter = cfg_getint( cfge, "update-jitter" );
+        mibObjCfg.UpdatePriority = cfg_getint( cfge, "update-priority" );
+        mibObjCfg.StaleWhileRevalidate = cfg_getbool( cfge, "stale-while-revalidate" );
+        mibObjCfg.MaxStaleness = (unsigned long)( cfg_getint( cfge, "max-staleness" ) );
+        mibObjCfg.MostRecentIntervalTime = (unsigned long)( cfg_getint( cfge, "mr-interval" ) );
+        for( unsigned int w = 0; w < cfg_size( cfge, "rate-windows" ); ++w )
+            mibObjCfg.RateWindows.push_back( (unsigned long)( cfg_getnint( cfge, "rate-windows", w ) ) );
+        mibObjCfg.RatePercentile = cfg_getint( cfge, "rate-percentile" );
+        mibObjCfg.RowIndex = (RowIndexing)(cfg_getint( cfge, "row-index" ));
+        ReadColumns( cfge, mibObjCfg.Columns );
         map<string, MibObjectConfig>::iterator iter = mMibObjectConfigs.find(mibOid);
         if( iter != mMibObjectConfigs.end() )
             iter->second = mibObjCfg;
@@ -1304,7 +1736,11 @@ Config::Read()
         extMibObjCfg.MibEnabled = cfg_getbool( cfge, "mib-enabled" );
         if( !extMibObjCfg.MibEnabled )
             extMibObjCfg.AsyncUpdate = false;
-        extMibObjCfg.CacheTime = cfg_getint( cfge, "cache-timeout" );
+        extMibObjCfg.CacheTime = (unsigned long)( cfg_getint( cfge, "cache-timeout" ) );
+        extMibObjCfg.UpdateJitter = cfg_getint( cfge, "update-jitter" );
+        extMibObjCfg.UpdatePriority = cfg_getint( cfge, "update-priority" );
+        extMibObjCfg.StaleWhileRevalidate = cfg_getbool( cfge, "stale-while-revalidate" );
+        extMibObjCfg.MaxStaleness = (unsigned long)( cfg_getint( cfge, "max-staleness" ) );
 
         extMibObjCfg.ExternalCommand.Executable = cfg_getstr( cfge, "command" );
 
@@ -1316,6 +1752,19 @@ Config::Read()
             extMibObjCfg.ExternalCommand.Arguments.push_back( arg );
         }
 
+        extMibObjCfg.ExternalCommand.Timeout = (unsigned long)( cfg_getint( cfge, "timeout" ) );
+        extMibObjCfg.ExternalCommand.KillGrace = (unsigned long)( cfg_getint( cfge, "kill-grace" ) );
+        extMibObjCfg.ExternalCommand.OutputFormat = (ExternalOutputFormat)(cfg_getint( cfge, "output-format" ));
+        extMibObjCfg.ExternalCommand.MaxStdout = (unsigned long)( cfg_getint( cfge, "max-stdout" ) );
+        extMibObjCfg.ExternalCommand.MaxStderr = (unsigned long)( cfg_getint( cfge, "max-stderr" ) );
+        extMibObjCfg.ExternalCommand.OutputOverflow = (ExternalOutputOverflow)(cfg_getint( cfge, "output-overflow" ));
+        extMibObjCfg.ExternalCommand.Persistent = cfg_getbool( cfge, "persistent" );
+        extMibObjCfg.ExternalCommand.Differential = cfg_getbool( cfge, "differential" );
+        extMibObjCfg.ExternalCommand.RequestTimeout = (unsigned long)( cfg_getint( cfge, "request-timeout" ) );
+        extMibObjCfg.ExternalCommand.RestartBackoff = (unsigned long)( cfg_getint( cfge, "restart-backoff" ) );
+        extMibObjCfg.ExternalCommand.RestartBackoffMax = (unsigned long)( cfg_getint( cfge, "restart-backoff-max" ) );
+        extMibObjCfg.ExternalCommand.OidPrefix = cfg_getstr( cfge, "oid-prefix" ) ? cfg_getstr( cfge, "oid-prefix" ) : "";
+
 #ifdef WITH_SU_CMD
         extMibObjCfg.ExternalCommand.User = cfg_getstr( cfge, "user" );
 #endif
@@ -1355,6 +1804,11 @@ Config::Read()
     {
         cfg_t *sec = cfg_getsec( cfg, "statgrab" );
 
+        mStatgrabSettings.ProcessCollector = (ProcessCollector)(cfg_getint( sec, "process-collector" ));
+        mStatgrabSettings.ProcessThreads = cfg_getint( sec, "process-threads" );
+        mStatgrabSettings.ProcessTopCount = cfg_getint( sec, "process-top-count" );
+        mStatgrabSettings.ProcessDeltaUpdate = cfg_getbool( sec, "process-delta-update" );
+
         n = cfg_size( sec, "valid-filesystems" );
         if( 0 != n )
         {
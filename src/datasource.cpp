@@ -19,7 +19,7 @@
 #include <smart-snmpd/oids.h>
 #include <smart-snmpd/datasource.h>
 #include <smart-snmpd/mibobject.h>
-#include <smart-snmpd/updatethread.h>
+#include <smart-snmpd/updatescheduler.h>
 
 #include <agent_pp/snmp_textual_conventions.h>
 #include <snmp_pp/log.h>
@@ -33,11 +33,23 @@ DataSource::~DataSource()
 {
     ThreadSynchronize guard(*this);
 
-    delete mUpdateThread;
-    mUpdateThread = 0;
+    UpdateScheduler::getInstance().unschedule( *this );
     mMibObj = 0;
 }
 
+UpdateJobConfig
+DataSource::getUpdateJobConfig() const
+{
+    UpdateJobConfig jobConfig;
+    MibObjectConfig const &mibObjCfg = mMibObj->getConfig();
+
+    jobConfig.Interval = mibObjCfg.CacheTime;
+    jobConfig.Jitter = mibObjCfg.UpdateJitter;
+    jobConfig.Priority = mibObjCfg.UpdatePriority;
+
+    return jobConfig;
+}
+
 bool
 DataSource::startMibObjUpdater()
 {
@@ -46,28 +58,10 @@ DataSource::startMibObjUpdater()
 
     ThreadSynchronize guard(*this);
 
-    if( mUpdateThread && mUpdateThread->is_alive() )
-    {
-        return true;
-    }
-
-    if( !mUpdateThread )
-        mUpdateThread = new UpdateThread( *this, *mMibObj );
-    if( !mUpdateThread )
-    {
-        LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
-        LOG("DataSource::initMibObj: failed to create update thread for (oid)");
-        LOG(mMibObj->key()->get_printable());
-        LOG_END;
-
-        return false;
-    }
-
-    mUpdateThread->start();
-    if( !mUpdateThread->is_alive() )
+    if( !UpdateScheduler::getInstance().schedule( *this, getUpdateJobConfig() ) )
     {
         LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
-        LOG("DataSource::initMibObj: failed to start update thread for (oid)");
+        LOG("DataSource::startMibObjUpdater: failed to schedule updates for (oid)");
         LOG(mMibObj->key()->get_printable());
         LOG_END;
 
@@ -82,13 +76,7 @@ DataSource::stopMibObjUpdater()
 {
     ThreadSynchronize guard(*this);
 
-    if( mUpdateThread && mUpdateThread->is_alive() )
-    {
-        mUpdateThread->stop();
-
-        delete mUpdateThread;
-        mUpdateThread = 0;
-    }
+    UpdateScheduler::getInstance().unschedule( *this );
 }
 
 bool
@@ -108,19 +96,23 @@ DataSource::checkMibObjConfig( Mib &mainMibCtrl )
         mibRegistered = NULL != mainMibCtrl.get( *( mMibObj->key() ) );
     }
 
-    if( (mUpdateThread && mUpdateThread->is_alive() ) && !asynchUpdate )
+    bool scheduled = UpdateScheduler::getInstance().isScheduled( *this );
+
+    if( scheduled && !asynchUpdate )
     {
         LOG_BEGIN(loggerModuleName, EVENT_LOG | 3);
-        LOG("DataSource::checkMibObjConfig: asynchronous update disabled for (oid) - stopping thread");
+        LOG("DataSource::checkMibObjConfig: asynchronous update disabled for (oid) - unscheduling");
         LOG(mMibObj ? mMibObj->key()->get_printable() : "<deleted>");
         LOG_END;
 
         stopMibObjUpdater();
     }
-    else if( asynchUpdate && !(mUpdateThread && mUpdateThread->is_alive() ) )
+    else if( asynchUpdate )
     {
         LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
-        LOG("DataSource::checkMibObjConfig: asynchronous update enabled for (oid) - starting thread");
+        LOG( scheduled
+             ? "DataSource::checkMibObjConfig: asynchronous update enabled for (oid) - rescheduling"
+             : "DataSource::checkMibObjConfig: asynchronous update enabled for (oid) - scheduling" );
         LOG(mMibObj->key()->get_printable());
         LOG_END;
 
@@ -164,7 +156,7 @@ DataSource::initMibObj()
     if( mMibObj->getConfig().AsyncUpdate )
     {
         LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
-        LOG("DataSource::initMibObj: going to create update thread for (oid)");
+        LOG("DataSource::initMibObj: going to schedule updates for (oid)");
         LOG(mMibObj->key()->get_printable());
         LOG_END;
 
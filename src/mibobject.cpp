@@ -19,6 +19,7 @@
 #include <smart-snmpd/oids.h>
 #include <smart-snmpd/datasource.h>
 #include <smart-snmpd/mibobject.h>
+#include <smart-snmpd/updatescheduler.h>
 
 #include <map>
 
@@ -75,8 +76,13 @@ MibObject::MibObject(const Oidx &anOid, DataSource &aDataSource)
     : MibComplexEntry( anOid, READONLY )
     , mConfig( Config::getInstance().getMibObjectConfig(anOid.get_printable() ) )
     , mDataSource( aDataSource )
-    , mContentMgr( anOid )
-    , mShadowContentMgr( anOid )
+    , mUpdateGuard()
+    , mRefreshSync()
+    , mRefreshing( false )
+    , mSnapshotGuard()
+    , mContent( new ContentSnapshot( anOid ) )
+    , mShadowContent( 0 )
+    , mSpareContent( 0 )
 {
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
     LOG("MibObject::MibObject fresh initialized (Oid)");
@@ -88,40 +94,218 @@ MibObject::MibObject(MibObject const &aRef)
     : MibComplexEntry(aRef)
     , mConfig( aRef.mConfig )
     , mDataSource( aRef.mDataSource )
-    , mContentMgr( aRef.mContentMgr )
-    , mShadowContentMgr( oid )
+    , mUpdateGuard()
+    , mRefreshSync()
+    , mRefreshing( false )
+    , mSnapshotGuard()
+    , mContent( 0 )
+    , mShadowContent( 0 )
+    , mSpareContent( 0 )
 {
+    ContentReference content( aRef );
+    mContent = new ContentSnapshot( *content );
+    mContent->Committed = content.getCommitted();
+
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
     LOG("MibObject::MibObject copy constructor (Oid)");
     LOG(aRef.key()->get_printable());
     LOG_END;
 }
 
+MibObject::~MibObject()
+{
+    delete mContent;
+    delete mShadowContent;
+    delete mSpareContent;
+}
+
+MibObject::ContentManagerType &
+MibObject::beginContentUpdate()
+{
+    mUpdateGuard.start_synch();
+
+    {
+        ThreadSynchronize guard( mSnapshotGuard );
+        mShadowContent = mSpareContent;
+        mSpareContent = 0;
+    }
+
+    if( mShadowContent )
+    {
+        mShadowContent->Content.clear();
+        mShadowContent->RefCount = 1;
+        mShadowContent->Committed = 0;
+    }
+    else
+    {
+        mShadowContent = new ContentSnapshot( oid );
+    }
+
+    return mShadowContent->Content;
+}
+
+MibObject &
+MibObject::commitContentUpdate()
+{
+    ContentSnapshot *retired;
+
+    mShadowContent->Content.sort(); // published snapshots must not be modified by readers
+    mShadowContent->Committed = UpdateScheduler::now();
+
+    {
+        ThreadSynchronize guard( mSnapshotGuard );
+        retired = mContent;
+        mContent = mShadowContent;
+    }
+
+    mShadowContent = 0;
+    releaseContent( retired );
+
+    mUpdateGuard.end_synch(); // end sync from beginContentUpdate()
+
+    return *this;
+}
+
+MibObject &
+MibObject::abortContentUpdate()
+{
+    releaseContent( mShadowContent );
+    mShadowContent = 0;
+
+    mUpdateGuard.end_synch(); // end sync from beginContentUpdate()
+
+    return *this;
+}
+
+void
+MibObject::releaseContent( ContentSnapshot *aSnapshot ) const
+{
+    {
+        ThreadSynchronize guard( mSnapshotGuard );
+        if( --aSnapshot->RefCount )
+            return;
+
+        if( !mSpareContent )
+        {
+            mSpareContent = aSnapshot; // cleared when taken by beginContentUpdate()
+            return;
+        }
+    }
+
+    delete aSnapshot;
+}
+
 void
 MibObject::updateConfig()
 {
-    ThreadSynchronize guard(*this);
+    ThreadSynchronize guard(mUpdateGuard); // don't change the configuration while an update runs
     mConfig = Config::getInstance().getMibObjectConfig( oid.get_printable() );
 }
 
+bool
+MibObject::runRefresh()
+{
+    bool rc;
+
+    try
+    {
+        rc = mDataSource.updateMibObj();
+    }
+    catch( ... )
+    {
+        // waiting requests would block forever otherwise
+        endRefresh();
+        throw;
+    }
+
+    endRefresh();
+
+    return rc;
+}
+
+void
+MibObject::endRefresh()
+{
+    mRefreshSync.lock();
+    mRefreshing = false;
+    mRefreshSync.notify_all();
+    mRefreshSync.unlock();
+}
+
+bool
+MibObject::refresh()
+{
+    mRefreshSync.lock();
+
+    if( mRefreshing )
+    {
+        // a request is collecting the data right now
+        mRefreshSync.unlock();
+        return false;
+    }
+
+    mRefreshing = true;
+    mRefreshSync.unlock();
+
+    return runRefresh();
+}
+
 void
 MibObject::update(Request *)
 {
     if( !mConfig.AsyncUpdate )
     {
-        time_t now = time(NULL);
+        UpdateTime now = UpdateScheduler::now();
+        UpdateTime lastCommit = GetLastCommit();
 
         LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
-        LOG("MibObject::update (Oid)(CacheTime)(LastUpdate)(now)");
+        LOG("MibObject::update (Oid)(CacheTime)(LastCommit)(now)");
         LOG(key()->get_printable());
         LOG(mConfig.CacheTime);
-        LOG(mContentMgr.mLastUpdate);
-        LOG(now);
+        LOG((unsigned long)(lastCommit));
+        LOG((unsigned long)(now));
         LOG_END;
 
-        if( ( ( mContentMgr.mLastUpdate + mConfig.CacheTime ) < now ) )
+        if( !lastCommit || ( ( lastCommit + mConfig.CacheTime ) <= now ) )
         {
-            if( !mDataSource.updateMibObj() )
+            bool serveStale = mConfig.StaleWhileRevalidate && lastCommit &&
+                              ( !mConfig.MaxStaleness || ( ( now - lastCommit ) <= mConfig.MaxStaleness ) );
+
+            mRefreshSync.lock();
+
+            if( mRefreshing )
+            {
+                // somebody else is already refreshing - don't collect twice
+                if( !serveStale )
+                {
+                    while( mRefreshing )
+                        mRefreshSync.wait();
+                }
+
+                mRefreshSync.unlock();
+                return;
+            }
+
+            lastCommit = GetLastCommit();
+            if( lastCommit && ( ( lastCommit + mConfig.CacheTime ) > UpdateScheduler::now() ) )
+            {
+                // refreshed while waiting for the lock
+                mRefreshSync.unlock();
+                return;
+            }
+
+            // answer from current content and let an update worker refresh it,
+            // the worker takes the claim itself in refresh()
+            if( serveStale && UpdateScheduler::getInstance().trigger( mDataSource ) )
+            {
+                mRefreshSync.unlock();
+                return;
+            }
+
+            mRefreshing = true;
+            mRefreshSync.unlock();
+
+            if( !runRefresh() )
             {
                 // report error
             }
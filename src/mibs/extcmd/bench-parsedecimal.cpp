@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/mibs/extcmd/parsedecimal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+/*
+ * micro benchmark of the number parsing of ParseExternalJson
+ *
+ * Compares parse_decimal() with the former way of copying each json
+ * token into a terminated buffer for sscanf(). Not built by default,
+ * run "make bench-parsedecimal" in this directory.
+ *
+ * usage: bench-parsedecimal [rounds]
+ */
+
+using namespace SmartSnmpd;
+
+struct Token
+{
+    size_t Offset;
+    size_t Length;
+};
+
+static double
+now_ns()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * parses a token like the json parser did before parse_decimal()
+ */
+static bool
+parse_sscanf(const char *data, size_t length, unsigned long long &value)
+{
+    char *buf = (char *)alloca( length + 1 );
+    memcpy( buf, data, length );
+    buf[length] = 0;
+    return 1 == sscanf( buf, "%llu", &value );
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned long rounds = argc > 1 ? strtoul( argv[1], NULL, 10 ) : 200;
+
+    // the values of the json documents of external commands: small
+    // enumerations and gauges, 32 bit counters and 64 bit byte counters
+    std::string doc;
+    std::vector<Token> tokens;
+    srand( 42 );
+    for( unsigned i = 0; i < 10000; ++i )
+    {
+        char num[32];
+        unsigned long long v;
+        switch( i % 4 )
+        {
+        case 0: v = rand() % 10; break;
+        case 1: v = rand() % 100000; break;
+        case 2: v = (unsigned long long)rand() * 2; break;
+        default: v = ( (unsigned long long)rand() << 31 ) ^ rand(); break;
+        }
+
+        Token t;
+        t.Offset = doc.size();
+        t.Length = snprintf( num, sizeof(num), "%llu", v );
+        doc.append( num, t.Length );
+        doc.append( "," );
+        tokens.push_back( t );
+    }
+
+    const char *base = doc.data();
+    unsigned long long sum_sscanf = 0, sum_decimal = 0;
+
+    double start = now_ns();
+    for( unsigned long r = 0; r < rounds; ++r )
+    {
+        for( size_t i = 0; i < tokens.size(); ++i )
+        {
+            unsigned long long v = 0;
+            if( parse_sscanf( base + tokens[i].Offset, tokens[i].Length, v ) )
+                sum_sscanf += v;
+        }
+    }
+    double sscanf_ns = now_ns() - start;
+
+    start = now_ns();
+    for( unsigned long r = 0; r < rounds; ++r )
+    {
+        for( size_t i = 0; i < tokens.size(); ++i )
+        {
+            uint64_t v = 0;
+            if( parse_decimal( base + tokens[i].Offset, base + tokens[i].Offset + tokens[i].Length, v ) )
+                sum_decimal += v;
+        }
+    }
+    double decimal_ns = now_ns() - start;
+
+    double n = (double)rounds * tokens.size();
+    printf( "tokens:        %.0f\n", n );
+    printf( "sscanf:        %.1f ns/token\n", sscanf_ns / n );
+    printf( "parse_decimal: %.1f ns/token\n", decimal_ns / n );
+    printf( "speedup:       %.1fx\n", sscanf_ns / decimal_ns );
+
+    if( sum_sscanf != sum_decimal )
+    {
+        fprintf( stderr, "results differ: %llu != %llu\n", sum_sscanf, sum_decimal );
+        return 1;
+    }
+
+    return 0;
+}
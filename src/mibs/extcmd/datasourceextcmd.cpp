@@ -17,19 +17,399 @@
 #include <build-smart-snmpd.h>
 
 #include <smart-snmpd/mibs/extcmd/extcmd.h>
+#include <smart-snmpd/mibs/extcmd/extcmdexecutor.h>
 #include <smart-snmpd/mibs/extcmd/parseextjson.h>
+#include <smart-snmpd/mibs/extcmd/parseextbinary.h>
 #include <smart-snmpd/mibs/extcmd/datasourceextcmd.h>
 #include <smart-snmpd/mibs/extcmd/mibextcmd.h>
 
 #include <agent_pp/snmp_textual_conventions.h>
 
+#include <algorithm>
 #include <cctype>
+#include <map>
+#include <sstream>
 
 namespace SmartSnmpd
 {
 
 static const char * const loggerModuleName = "smartsnmpd.datasource.extcmd";
 
+/**
+ * creates the parser for the configured output format of a command
+ *
+ * @param format - output format of the command
+ *
+ * @return ParseExternalOutput * - new parser, owned by the caller
+ */
+static ParseExternalOutput *
+create_parser( ExternalOutputFormat format )
+{
+    if( outputFormatBinary == format )
+        return new ParseExternalBinary();
+    else
+        return new ParseExternalJson();
+}
+
+/**
+ * run of an external command, shared by all data sources running the same
+ * command (see ExternalCommandCache)
+ *
+ * The output of the command is parsed while it arrives, the parsed data
+ * is available via getParser() when the job is done.
+ */
+class ExternalCommandUpdateJob
+    : public ExternalCommandJob
+    , public ExternalCommandOutputSink
+{
+    friend class ExternalCommandCache;
+
+public:
+    /**
+     * constructor
+     *
+     * @param key - key of the command in the ExternalCommandCache
+     * @param cmdcfg - specification how to run external command
+     * @param expectedEntries - estimated number of json entries
+     */
+    ExternalCommandUpdateJob( string const &key, ExternalCommandConfig const &cmdcfg, size_t expectedEntries )
+        : ExternalCommandJob( *createCommand( cmdcfg ), cmdcfg.Timeout, cmdcfg.KillGrace )
+        , ExternalCommandOutputSink()
+        , mKey( key )
+        , mSubscribers()
+        , mRefs( 0 )
+        , mMaxAge( 0 )
+        , mCompleted( 0 )
+        , mCached( true )
+        , mStarted( time(NULL) )
+        , mFinished( 0 )
+        , mParser( create_parser( cmdcfg.OutputFormat ) )
+        , mPending()
+        , mParseError( 0 )
+    {
+        mParser->reserve( expectedEntries );
+        mParser->begin();
+        mCommand.setOutSink( this );
+    }
+
+    virtual ~ExternalCommandUpdateJob() { delete &mCommand; delete mParser; }
+
+    virtual void consume( const char *data, size_t length )
+    {
+        // called with the executor lock held - parsed by outputReceived()
+        mPending.append( data, length );
+    }
+
+    virtual void outputReceived()
+    {
+        if( mPending.empty() )
+            return;
+
+        // a failed parser ignores the remaining output
+        (void)mParser->feed( mPending.data(), mPending.size() );
+        mPending.clear(); // keeps the capacity
+    }
+
+    virtual void finished();
+
+    inline time_t getStarted() const { return mStarted; }
+    inline time_t getFinished() const { return mFinished ? mFinished : time(NULL); }
+    inline ParseExternalOutput const & getParser() const { return *mParser; }
+    /**
+     * returns the result of ParseExternalOutput::end() for the output of
+     * the finished command
+     *
+     * @return int - 0 when the complete output has been parsed, errno code otherwise
+     */
+    inline int getParseError() const { return mParseError; }
+
+protected:
+    static ExternalCommand * createCommand( ExternalCommandConfig const &cmdcfg )
+    {
+        if( !cmdcfg.User.empty() )
+            return new ExternalCommandAsUser( cmdcfg );
+        else
+            return new ExternalCommand( cmdcfg );
+    }
+
+    // the following members are guarded by the ExternalCommandCache
+    string const mKey;
+    vector<DataSource *> mSubscribers;
+    unsigned mRefs;
+    unsigned long mMaxAge;
+    UpdateTime mCompleted;
+    bool mCached;
+
+    time_t mStarted;
+    time_t mFinished;
+    ParseExternalOutput *mParser;
+    //! output read since the last call of outputReceived()
+    string mPending;
+    int mParseError;
+};
+
+/**
+ * shared execution cache for external commands
+ *
+ * Data sources running the same command (same executable, arguments,
+ * user, resource and output limits) share one run: a command which is
+ * running or finished within the cache time of the requesting data source
+ * isn't started again. The parsed output of a run is kept as long as a
+ * data source uses it or the cache time of one of its users hasn't expired.
+ */
+class ExternalCommandCache
+    : public NS_AGENT Synchronized
+{
+public:
+    /**
+     * singleton accessor
+     *
+     * @return ExternalCommandCache & - the cache instance
+     */
+    static ExternalCommandCache & getInstance()
+    {
+        if( 0 == mInstance )
+            mInstance = new ExternalCommandCache();
+        return *mInstance;
+    }
+
+    /**
+     * builds the key to share runs of a command by (NOT SYNCHRONIZED)
+     *
+     * @param cmdcfg - specification how to run external command
+     *
+     * @return string - the key
+     */
+    static string makeKey( ExternalCommandConfig const &cmdcfg );
+
+    /**
+     * acquires a run of a command (SYNCHRONIZED)
+     *
+     * @param cmdcfg - specification how to run external command
+     * @param maxAge - maximum age of a finished run in milliseconds
+     * @param notify - data source to update when the command is done,
+     *   NULL when the job is waited for
+     * @param expectedEntries - estimated number of json entries
+     * @param launch - set to true when the returned job has to be run by
+     *   the caller
+     *
+     * @return ExternalCommandUpdateJob * - the job, to be released by release()
+     */
+    ExternalCommandUpdateJob * acquire( ExternalCommandConfig const &cmdcfg, unsigned long maxAge, DataSource *notify, size_t expectedEntries, bool &launch );
+    /**
+     * releases a job returned by acquire() (SYNCHRONIZED)
+     *
+     * The command is cancelled when no other data source waits for it.
+     *
+     * @param job - the job to release
+     * @param subscriber - the data source passed as notify to acquire()
+     */
+    void release( ExternalCommandUpdateJob *job, DataSource *subscriber );
+    /**
+     * records the completion of a job and triggers the updates of the
+     * subscribed data sources (SYNCHRONIZED - called with the executor
+     * lock held)
+     *
+     * @param job - the finished job
+     */
+    void completed( ExternalCommandUpdateJob &job );
+
+protected:
+    //! default constructor - see getInstance()
+    ExternalCommandCache()
+        : NS_AGENT Synchronized()
+        , mJobs()
+    {}
+
+    /**
+     * removes unused runs whose cache time expired (NOT SYNCHRONIZED - called with lock held)
+     *
+     * @param now - current time (see UpdateScheduler::now())
+     */
+    void purge( UpdateTime now );
+
+    //! most recent run of each command
+    map<string, ExternalCommandUpdateJob *> mJobs;
+
+    static ExternalCommandCache *mInstance;
+
+private:
+    ExternalCommandCache( ExternalCommandCache const & );
+    ExternalCommandCache & operator = ( ExternalCommandCache const & );
+};
+
+ExternalCommandCache *ExternalCommandCache::mInstance = 0;
+
+void
+ExternalCommandUpdateJob::finished()
+{
+    outputReceived(); // nothing left when called by the executor
+    mParseError = mParser->end();
+    mFinished = time(NULL);
+
+    ExternalCommandCache::getInstance().completed( *this );
+}
+
+string
+ExternalCommandCache::makeKey( ExternalCommandConfig const &cmdcfg )
+{
+    ostringstream key;
+
+    // '\0' can't be part of any of the strings
+    key << cmdcfg.Executable << '\0';
+    for( vector<string>::const_iterator iter = cmdcfg.Arguments.begin(); iter != cmdcfg.Arguments.end(); ++iter )
+        key << *iter << '\0';
+    key << '\0' << cmdcfg.User << '\0';
+    if( cmdcfg.UserResolved )
+    {
+        key << cmdcfg.UserCredentials.Uid << ':' << cmdcfg.UserCredentials.Gid;
+        for( vector<SystemUserInfo::gid_t>::const_iterator iter = cmdcfg.UserCredentials.Groups.begin(); iter != cmdcfg.UserCredentials.Groups.end(); ++iter )
+            key << ',' << *iter;
+    }
+    key << '\0';
+
+    for( ResourceLimits::const_iterator iter = cmdcfg.ResourceLimits.begin(); iter != cmdcfg.ResourceLimits.end(); ++iter )
+    {
+        if( iter->filled() )
+            key << iter->resource_id() << ( iter->soft() ? 's' : '-' ) << ( iter->hard() ? 'h' : '-' ) << ( iter->fix() ? 'f' : '-' ) << (unsigned long long)(rlim_t)(*iter) << ';';
+    }
+
+    // settings affecting the collected output
+    key << '\0' << cmdcfg.Timeout << ';' << cmdcfg.KillGrace << ';' << (int)cmdcfg.OutputFormat << ';'
+        << cmdcfg.MaxStdout << ';' << cmdcfg.MaxStderr << ';' << (int)cmdcfg.OutputOverflow;
+
+    return key.str();
+}
+
+ExternalCommandUpdateJob *
+ExternalCommandCache::acquire( ExternalCommandConfig const &cmdcfg, unsigned long maxAge, DataSource *notify, size_t expectedEntries, bool &launch )
+{
+    string key = makeKey( cmdcfg );
+    ExternalCommandUpdateJob *job = NULL;
+    UpdateTime now = UpdateScheduler::now();
+
+    lock();
+
+    purge( now );
+
+    map<string, ExternalCommandUpdateJob *>::iterator iter = mJobs.find( key );
+    if( iter != mJobs.end() )
+    {
+        job = iter->second;
+        if( job->mCompleted && ( job->mCompleted + maxAge <= now ) )
+        {
+            // too old for this data source - the users keep it until they release it
+            mJobs.erase( iter );
+            job->mCached = false;
+            if( 0 == job->mRefs )
+                delete job;
+            job = NULL;
+        }
+    }
+
+    launch = ( NULL == job );
+    if( launch )
+    {
+        job = new ExternalCommandUpdateJob( key, cmdcfg, expectedEntries );
+        mJobs.insert( make_pair( key, job ) );
+    }
+
+    ++job->mRefs;
+    job->mMaxAge = std::max( job->mMaxAge, maxAge );
+    if( notify && !job->mCompleted )
+        job->mSubscribers.push_back( notify );
+    unsigned refs = job->mRefs;
+
+    unlock();
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 5 );
+    LOG( "ExternalCommandCache::acquire(): (command) (shared) (users)" );
+    LOG( cmdcfg.Executable.c_str() );
+    LOG( launch ? "no" : "yes" );
+    LOG( refs );
+    LOG_END;
+
+    return job;
+}
+
+void
+ExternalCommandCache::release( ExternalCommandUpdateJob *job, DataSource *subscriber )
+{
+    bool cancel = false;
+
+    lock();
+
+    vector<DataSource *>::iterator where = std::find( job->mSubscribers.begin(), job->mSubscribers.end(), subscriber );
+    if( where != job->mSubscribers.end() )
+        job->mSubscribers.erase( where );
+
+    if( 0 == --job->mRefs )
+    {
+        if( !job->mCompleted )
+        {
+            // nobody waits for the output anymore
+            cancel = true;
+        }
+        else if( !job->mCached )
+        {
+            delete job;
+        }
+    }
+
+    if( cancel && job->mCached )
+    {
+        mJobs.erase( job->mKey );
+        job->mCached = false;
+    }
+
+    unlock();
+
+    if( cancel )
+    {
+        // outside of the cache lock - the executor calls completed() with its lock held
+        ExternalCommandExecutor::getInstance().cancel( *job );
+        delete job;
+    }
+}
+
+void
+ExternalCommandCache::completed( ExternalCommandUpdateJob &job )
+{
+    lock();
+
+    job.mCompleted = UpdateScheduler::now();
+    for( vector<DataSource *>::iterator iter = job.mSubscribers.begin(); iter != job.mSubscribers.end(); ++iter )
+        UpdateScheduler::getInstance().trigger( **iter, true );
+    job.mSubscribers.clear();
+
+    unlock();
+}
+
+void
+ExternalCommandCache::purge( UpdateTime now )
+{
+    map<string, ExternalCommandUpdateJob *>::iterator iter = mJobs.begin();
+    while( iter != mJobs.end() )
+    {
+        ExternalCommandUpdateJob *job = iter->second;
+        if( ( 0 == job->mRefs ) && job->mCompleted && ( job->mCompleted + job->mMaxAge <= now ) )
+        {
+            mJobs.erase( iter++ );
+            delete job;
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+DataSourceExternalCommand::~DataSourceExternalCommand()
+{
+    dropJob();
+    delete mCoProcess;
+}
+
 MibObject *
 DataSourceExternalCommand::getMibObject()
 {
@@ -75,9 +455,21 @@ DataSourceExternalCommand::buildCommandLine()
     }
 }
 
+ExternalCommandConfig
+DataSourceExternalCommand::resolveCommandConfig() const
+{
+    ExternalCommandConfig cmdcfg = mMibObj->getConfig().ExternalCommand;
+
+    if( !cmdcfg.User.empty() )
+        cmdcfg.UserResolved = ExternalCommandAsUser::resolve( cmdcfg.User, cmdcfg.UserCredentials );
+
+    return cmdcfg;
+}
+
 bool
 DataSourceExternalCommand::initMibObj()
 {
+    mCommandConfig = resolveCommandConfig();
     buildCommandLine();
 
 #if 0
@@ -103,41 +495,64 @@ DataSourceExternalCommand::checkMibObjConfig( Mib &mainMibCtrl )
     bool rc = DataSource::checkMibObjConfig(mainMibCtrl); // includes mMibObj->updateConfig();
     if( rc )
     {
+        ExternalCommandConfig cmdcfg = resolveCommandConfig();
+
         ThreadSynchronize guard(*this);
 
+        mCommandConfig = cmdcfg;
         buildCommandLine();
+
+        // restart the co-process when its command (or the identity of its user) has been changed
+        if( mCoProcess && ( !mCommandConfig.Persistent || !mCoProcess->matches( mCommandConfig ) ) )
+        {
+            mOutputCounters += mCoProcess->getOutputCounters();
+            delete mCoProcess;
+            mCoProcess = NULL;
+            mDeltaBase = false;
+        }
     }
 
     return rc;
 }
 
-bool
-DataSourceExternalCommand::updateMibObj()
+string const *
+DataSourceExternalCommand::requestCoProcess( ExtCmdMib &smExtCmdMib )
 {
-    ExternalCommand *cmd;
-    MibObjectConfig const mibCfg = mMibObj->getConfig();
+    if( !mCoProcess )
+        mCoProcess = new ExternalCoProcess( mCommandConfig );
+
+    // without a base the command must answer with the complete content
+    bool full = mCommandConfig.Differential && !( mDeltaBase && ( mCoProcess->getStarts() == mDeltaBaseStarts ) );
+    int comp_rc = mCoProcess->request( full ? "refresh-full" : "refresh" );
 
     LOG_BEGIN( loggerModuleName, DEBUG_LOG | 1 );
-    LOG("DataSourceExternalCommand::updateMibObj(): (commandline)");
+    LOG("DataSourceExternalCommand::requestCoProcess(): (command line) answered with (error) (starts)");
     LOG( mCommandLine.c_str() );
+    LOG( comp_rc );
+    LOG( mCoProcess->getStarts() );
     LOG_END;
 
-    ThreadSynchronize guard(*this);
+    if( 0 != comp_rc )
+    {
+        smExtCmdMib.setLastExecutionErrorCode( comp_rc );
+        smExtCmdMib.setLastExecutionState( mCoProcess->getExitCode(), mCoProcess->getExitSignal(), mCoProcess->getErrBuf(), time(NULL) );
 
-    if( !mibCfg.ExternalCommand.User.empty() )
-        cmd = new ExternalCommandAsUser(mibCfg.ExternalCommand);
-    else
-        cmd = new ExternalCommand(mibCfg.ExternalCommand);
+        return NULL;
+    }
 
-    MibObject::ContentManagerType &cntMgr = mMibObj->beginContentUpdate();
-    cntMgr.clear();
-    ExtCmdMib smExtCmdMib( cntMgr );
+    // the co-process is still running - the exit state of its last instance is reported
+    smExtCmdMib.setLastExecutionState( mCoProcess->getExitCode(), mCoProcess->getExitSignal(), mCoProcess->getErrBuf(), time(NULL) );
+
+    return &mCoProcess->getDocument();
+}
 
-    smExtCmdMib.setLastStartedTimestamp( time(NULL) );
-    smExtCmdMib.setCommandConfig( mibCfg.ExternalCommand.Executable, mCommandLine, mibCfg.ExternalCommand.User );
+ParseExternalOutput const *
+DataSourceExternalCommand::collectJob( ExtCmdMib &smExtCmdMib )
+{
+    ExternalCommand &cmd = mJob->getCommand();
+    int comp_rc = mJob->getErrorCode();
 
-    int comp_rc;
-    if( ( comp_rc = cmd->start() ) != 0 )
+    if( !mJob->isLaunched() )
     {
 #if 0
         mMibObj->set_value( mLastExitCodeOid, SnmpInt32(-1) );
@@ -153,26 +568,9 @@ DataSourceExternalCommand::updateMibObj()
         LOG( comp_rc );
         LOG_END;
 
-        delete cmd;
-
-        // copy last updated timestamp because it's lost otherwise after commit
-        smExtCmdMib.setUpdateTimestamp( mMibObj->GetLastUpdate() );
-        mMibObj->commitContentUpdate();
-
-        return false;
+        return NULL;
     }
 
-    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 5 );
-    LOG( "DataSourceExternalCommand::updateMibObj(): (command line) started with (pid)" );
-    LOG( mCommandLine.c_str() );
-    LOG( cmd->getChildPid() );
-    LOG_END;
-
-    while( cmd->poll(5) )
-        (void)0; /* nop() */
-
-    cmd->finish();
-
 #if 0
     rc = mMibObj->set_value( mLastFinishedTimestampOid, Counter64( time(NULL) ) );
     status &= rc;
@@ -183,79 +581,219 @@ DataSourceExternalCommand::updateMibObj()
     rc = mMibObj->set_value( mLastErrorMessageOid, OctetStr( cmd->getErrBuf().c_str() ) );
     status &= rc;
 #else
-    smExtCmdMib.setLastExecutionState( cmd->getExitCode(), cmd->getExitSignal(), cmd->getErrBuf(), time(NULL) );
+    smExtCmdMib.setLastExecutionState( cmd.getExitCode(), cmd.getExitSignal(), cmd.getErrBuf(), mJob->getFinished() );
 #endif
 
     LOG_BEGIN( loggerModuleName, DEBUG_LOG | 1 );
-    LOG( "DataSourceExternalCommand::updateMibObj(): (command line) finished with (exit code) (exit signal)" );
+    LOG( "DataSourceExternalCommand::updateMibObj(): (command line) finished with (exit code) (exit signal) (error)" );
     LOG( mCommandLine.c_str() );
-    LOG( cmd->getExitCode() );
-    LOG( cmd->getExitSignal() );
+    LOG( cmd.getExitCode() );
+    LOG( cmd.getExitSignal() );
+    LOG( comp_rc );
     LOG_END;
 
-    if( cmd->getExitCode() != 0 )
+    mOutputCounters += cmd.getOutputCounters();
+
+    if( 0 != comp_rc )
     {
-        delete cmd;
+        // killed after exceeding the time limit
+        smExtCmdMib.setLastErrorCode( comp_rc );
+        return NULL;
+    }
 
-        // copy last updated timestamp because it's lost otherwise after commit
-        smExtCmdMib.setUpdateTimestamp( mMibObj->GetLastUpdate() );
-        mMibObj->commitContentUpdate();
+    if( cmd.isOutTruncated() || ( cmd.hasOverflowed() && cmd.abortsOnOverflow() ) )
+    {
+        LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
+        LOG( "DataSourceExternalCommand::updateMibObj(): (command line) exceeded the output limits" );
+        LOG( mCommandLine.c_str() );
+        LOG_END;
 
-        return false;
+        smExtCmdMib.setLastErrorCode( EFBIG );
+        return NULL;
     }
 
-    ParseExternalJson pej;
-    pej.reserve(mExpectedEntryCount);
+    if( cmd.getExitCode() != 0 )
+        return NULL;
 
-    if( 0 == ( comp_rc = pej.parse( cmd->getOutBuf() ) ) )
+    return &mJob->getParser();
+}
+
+void
+DataSourceExternalCommand::dropJob()
+{
+    if( mJob )
     {
-        LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1 );
-        LOG( "DataSourceExternalCommand::updateMibObj(): json output successful parsed" );
-        LOG_END;
-        smExtCmdMib.setLastErrorCode( 0 );
+        ExternalCommandCache::getInstance().release( mJob, this );
+        mJob = NULL;
     }
-    else
+}
+
+bool
+DataSourceExternalCommand::updateMibObj()
+{
+    MibObjectConfig const mibCfg = mMibObj->getConfig();
+    ExternalCommandExecutor &executor = ExternalCommandExecutor::getInstance();
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 1 );
+    LOG("DataSourceExternalCommand::updateMibObj(): (commandline)");
+    LOG( mCommandLine.c_str() );
+    LOG_END;
+
+    ThreadSynchronize guard(*this);
+
+    if( mCommandConfig.Persistent )
     {
-        LOG_BEGIN(loggerModuleName, ERROR_LOG | 3 );
-        LOG( "DataSourceExternalCommand::updateMibObj(): error parsing json output" );
-        LOG_END;
+        dropJob(); // left from before the configuration has been changed
+    }
+    else if( !mJob )
+    {
+        bool launch = false;
+        mJob = ExternalCommandCache::getInstance().acquire( mCommandConfig, mibCfg.CacheTime, mibCfg.AsyncUpdate ? this : NULL, mExpectedEntryCount, launch );
 
-        smExtCmdMib.setLastErrorCode( comp_rc );
-        // copy last updated timestamp because it's lost otherwise after commit
-        smExtCmdMib.setUpdateTimestamp( mMibObj->GetLastUpdate() );
-        mMibObj->commitContentUpdate();
+        if( !launch )
+        {
+            // run shared with another data source
+            if( !executor.isDone( *mJob ) )
+            {
+                if( mibCfg.AsyncUpdate )
+                    return true; // collected by the update triggered when the command is done
+
+                executor.waitFor( *mJob );
+            }
+        }
+        else if( mibCfg.AsyncUpdate && executor.submit( *mJob ) )
+        {
+            LOG_BEGIN( loggerModuleName, DEBUG_LOG | 5 );
+            LOG( "DataSourceExternalCommand::updateMibObj(): (command line) queued for execution" );
+            LOG( mCommandLine.c_str() );
+            LOG_END;
+
+            // the output is collected by the update triggered when the command is done
+            return true;
+        }
+        else
+        {
+            executor.execute( *mJob );
+        }
+    }
+    else if( !executor.isDone( *mJob ) )
+    {
+        if( mibCfg.AsyncUpdate )
+            return true; // still running
 
-        delete cmd;
-        return false;
+        executor.waitFor( *mJob );
     }
 
-    delete cmd;
+    MibObject::ContentManagerType &cntMgr = mMibObj->beginContentUpdate();
+    cntMgr.clear();
+    ExtCmdMib smExtCmdMib( cntMgr );
 
-    vector<ExternalDataTuple> const &data = pej.getData();
-    mExpectedEntryCount = data.size();
-#if 0
-    MibStaticTable *extContent = new MibStaticTable( mExternalDataOid );
+    smExtCmdMib.setCommandConfig( mCommandConfig.Executable, mCommandLine, mCommandConfig.User );
+    smExtCmdMib.setDataPrefix( Oidx( mCommandConfig.OidPrefix.c_str() ) );
 
-    for( vector<ExternalDataTuple>::const_iterator iter = data.begin();
-         iter != data.end();
-         ++iter )
+    ParseExternalOutput *documentParser = NULL;
+    ParseExternalOutput const *parser = NULL;
+    int comp_rc = 0;
+    if( mCommandConfig.Persistent )
     {
-        const ExternalDataTuple &edt = *iter;
-	extContent->add( MibStaticEntry( Vbx( edt.Oid, *edt.Datum ) ) );
+        smExtCmdMib.setLastStartedTimestamp( time(NULL) );
+        string const *output = requestCoProcess( smExtCmdMib );
+        if( output )
+        {
+            parser = documentParser = create_parser( mCommandConfig.OutputFormat );
+            documentParser->reserve(mExpectedEntryCount);
+            if( 0 == documentParser->begin() )
+                (void)documentParser->feed( output->data(), output->size() );
+            comp_rc = documentParser->end();
+        }
+    }
+    else
+    {
+        // the output has been parsed while the command was running
+        smExtCmdMib.setLastStartedTimestamp( mJob->getStarted() );
+        parser = collectJob( smExtCmdMib );
+        comp_rc = mJob->getParseError();
     }
 
-    rc = mMibObj->set_value( extContent );
-    status &= rc;
+    ExternalOutputCounters counters( mOutputCounters );
+    if( mCoProcess )
+        counters += mCoProcess->getOutputCounters();
+    smExtCmdMib.setOutputCounters( counters );
 
-    rc = mMibObj->set_value( mLastUpdateTimestampOid, Counter64( time(NULL) ) );
-    status &= rc;
+    bool rc = false;
+    if( parser )
+    {
+        if( ( 0 == comp_rc ) && parser->isDelta() &&
+            !( mCommandConfig.Differential && mDeltaBase && mCoProcess && ( mCoProcess->getStarts() == mDeltaBaseStarts ) ) )
+        {
+            LOG_BEGIN(loggerModuleName, ERROR_LOG | 3 );
+            LOG( "DataSourceExternalCommand::updateMibObj(): differential output without base" );
+            LOG_END;
+
+            smExtCmdMib.setLastErrorCode( EPROTO );
+        }
+        else if( 0 == comp_rc )
+        {
+            LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1 );
+            LOG( "DataSourceExternalCommand::updateMibObj(): output successful parsed" );
+            LOG_END;
+            smExtCmdMib.setLastErrorCode( 0 );
+
+            vector<ExternalDataTuple> const &data = parser->getData();
+            if( !parser->isDelta() )
+                mExpectedEntryCount = data.size();
+#if 0
+            MibStaticTable *extContent = new MibStaticTable( mExternalDataOid );
+
+            for( vector<ExternalDataTuple>::const_iterator iter = data.begin();
+                 iter != data.end();
+                 ++iter )
+            {
+                const ExternalDataTuple &edt = *iter;
+                extContent->add( MibStaticEntry( Vbx( edt.Oid, *edt.Datum ) ) );
+            }
+
+            rc = mMibObj->set_value( extContent );
+            status &= rc;
+
+            rc = mMibObj->set_value( mLastUpdateTimestampOid, Counter64( time(NULL) ) );
+            status &= rc;
 #else
-    smExtCmdMib.setCommandResult( data );
-    smExtCmdMib.setUpdateTimestamp( time(NULL) );
-    mMibObj->commitContentUpdate();
+            if( parser->isDelta() )
+                smExtCmdMib.setCommandChanges( mMibObj->getPublishedContent(), data );
+            else
+                smExtCmdMib.setCommandResult( data );
+            smExtCmdMib.setUpdateTimestamp( time(NULL) );
+            rc = true;
+
+            mDeltaBase = mCommandConfig.Persistent;
+            mDeltaBaseStarts = mCoProcess ? mCoProcess->getStarts() : 0;
 #endif
+        }
+        else
+        {
+            LOG_BEGIN(loggerModuleName, ERROR_LOG | 3 );
+            LOG( "DataSourceExternalCommand::updateMibObj(): error parsing output" );
+            LOG_END;
+
+            smExtCmdMib.setLastErrorCode( comp_rc );
+        }
+    }
+
+    if( !rc )
+    {
+        // the previous content is dropped - a complete answer is needed next time
+        mDeltaBase = false;
 
-    return true;
+        // copy last updated timestamp because it's lost otherwise after commit
+        smExtCmdMib.setUpdateTimestamp( mMibObj->GetLastUpdate() );
+    }
+    mMibObj->commitContentUpdate();
+
+    delete documentParser;
+    dropJob();
+
+    return rc;
 }
 
 }
@@ -19,6 +19,21 @@
 #include <smart-snmpd/mibs/extcmd/extcmd.h>
 #include <smart-snmpd/log.h>
 
+#include <sys/resource.h>
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_VFORK_H
+# include <vfork.h>
+#endif
+#ifndef HAVE_WORKING_VFORK
+# define vfork fork
+#endif
+#include <pthread.h>
+#include <grp.h>
+
+#include <algorithm>
+
 namespace SmartSnmpd
 {
 
@@ -26,168 +41,438 @@ static const char * const loggerModuleName = "smartsnmpd.extcmd";
 
 ExternalCommand::~ExternalCommand()
 {
+    closeInput();
     if( mChildPid >= 0 )
         kill(SIGTERM);
     finish();
 }
 
+/**
+ * creates a pipe with both ends marked close-on-exec
+ *
+ * @param fds - receives the read and write end
+ *
+ * @return int - 0 on success, -1 on error (see errno)
+ */
+static int
+cloexec_pipe( int fds[2] )
+{
+#ifdef HAVE_PIPE2
+    if( 0 == pipe2( fds, O_CLOEXEC ) )
+        return 0;
+    if( ENOSYS != errno )
+        return -1;
+#endif
+    if( pipe( fds ) < 0 )
+        return -1;
+    fcntl( fds[0], F_SETFD, fcntl( fds[0], F_GETFD ) | FD_CLOEXEC );
+    fcntl( fds[1], F_SETFD, fcntl( fds[1], F_GETFD ) | FD_CLOEXEC );
+    return 0;
+}
+
+/**
+ * closes all descriptors from aLowFd on except aKeepFd
+ *
+ * Runs in the child between vfork() and execv() - therefore only async
+ * signal safe calls are allowed here, no memory must be allocated.
+ *
+ * @param aLowFd - lowest descriptor to close
+ * @param aKeepFd - descriptor to keep open (the exec error reporting pipe)
+ * @param aMaxFd - upper bound for the fallback loop
+ */
+static void
+close_inherited_fds( int aLowFd, int aKeepFd, int aMaxFd )
+{
+#if defined(HAVE_CLOSE_RANGE) || ( defined(HAVE_SYS_SYSCALL_H) && defined(SYS_close_range) )
+# ifdef HAVE_CLOSE_RANGE
+#  define SMART_SNMPD_CLOSE_RANGE(first, last) close_range( (first), (last), 0 )
+# else
+#  define SMART_SNMPD_CLOSE_RANGE(first, last) syscall( SYS_close_range, (first), (last), 0 )
+# endif
+    if( ( aKeepFd <= aLowFd || 0 == SMART_SNMPD_CLOSE_RANGE( (unsigned)aLowFd, (unsigned)( aKeepFd - 1 ) ) ) &&
+        0 == SMART_SNMPD_CLOSE_RANGE( (unsigned)( aKeepFd < aLowFd ? aLowFd : aKeepFd + 1 ), ~0U ) )
+        return;
+# undef SMART_SNMPD_CLOSE_RANGE
+#endif
+
+#if defined(HAVE_SYS_SYSCALL_H) && defined(SYS_getdents64)
+    // /proc/self/fd lists only the open descriptors - opendir() allocates, so read the entries raw
+    int dirfd = open( "/proc/self/fd", O_RDONLY | O_DIRECTORY );
+    if( dirfd >= 0 )
+    {
+        char buf[4096];
+        long bytes;
+        while( ( bytes = syscall( SYS_getdents64, dirfd, buf, sizeof(buf) ) ) > 0 )
+        {
+            for( long pos = 0; pos < bytes; )
+            {
+                // struct linux_dirent64: d_ino (8), d_off (8), d_reclen (2), d_type (1), d_name
+                unsigned short reclen;
+                memcpy( &reclen, buf + pos + 16, sizeof(reclen) );
+                char const *name = buf + pos + 19;
+                pos += reclen;
+
+                if( !isdigit( (unsigned char)(*name) ) )
+                    continue;
+                int fd = 0;
+                while( isdigit( (unsigned char)(*name) ) )
+                    fd = fd * 10 + ( *name++ - '0' );
+                if( fd >= aLowFd && fd != aKeepFd && fd != dirfd )
+                    close( fd );
+            }
+        }
+        close( dirfd );
+        if( 0 == bytes )
+            return;
+    }
+#endif
+
+    for( int fd = aLowFd; fd < aMaxFd; ++fd )
+    {
+        if( fd != aKeepFd )
+            close( fd );
+    }
+}
+
 int
 ExternalCommand::start()
 {
     if( mChildPid >= 0 )
         return EBADF;
 
-    int out[2], err[2];
-    if( pipe(out) < 0 )
+    /* XXX Unix only */
+    int maxfd = sysconf(_SC_OPEN_MAX);
+    if( maxfd <= 0 )
+#if defined(OPEN_MAX)
+        maxfd = OPEN_MAX;
+#elif defined(_POSIX_OPEN_MAX)
+        maxfd = _POSIX_OPEN_MAX;
+#else
+        maxfd = 16;
+#endif
+
+    // everything the child needs is prepared here - it mustn't allocate memory
+    vector<const char *> argv;
+    argv.reserve( mArguments.size() + 2 );
+    argv.push_back( mExecutable.c_str() );
+    for( size_t i = 0; i < mArguments.size(); ++i )
+        argv.push_back( mArguments[i].c_str() );
+    argv.push_back( NULL );
+
+    vector< pair<int, struct rlimit> > limits;
+    for( ResourceLimits::const_iterator ci = mResourceLimits.begin(); ci != mResourceLimits.end(); ++ci )
+    {
+        if( !ci->filled() )
+            continue;
+
+        struct rlimit cur_limit;
+        if( -1 == getrlimit( ci->resource_id(), &cur_limit ) )
+        {
+            LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
+            LOG("ExternalCommand::start() (command) (getrlimit(rlimit) error)");
+            LOG(mExecutable.c_str());
+            LOG(ci->resource_id());
+            LOG(errno);
+            LOG_END;
+            continue;
+        }
+
+        if( ci->hard() )
+            cur_limit.rlim_max = (rlim_t)(*ci);
+        if( ci->soft() )
+            cur_limit.rlim_cur = (rlim_t)(*ci);
+
+        limits.push_back( make_pair( ci->resource_id(), cur_limit ) );
+    }
+
+    int in[2] = { -1, -1 }, out[2], err[2], exc[2];
+    if( mWithInput && cloexec_pipe(in) < 0 )
+    {
+        int errno_code = errno;
+        LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
+        LOG("ExternalCommand::start() (command) (stdin pipe error)");
+        LOG(mExecutable.c_str());
+        LOG(errno_code); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
+        LOG_END;
+        return errno_code;
+    }
+    if( cloexec_pipe(out) < 0 )
     {
         int errno_code = errno;
         LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
         LOG("ExternalCommand::start() (command) (stdout pipe error)");
         LOG(mExecutable.c_str());
-        LOG(errno); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
+        LOG(errno_code); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
         LOG_END;
+        if( mWithInput ) { close( in[0] ); close( in[1] ); }
         return errno_code;
     }
-    if( pipe(err) < 0 )
+    if( cloexec_pipe(err) < 0 )
     {
         int errno_code = errno;
         LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
         LOG("ExternalCommand::start() (command) (stderr pipe error)");
         LOG(mExecutable.c_str());
-        LOG(errno); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
+        LOG(errno_code); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
         LOG_END;
+        if( mWithInput ) { close( in[0] ); close( in[1] ); }
+        close( out[0] ); close( out[1] );
         return errno_code;
     }
-
-    mChildPid = fork();
-    if( mChildPid < 0 )
+    // the child reports a failing execv() through this pipe, it's closed by a successful one
+    if( cloexec_pipe(exc) < 0 )
     {
         int errno_code = errno;
         LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
-        LOG("ExternalCommand::start() (command) (fork error)");
+        LOG("ExternalCommand::start() (command) (exec status pipe error)");
         LOG(mExecutable.c_str());
         LOG(errno_code); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
         LOG_END;
+        if( mWithInput ) { close( in[0] ); close( in[1] ); }
         close( out[0] ); close( out[1] );
         close( err[0] ); close( err[1] );
         return errno_code;
     }
-    else if( 0 == mChildPid )
-    {
-        /* XXX Unix only */
-        int maxfd = sysconf(_SC_OPEN_MAX);
-        if( maxfd <= 0 )
-#if defined(OPEN_MAX)
-            maxfd = OPEN_MAX;
-#elif defined(_POSIX_OPEN_MAX)
-            maxfd = _POSIX_OPEN_MAX;
-#else
-            maxfd = 16;
-#endif
 
-        for( ResourceLimits::const_iterator ci = mResourceLimits.begin(); ci != mResourceLimits.end(); ++ci )
-        {
-            ci->commit();
-        }
+    // no signal handler of the agent may run in the child while it shares our memory
+    sigset_t all_signals, old_signals;
+    sigfillset( &all_signals );
+    pthread_sigmask( SIG_SETMASK, &all_signals, &old_signals );
 
-        // child
-        close( out[0] ); close( err[0] ); // close write ends of pipes
-        if( dup2( out[1], STDOUT_FILENO ) != STDOUT_FILENO )
+    mChildPid = vfork();
+    if( 0 == mChildPid )
+    {
+        // child - async signal safe calls only until execv()
+        struct sigaction sa;
+        for( int sig = 1; sig < NSIG; ++sig )
         {
-            int errno_code = errno;
-            LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
-            LOG("ExternalCommand::start() (command) (dup2 stdout)");
-            LOG(mExecutable.c_str());
-            LOG(errno); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
-            LOG_END;
-            exit( errno_code );
+            if( 0 == sigaction( sig, NULL, &sa ) && SIG_IGN != sa.sa_handler && SIG_DFL != sa.sa_handler )
+            {
+                sa.sa_handler = SIG_DFL;
+                sa.sa_flags = 0;
+                sigemptyset( &sa.sa_mask );
+                sigaction( sig, &sa, NULL );
+            }
         }
-        if( dup2( err[1], STDERR_FILENO ) != STDERR_FILENO )
+        sigprocmask( SIG_SETMASK, &old_signals, NULL );
+
+        for( size_t i = 0; i < limits.size(); ++i )
+            (void)setrlimit( limits[i].first, &limits[i].second ); // failures are ignored like ResourceLimit::commit() does
+
+        int errno_code = applyIdentity();
+        if( 0 != errno_code )
+            ; // reported below
+        else if( ( mWithInput && dup2( in[0], STDIN_FILENO ) != STDIN_FILENO ) ||
+                 dup2( out[1], STDOUT_FILENO ) != STDOUT_FILENO || dup2( err[1], STDERR_FILENO ) != STDERR_FILENO )
+            errno_code = errno;
+        else
         {
-            int errno_code = errno;
-            LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
-            LOG("ExternalCommand::start() (command) (dup2 stderr)");
-            LOG(mExecutable.c_str());
-            LOG(errno); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
-            LOG_END;
-            exit( errno_code );
+            close_inherited_fds( STDERR_FILENO + 1, exc[1], maxfd );
+            execv( argv[0], (char **)&argv[0] );
+            errno_code = errno;
         }
 
-        for( int fd = STDERR_FILENO + 1; fd < maxfd; ++fd )
+        ssize_t written;
+        do
         {
-            int flags = fcntl( fd, F_GETFD );
-            if( flags < 0 )
-                continue; // probably not open (EBADF) ...
-            flags |= FD_CLOEXEC;
-            if( fcntl( fd, F_SETFD, flags ) < 0 )
-            {
-                LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
-                LOG("ExternalCommand::start() (command) (fcntl( fd, F_SETFD, +FD_CLOEXEC) error)");
-                LOG(mExecutable.c_str());
-                LOG(errno);
-                LOG_END;
-            }
-        }
+            written = write( exc[1], &errno_code, sizeof(errno_code) );
+        } while( written < 0 && EINTR == errno );
+        _exit( 127 );
+    }
 
-        const char **argv = (const char **)alloca( sizeof(char *) * (mArguments.size() + 2) );
-        argv[0] = mExecutable.c_str();
-        for( size_t i = 0; i < mArguments.size(); ++i )
-            argv[i + 1] = mArguments[i].c_str();
-        argv[mArguments.size() + 1] = NULL;
+    int errno_code = mChildPid < 0 ? errno : 0;
+    pthread_sigmask( SIG_SETMASK, &old_signals, NULL );
 
-        execv( mExecutable.c_str(), (char **)argv );
+    close( out[1] ); close( err[1] ); close( exc[1] ); // close write ends of pipes
+    if( mWithInput )
+        close( in[0] ); // close read end of input pipe
 
-        int errno_code = errno;
+    if( mChildPid < 0 )
+    {
+        LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
+        LOG("ExternalCommand::start() (command) (vfork error)");
+        LOG(mExecutable.c_str());
+        LOG(errno_code); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
+        LOG_END;
+        if( mWithInput ) close( in[1] );
+        close( out[0] ); close( err[0] ); close( exc[0] );
+        return errno_code;
+    }
+
+    ssize_t bytes;
+    do
+    {
+        bytes = read( exc[0], &errno_code, sizeof(errno_code) );
+    } while( bytes < 0 && EINTR == errno );
+    close( exc[0] );
+
+    if( bytes == (ssize_t)sizeof(errno_code) )
+    {
         LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
         LOG("ExternalCommand::start() (command) (execv)");
         LOG(mExecutable.c_str());
         LOG(errno_code); // strerror isn't thread safe over all platforms - borrow new code from libstatgrab here for text error
         LOG_END;
 
-        exit( errno_code );
+        waitpid( mChildPid, NULL, 0 );
+        mChildPid = -1;
+        if( mWithInput ) close( in[1] );
+        close( out[0] ); close( err[0] );
+        return errno_code;
     }
-    else
+
+    // parent - the pipes may be inherited by children of the command, so
+    // reading them must never block after the command has exited
+    fcntl( out[0], F_SETFL, fcntl( out[0], F_GETFL ) | O_NONBLOCK );
+    fcntl( err[0], F_SETFL, fcntl( err[0], F_GETFL ) | O_NONBLOCK );
+    mFileno[0] = out[0];
+    mFileno[1] = err[0];
+    if( mWithInput )
     {
-        // parent
-        close( out[1] ); close( err[1] ); // close read ends of pipes
-        mFileno[0] = out[0];
-        mFileno[1] = err[0];
-        mBuffers[0].clear();
-        mBuffers[1].clear();
+        // writeInput() waits with poll() - never block on a full pipe
+        fcntl( in[1], F_SETFL, fcntl( in[1], F_GETFL ) | O_NONBLOCK );
+        mInFileno = in[1];
     }
+    mBuffers[0].clear();
+    mBuffers[1].clear();
+    mErrStart = 0;
+    mOverflowed = false;
+    mOutTruncated = false;
 
     return 0;
 }
 
 bool
-ExternalCommand::poll(unsigned seconds)
+ExternalCommand::readPipe(unsigned idx)
+{
+    // large chunks keep the number of reads (and sink calls) low for huge outputs
+    char data[16384];
+    ssize_t bytes = read( mFileno[idx], data, sizeof(data) );
+    if( bytes > 0 )
+    {
+        size_t length = (size_t)bytes;
+
+        if( 0 == idx )
+        {
+            mCounters.OutBytes += length;
+
+            // a sink gets the whole output, otherwise the unconsumed buffer is limited
+            unsigned long long held = mOutSink ? mCounters.OutBytes - length : mBuffers[0].size();
+            if( mMaxStdout && ( held + length > mMaxStdout ) )
+            {
+                size_t keep = ( held < mMaxStdout ) ? (size_t)( mMaxStdout - held ) : 0;
+                mOutTruncated = true;
+                overflow( length - keep );
+                length = keep;
+            }
+
+            if( length > 0 )
+            {
+                if( mOutSink )
+                    mOutSink->consume( data, length );
+                else
+                    mBuffers[0].append( data, length );
+            }
+        }
+        else
+        {
+            mCounters.ErrBytes += length;
+
+            if( mMaxStderr )
+                appendErrTail( data, length );
+            else
+                mBuffers[1].append( data, length );
+        }
+
+        return true;
+    }
+    else if( 0 == bytes || ( EINTR != errno && EAGAIN != errno && EWOULDBLOCK != errno ) )
+    {
+        close(mFileno[idx]);
+        mFileno[idx] = -1;
+    }
+
+    return false;
+}
+
+void
+ExternalCommand::appendErrTail(const char *data, size_t length)
+{
+    string &buf = mBuffers[1];
+
+    size_t take = mMaxStderr - buf.size();
+    if( take > length )
+        take = length;
+    buf.append( data, take );
+    data += take;
+    length -= take;
+
+    if( length > 0 )
+        overflow( length );
+
+    // full - overwrite the oldest bytes in place
+    while( length > 0 )
+    {
+        size_t chunk = mMaxStderr - mErrStart;
+        if( chunk > length )
+            chunk = length;
+        buf.replace( mErrStart, chunk, data, chunk );
+        mErrStart = ( mErrStart + chunk ) % mMaxStderr;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void
+ExternalCommand::overflow(size_t discarded)
+{
+    mCounters.DiscardedBytes += discarded;
+
+    if( !mOverflowed )
+    {
+        mOverflowed = true;
+        ++mCounters.Overflows;
+
+        LOG_BEGIN( loggerModuleName, WARNING_LOG | 2 );
+        LOG("ExternalCommand::overflow(): (command) (pid) exceeded output limit (abort)");
+        LOG(mExecutable.c_str());
+        LOG(mChildPid);
+        LOG(mAbortOnOverflow ? "yes" : "no");
+        LOG_END;
+
+        if( mAbortOnOverflow && ( mChildPid > 0 ) )
+            ::kill( mChildPid, SIGKILL );
+    }
+}
+
+string const &
+ExternalCommand::getErrBuf() const
+{
+    // linearize the ring buffer
+    if( mErrStart )
+    {
+        std::rotate( mBuffers[1].begin(), mBuffers[1].begin() + mErrStart, mBuffers[1].end() );
+        mErrStart = 0;
+    }
+
+    return mBuffers[1];
+}
+
+bool
+ExternalCommand::pollMs(unsigned long milliseconds)
 {
     if( (mChildPid == -1) && (mFileno[0] == -1) && (mFileno[1] == -1) )
         return false;
 
     struct pollfd fds[2] = { { mFileno[0], POLLIN, 0 }, { mFileno[1], POLLIN, 0 } };
 
-    int ready = ::poll( fds, 2, seconds * 1000 );
-    if( ready )
+    int ready = ::poll( fds, 2, milliseconds > INT_MAX ? INT_MAX : (int)milliseconds );
+    if( ready > 0 )
     {
         for( unsigned i = 0; i < lengthof(fds); ++i )
         {
-            if( ( fds[i].revents & POLLIN ) != 0 )
-            {
-                char buf[4096];
-                ssize_t bytes;
-                bytes = read( mFileno[i], buf, sizeof(buf) );
-                if( 0 != bytes )
-                {
-                    string s( buf, bytes );
-                    mBuffers[i].append(s);
-                }
-                else
-                {
-                    close(mFileno[i]);
-                    mFileno[i] = -1;
-                }
-            }
+            if( ( fds[i].revents & ( POLLIN | POLLHUP | POLLERR ) ) != 0 )
+                readPipe( i );
         }
     }
 
@@ -208,26 +493,12 @@ ExternalCommand::poll(unsigned seconds)
                 mExitSignal = WTERMSIG(status);
                 mChildPid = -1;
             }
-        }
 
-        // read left data from pipes
-        for( unsigned i = 0; i < lengthof(mFileno); ++i )
-        {
-            while( mFileno[i] > 0 )
+            // take what is buffered in the pipes - open ones stay in the poll set
+            for( unsigned i = 0; i < lengthof(mFileno); ++i )
             {
-                char buf[4096];
-                ssize_t bytes;
-                bytes = read( mFileno[i], buf, sizeof(buf) );
-                if( 0 != bytes )
-                {
-                    string s( buf, bytes );
-                    mBuffers[i].append(s);
-                }
-                else
-                {
-                    close(mFileno[i]);
-                    mFileno[i] = -1;
-                }
+                while( ( mFileno[i] >= 0 ) && readPipe( i ) )
+                    (void)0;
             }
         }
     }
@@ -235,6 +506,96 @@ ExternalCommand::poll(unsigned seconds)
     return (mChildPid != -1) || (mFileno[0] != -1) || (mFileno[1] != -1);
 }
 
+void
+ExternalCommand::finish()
+{
+    while( ( mChildPid != -1 ) && poll(1) )
+        (void)0;
+
+    closeOutput();
+}
+
+void
+ExternalCommand::closeOutput()
+{
+    for( unsigned i = 0; i < lengthof(mFileno); ++i )
+    {
+        if( mFileno[i] >= 0 )
+        {
+            close( mFileno[i] );
+            mFileno[i] = -1;
+        }
+    }
+}
+
+int
+ExternalCommand::writeInput(string const &data, unsigned long milliseconds)
+{
+    if( mInFileno < 0 )
+        return EBADF;
+
+    // a command which closed its STDIN mustn't kill the agent by SIGPIPE
+    sigset_t pipe_signal, old_signals, pending;
+    sigemptyset( &pipe_signal );
+    sigaddset( &pipe_signal, SIGPIPE );
+    pthread_sigmask( SIG_BLOCK, &pipe_signal, &old_signals );
+    sigpending( &pending );
+    bool was_pending = sigismember( &pending, SIGPIPE );
+
+    UpdateTime deadline = UpdateScheduler::now() + milliseconds;
+    size_t written = 0;
+    int rc = 0;
+    while( written < data.size() )
+    {
+        ssize_t bytes = write( mInFileno, data.data() + written, data.size() - written );
+        if( bytes >= 0 )
+        {
+            written += bytes;
+            continue;
+        }
+        if( EINTR == errno )
+            continue;
+        if( EAGAIN != errno && EWOULDBLOCK != errno )
+        {
+            rc = errno;
+            break;
+        }
+
+        UpdateTime now = UpdateScheduler::now();
+        if( now >= deadline )
+        {
+            rc = ETIMEDOUT;
+            break;
+        }
+
+        struct pollfd fd = { mInFileno, POLLOUT, 0 };
+        (void)::poll( &fd, 1, deadline - now > INT_MAX ? INT_MAX : (int)(deadline - now) );
+    }
+
+    if( EPIPE == rc && !was_pending )
+    {
+        sigpending( &pending );
+        if( sigismember( &pending, SIGPIPE ) )
+        {
+            int sig;
+            sigwait( &pipe_signal, &sig );
+        }
+    }
+    pthread_sigmask( SIG_SETMASK, &old_signals, NULL );
+
+    return rc;
+}
+
+void
+ExternalCommand::closeInput()
+{
+    if( mInFileno >= 0 )
+    {
+        close( mInFileno );
+        mInFileno = -1;
+    }
+}
+
 int
 ExternalCommand::kill(int signal)
 {
@@ -248,7 +609,286 @@ ExternalCommand::kill(int signal)
 ExternalCommandAsUser::ExternalCommandAsUser(ExternalCommandConfig const &cmdcfg)
     : ExternalCommand(cmdcfg)
     , mUser(cmdcfg.User)
+    , mCredentials(cmdcfg.UserCredentials)
+    , mResolved(cmdcfg.UserResolved)
+    , mSwitch(false)
+{
+    checkSwitch();
+}
+
+bool
+ExternalCommandAsUser::resolve(string const &user, SystemUserInfo::Credentials &credentials)
+{
+#if defined(WITH_USER_LOOKUP) && (WITH_USER_LOOKUP != 0)
+    SystemUserInfo sysUserInfo;
+    return sysUserInfo.getusercredentials( user, credentials );
+#else
+    (void)user;
+    (void)credentials;
+    return false;
+#endif
+}
+
+void
+ExternalCommandAsUser::checkSwitch()
+{
+    mSwitch = mResolved && ( ( mCredentials.Uid != geteuid() ) || ( mCredentials.Gid != getegid() ) );
+}
+
+int
+ExternalCommandAsUser::start()
+{
+    if( !mResolved )
+    {
+        LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
+        LOG("ExternalCommandAsUser::start() (command) (user) (unknown user)");
+        LOG(mExecutable.c_str());
+        LOG(mUser.c_str());
+        LOG_END;
+
+#if defined(WITH_USER_LOOKUP) && (WITH_USER_LOOKUP != 0)
+        return ENOENT;
+#else
+        return ENOSYS;
+#endif
+    }
+
+    return ExternalCommand::start();
+}
+
+int
+ExternalCommandAsUser::applyIdentity() const
+{
+    if( !mSwitch )
+        return 0;
+
+    gid_t const *groups = mCredentials.Groups.empty() ? NULL : &mCredentials.Groups[0];
+    size_t ngroups = mCredentials.Groups.size();
+
+#if defined(HAVE_SYS_SYSCALL_H) && defined(SYS_setgroups) && defined(SYS_setresgid) && defined(SYS_setresuid)
+    // the libc wrappers change the identity of all threads of the process -
+    // which are the threads of the agent in a vfork()ed child, so the
+    // system calls are issued directly (affecting the calling thread only)
+# if defined(SYS_setresuid32)
+    if( 0 != syscall( SYS_setgroups32, ngroups, groups ) ||
+        0 != syscall( SYS_setresgid32, mCredentials.Gid, mCredentials.Gid, mCredentials.Gid ) ||
+        0 != syscall( SYS_setresuid32, mCredentials.Uid, mCredentials.Uid, mCredentials.Uid ) )
+        return errno;
+# else
+    if( 0 != syscall( SYS_setgroups, ngroups, groups ) ||
+        0 != syscall( SYS_setresgid, mCredentials.Gid, mCredentials.Gid, mCredentials.Gid ) ||
+        0 != syscall( SYS_setresuid, mCredentials.Uid, mCredentials.Uid, mCredentials.Uid ) )
+        return errno;
+# endif
+#else
+    if( 0 != setgroups( ngroups, groups ) || 0 != setgid( mCredentials.Gid ) || 0 != setuid( mCredentials.Uid ) )
+        return errno;
+#endif
+
+    return 0;
+}
+
+
+ExternalCoProcess::ExternalCoProcess(ExternalCommandConfig const &cmdcfg)
+    : mConfig(cmdcfg)
+    , mCommand(NULL)
+    , mDocument()
+    , mErrBuf()
+    , mExitCode(-1)
+    , mExitSignal(-1)
+    , mStarts(0)
+    , mBackoff(0)
+    , mNextStart(0)
+    , mCounters()
+{
+}
+
+ExternalCoProcess::~ExternalCoProcess()
 {
+    if( mCommand )
+    {
+        // give the command the chance to exit on end of input before it's terminated
+        mCommand->closeInput();
+        UpdateTime deadline = UpdateScheduler::now() + mConfig.RequestTimeout;
+        while( mCommand->pollMs( 100 ) && ( UpdateScheduler::now() < deadline ) )
+            (void)0;
+
+        delete mCommand;
+    }
+}
+
+bool
+ExternalCoProcess::matches(ExternalCommandConfig const &cmdcfg) const
+{
+    return ( mConfig.Executable == cmdcfg.Executable ) && ( mConfig.Arguments == cmdcfg.Arguments ) && ( mConfig.User == cmdcfg.User ) &&
+           ( mConfig.UserResolved == cmdcfg.UserResolved ) && ( mConfig.UserCredentials.Uid == cmdcfg.UserCredentials.Uid ) &&
+           ( mConfig.UserCredentials.Gid == cmdcfg.UserCredentials.Gid ) && ( mConfig.UserCredentials.Groups == cmdcfg.UserCredentials.Groups ) &&
+           ( mConfig.RequestTimeout == cmdcfg.RequestTimeout ) && ( mConfig.RestartBackoff == cmdcfg.RestartBackoff ) &&
+           ( mConfig.RestartBackoffMax == cmdcfg.RestartBackoffMax ) && ( mConfig.OutputFormat == cmdcfg.OutputFormat ) &&
+           ( mConfig.MaxStdout == cmdcfg.MaxStdout ) && ( mConfig.MaxStderr == cmdcfg.MaxStderr ) && ( mConfig.OutputOverflow == cmdcfg.OutputOverflow );
+}
+
+int
+ExternalCoProcess::request(string const &request)
+{
+    UpdateTime now = UpdateScheduler::now();
+
+    if( mCommand )
+    {
+        // reap an instance which exited since the last request
+        (void)mCommand->pollMs( 0 );
+        if( mCommand->getChildPid() < 0 )
+            abandon( now, false );
+    }
+
+    if( !mCommand )
+    {
+        if( now < mNextStart )
+            return EAGAIN;
+
+        if( !mConfig.User.empty() )
+            mCommand = new ExternalCommandAsUser(mConfig);
+        else
+            mCommand = new ExternalCommand(mConfig);
+        mCommand->setInputPipe( true );
+
+        int rc = mCommand->start();
+        if( 0 != rc )
+        {
+            abandon( now, true );
+            return rc;
+        }
+
+        ++mStarts;
+
+        LOG_BEGIN( loggerModuleName, INFO_LOG | 3 );
+        LOG("ExternalCoProcess::request() (command) started co-process with (pid) (starts)");
+        LOG(mConfig.Executable.c_str());
+        LOG(mCommand->getChildPid());
+        LOG(mStarts);
+        LOG_END;
+    }
+
+    // stale output doesn't belong to this request
+    mCommand->consumeOutBuf( mCommand->getOutBuf().size() );
+    mCommand->clearErrBuf();
+
+    UpdateTime deadline = now + mConfig.RequestTimeout;
+    int rc = mCommand->writeInput( request + "\n", mConfig.RequestTimeout );
+    bool running = true;
+    while( 0 == rc )
+    {
+        if( EAGAIN != ( rc = extractFrame() ) )
+            break;
+
+        if( !running )
+        {
+            rc = EPIPE;
+            break;
+        }
+
+        now = UpdateScheduler::now();
+        if( now >= deadline )
+        {
+            rc = ETIMEDOUT;
+            break;
+        }
+
+        running = mCommand->pollMs( deadline - now );
+        rc = 0;
+
+        // lost output breaks the framing
+        if( mCommand->isOutTruncated() || ( mCommand->hasOverflowed() && mCommand->abortsOnOverflow() ) )
+        {
+            rc = EFBIG;
+            break;
+        }
+    }
+
+    mErrBuf = mCommand->getErrBuf();
+
+    if( 0 != rc )
+    {
+        LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
+        LOG("ExternalCoProcess::request() (command) (pid) failed with (error) - restarting");
+        LOG(mConfig.Executable.c_str());
+        LOG(mCommand->getChildPid());
+        LOG(rc);
+        LOG_END;
+
+        abandon( UpdateScheduler::now(), true );
+    }
+    else
+    {
+        mBackoff = 0;
+    }
+
+    return rc;
+}
+
+int
+ExternalCoProcess::extractFrame()
+{
+    string const &out = mCommand->getOutBuf();
+    size_t pos = 0, length = 0, digits = 0;
+
+    while( pos < out.size() && isspace( (unsigned char)(out[pos]) ) )
+        ++pos;
+
+    for( ; pos < out.size() && isdigit( (unsigned char)(out[pos]) ); ++pos )
+    {
+        if( ++digits > 18 )
+            return EPROTO;
+        length = length * 10 + ( out[pos] - '0' );
+    }
+
+    if( pos == out.size() )
+        return EAGAIN; // header not complete
+    if( ( 0 == digits ) || ( '\n' != out[pos] ) )
+        return EPROTO;
+    if( mConfig.MaxStdout && ( length > mConfig.MaxStdout ) )
+        return EFBIG;
+    ++pos;
+
+    if( out.size() - pos < length )
+        return EAGAIN;
+
+    mDocument.assign( out, pos, length );
+    mCommand->consumeOutBuf( pos + length );
+
+    return 0;
+}
+
+void
+ExternalCoProcess::abandon(UpdateTime now, bool failed)
+{
+    if( mCommand )
+    {
+        mCommand->closeInput();
+        if( mCommand->getChildPid() > 0 )
+            mCommand->kill( SIGKILL );
+        mCommand->finish();
+
+        mErrBuf = mCommand->getErrBuf();
+        mExitCode = mCommand->getExitCode();
+        mExitSignal = mCommand->getExitSignal();
+        mCounters += mCommand->getOutputCounters();
+
+        delete mCommand;
+        mCommand = NULL;
+    }
+
+    if( failed )
+    {
+        mBackoff = mBackoff ? mBackoff * 2 : mConfig.RestartBackoff;
+        if( mBackoff > mConfig.RestartBackoffMax )
+            mBackoff = mConfig.RestartBackoffMax;
+        mNextStart = now + mBackoff;
+    }
+    else
+    {
+        mNextStart = now;
+    }
 }
 
 }
@@ -0,0 +1,521 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/mibs/extcmd/extcmdexecutor.h>
+#include <smart-snmpd/log.h>
+
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+
+namespace SmartSnmpd
+{
+
+static const char * const loggerModuleName = "smartsnmpd.extcmd.executor";
+
+//! interval to check for exited children when no pidfd is available
+static const unsigned long ReapInterval = 100;
+
+ExternalCommandExecutor *ExternalCommandExecutor::mInstance = 0;
+
+void
+ExternalCommandWorker::run()
+{
+    mExecutor.loop();
+}
+
+ExternalCommandExecutor::ExternalCommandExecutor()
+    : Synchronized()
+    , mQueue()
+    , mActive()
+    , mPollFds()
+    , mWorker( 0 )
+    , mConcurrency( 1 )
+    , mRunning( false )
+{
+    mWakeupPipe[0] = mWakeupPipe[1] = -1;
+}
+
+ExternalCommandExecutor::~ExternalCommandExecutor()
+{
+    stop();
+
+    if( mWakeupPipe[0] >= 0 )
+    {
+        close( mWakeupPipe[0] );
+        close( mWakeupPipe[1] );
+    }
+}
+
+ExternalCommandExecutor &
+ExternalCommandExecutor::getInstance()
+{
+    if( 0 == mInstance )
+        mInstance = new ExternalCommandExecutor();
+    return *mInstance;
+}
+
+bool
+ExternalCommandExecutor::start( unsigned aConcurrency )
+{
+    lock();
+
+    mConcurrency = aConcurrency ? aConcurrency : 1;
+
+    if( !mRunning )
+    {
+        if( mWakeupPipe[0] < 0 )
+        {
+            if( pipe( mWakeupPipe ) < 0 )
+            {
+                LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+                LOG("ExternalCommandExecutor::start(): failed to create wakeup pipe (error)");
+                LOG(errno);
+                LOG_END;
+
+                mWakeupPipe[0] = mWakeupPipe[1] = -1;
+                unlock();
+                return false;
+            }
+
+            for( unsigned i = 0; i < lengthof(mWakeupPipe); ++i )
+            {
+                fcntl( mWakeupPipe[i], F_SETFD, fcntl( mWakeupPipe[i], F_GETFD ) | FD_CLOEXEC );
+                fcntl( mWakeupPipe[i], F_SETFL, fcntl( mWakeupPipe[i], F_GETFL ) | O_NONBLOCK );
+            }
+        }
+
+        LOG_BEGIN(loggerModuleName, EVENT_LOG | 3);
+        LOG("ExternalCommandExecutor::start(): starting (concurrency)");
+        LOG(mConcurrency);
+        LOG_END;
+
+        mRunning = true;
+        mWorker = new ExternalCommandWorker( *this );
+        mWorker->start();
+        if( !mWorker->is_alive() )
+        {
+            LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+            LOG("ExternalCommandExecutor::start(): failed to start i/o thread - commands are run by the updating threads");
+            LOG_END;
+
+            delete mWorker;
+            mWorker = 0;
+            mRunning = false;
+        }
+    }
+
+    bool rc = mRunning;
+    unlock();
+
+    return rc;
+}
+
+void
+ExternalCommandExecutor::stop()
+{
+    lock();
+    mRunning = false;
+    wakeup();
+    ExternalCommandWorker *worker = mWorker;
+    mWorker = 0;
+    unlock();
+
+    if( worker )
+    {
+        worker->join();
+        delete worker;
+    }
+}
+
+void
+ExternalCommandExecutor::setConcurrency( unsigned aConcurrency )
+{
+    lock();
+    mConcurrency = aConcurrency ? aConcurrency : 1;
+    wakeup();
+    unlock();
+}
+
+bool
+ExternalCommandExecutor::submit( ExternalCommandJob &aJob )
+{
+    lock();
+
+    if( !mRunning )
+    {
+        unlock();
+        return false;
+    }
+
+    aJob.mDeadline = 0;
+    aJob.mKillStage = 0;
+    aJob.mErrorCode = 0;
+    aJob.mLaunched = false;
+    aJob.mStarting = false;
+    aJob.mCancelled = false;
+    aJob.mDone = false;
+    mQueue.push_back( &aJob );
+    wakeup();
+
+    unlock();
+
+    return true;
+}
+
+void
+ExternalCommandExecutor::execute( ExternalCommandJob &aJob )
+{
+    if( submit( aJob ) )
+    {
+        waitFor( aJob );
+        return;
+    }
+
+    // no i/o thread - supervise the command in the calling thread
+    aJob.mDeadline = 0;
+    aJob.mKillStage = 0;
+    aJob.mErrorCode = 0;
+    aJob.mLaunched = false;
+    aJob.mStarting = false;
+    aJob.mCancelled = false;
+    aJob.mDone = false;
+
+    if( launch( aJob, UpdateScheduler::now() ) )
+    {
+        for(;;)
+        {
+            unsigned long wait = 1000;
+            if( aJob.mDeadline )
+            {
+                UpdateTime now = UpdateScheduler::now();
+                wait = std::min( wait, (unsigned long)( aJob.mDeadline > now ? aJob.mDeadline - now : 0 ) );
+            }
+
+            bool running = progress( aJob, wait );
+            aJob.outputReceived();
+            if( !running )
+                break;
+        }
+    }
+
+    lock();
+    complete( aJob );
+    unlock();
+}
+
+void
+ExternalCommandExecutor::waitFor( ExternalCommandJob &aJob )
+{
+    lock();
+    while( !aJob.mDone )
+        wait();
+    unlock();
+}
+
+void
+ExternalCommandExecutor::cancel( ExternalCommandJob &aJob )
+{
+    lock();
+
+    aJob.mCancelled = true;
+
+    std::deque<ExternalCommandJob *>::iterator iter = std::find( mQueue.begin(), mQueue.end(), &aJob );
+    if( iter != mQueue.end() )
+    {
+        mQueue.erase( iter );
+        aJob.mErrorCode = ECANCELED;
+        complete( aJob );
+    }
+    else if( !aJob.mDone && !aJob.mStarting && aJob.mKillStage < 2 )
+    {
+        aJob.mCommand.kill( SIGKILL );
+        aJob.mKillStage = 2;
+        aJob.mDeadline = 0;
+        if( 0 == aJob.mErrorCode )
+            aJob.mErrorCode = ECANCELED;
+        wakeup();
+    }
+
+    while( !aJob.mDone )
+        wait();
+
+    unlock();
+}
+
+bool
+ExternalCommandExecutor::isDone( ExternalCommandJob &aJob )
+{
+    lock();
+    bool rc = aJob.mDone;
+    unlock();
+
+    return rc;
+}
+
+void
+ExternalCommandExecutor::loop()
+{
+    lock();
+
+    while( mRunning || !mActive.empty() || !mQueue.empty() )
+    {
+        UpdateTime now = UpdateScheduler::now();
+
+        if( !mRunning )
+        {
+            // shutting down - drop waiting jobs and kill running commands
+            while( !mQueue.empty() )
+            {
+                ExternalCommandJob *job = mQueue.front();
+                mQueue.pop_front();
+                job->mErrorCode = ECANCELED;
+                complete( *job );
+            }
+
+            for( std::vector<ExternalCommandJob *>::iterator i = mActive.begin(); i != mActive.end(); ++i )
+            {
+                if( (*i)->mKillStage < 2 )
+                {
+                    (*i)->mCommand.kill( SIGKILL );
+                    (*i)->mKillStage = 2;
+                    (*i)->mDeadline = now + (*i)->mKillGrace;
+                    if( 0 == (*i)->mErrorCode )
+                        (*i)->mErrorCode = ECANCELED;
+                }
+            }
+        }
+
+        while( ( mActive.size() < mConcurrency ) && !mQueue.empty() )
+        {
+            ExternalCommandJob *job = mQueue.front();
+            mQueue.pop_front();
+
+            // vfork() and exec of the command mustn't block the other users of the executor
+            job->mStarting = true;
+            unlock();
+            bool launched = launch( *job, now );
+            lock();
+            job->mStarting = false;
+
+            if( !launched )
+            {
+                complete( *job );
+                continue;
+            }
+
+            if( job->mCancelled )
+            {
+                // cancel() didn't touch the command while it has been started
+                job->mCommand.kill( SIGKILL );
+                job->mKillStage = 2;
+                job->mDeadline = UpdateScheduler::now() + job->mKillGrace;
+                job->mErrorCode = ECANCELED;
+            }
+            mActive.push_back( job );
+        }
+
+        // each running command contributes stdout, stderr and pidfd - closed ones are -1 and ignored by poll()
+        long timeout = -1;
+        mPollFds.resize( 1 + 3 * mActive.size() );
+        mPollFds[0].fd = mWakeupPipe[0];
+        mPollFds[0].events = POLLIN;
+        for( size_t i = 0; i < mActive.size(); ++i )
+        {
+            ExternalCommandJob const &job = *mActive[i];
+            struct pollfd *fds = &mPollFds[1 + 3 * i];
+
+            fds[0].fd = job.mCommand.getOutFileno();
+            fds[1].fd = job.mCommand.getErrFileno();
+            fds[2].fd = job.mPidFd;
+            fds[0].events = fds[1].events = fds[2].events = POLLIN;
+
+            bool reapByTimer = ( job.mPidFd < 0 ) && ( job.mCommand.getChildPid() > 0 );
+            if( reapByTimer && ( timeout < 0 || (unsigned long)timeout > ReapInterval ) )
+                timeout = ReapInterval;
+            if( job.mDeadline )
+            {
+                long remaining = job.mDeadline > now ? (long)( std::min( job.mDeadline - now, (UpdateTime)INT_MAX ) ) : 0;
+                if( timeout < 0 || remaining < timeout )
+                    timeout = remaining;
+            }
+        }
+        for( size_t i = 0; i < mPollFds.size(); ++i )
+            mPollFds[i].revents = 0;
+
+        unlock();
+        int ready = ::poll( &mPollFds[0], mPollFds.size(), (int)timeout );
+        lock();
+
+        if( ready > 0 && ( mPollFds[0].revents & POLLIN ) )
+        {
+            char buf[64];
+            while( read( mWakeupPipe[0], buf, sizeof(buf) ) > 0 )
+                (void)0;
+        }
+
+        // mActive is only modified by this thread - the poll set still matches
+        now = UpdateScheduler::now();
+        for( size_t i = 0, k = 0; i < mActive.size(); ++k )
+        {
+            ExternalCommandJob &job = *mActive[i];
+            struct pollfd const *fds = &mPollFds[1 + 3 * k];
+
+            if( ( fds[0].revents | fds[1].revents | fds[2].revents ) != 0 || ( job.mPidFd < 0 && job.mCommand.getChildPid() > 0 ) ||
+                job.mKillStage != 0 || ( job.mDeadline && now >= job.mDeadline ) )
+            {
+                bool running = progress( job, 0 );
+
+                // a job is only completed by this thread, so it stays valid while unlocked
+                unlock();
+                job.outputReceived();
+                lock();
+
+                if( !running )
+                {
+                    mActive.erase( mActive.begin() + i );
+                    complete( job );
+                    continue;
+                }
+            }
+
+            ++i;
+        }
+    }
+
+    unlock();
+}
+
+bool
+ExternalCommandExecutor::launch( ExternalCommandJob &aJob, UpdateTime aNow )
+{
+    aJob.mErrorCode = aJob.mCommand.start();
+    if( 0 != aJob.mErrorCode )
+        return false;
+
+    aJob.mLaunched = true;
+    if( aJob.mTimeout )
+        aJob.mDeadline = aNow + aJob.mTimeout;
+
+#if defined(HAVE_SYS_SYSCALL_H) && defined(SYS_pidfd_open)
+    aJob.mPidFd = syscall( SYS_pidfd_open, aJob.mCommand.getChildPid(), 0 );
+#endif
+
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
+    LOG("ExternalCommandExecutor::launch(): started (pid) (timeout) (pidfd)");
+    LOG(aJob.mCommand.getChildPid());
+    LOG(aJob.mTimeout);
+    LOG(aJob.mPidFd);
+    LOG_END;
+
+    return true;
+}
+
+bool
+ExternalCommandExecutor::progress( ExternalCommandJob &aJob, unsigned long aWait )
+{
+    bool running = aJob.mCommand.pollMs( aWait );
+    UpdateTime now = UpdateScheduler::now();
+
+    if( ( aJob.mPidFd >= 0 ) && ( aJob.mCommand.getChildPid() < 0 ) )
+    {
+        // reaped - a readable pidfd would wake up poll() until the output pipes are closed
+        close( aJob.mPidFd );
+        aJob.mPidFd = -1;
+    }
+
+    if( running && aJob.mDeadline && ( now >= aJob.mDeadline ) && ( aJob.mCommand.getChildPid() < 0 ) )
+    {
+        // the command has exited, but its output pipes are held open (e.g. by a background child)
+        LOG_BEGIN(loggerModuleName, WARNING_LOG | 2);
+        LOG("ExternalCommandExecutor::progress(): time limit exceeded - closing output pipes of exited command");
+        LOG_END;
+
+        aJob.mCommand.closeOutput();
+        aJob.mDeadline = 0;
+        if( 0 == aJob.mErrorCode )
+            aJob.mErrorCode = ETIMEDOUT;
+        running = false;
+    }
+    else if( running && aJob.mDeadline && ( now >= aJob.mDeadline ) )
+    {
+        LOG_BEGIN(loggerModuleName, WARNING_LOG | 2);
+        LOG("ExternalCommandExecutor::progress(): time limit exceeded - killing (pid) (signal)");
+        LOG(aJob.mCommand.getChildPid());
+        LOG(0 == aJob.mKillStage ? "SIGTERM" : "SIGKILL");
+        LOG_END;
+
+        if( 0 == aJob.mKillStage )
+        {
+            aJob.mCommand.kill( SIGTERM );
+            aJob.mKillStage = 1;
+            aJob.mDeadline = now + aJob.mKillGrace;
+            aJob.mErrorCode = ETIMEDOUT;
+        }
+        else
+        {
+            aJob.mCommand.kill( SIGKILL );
+            aJob.mKillStage = 2;
+            // pipes inherited by children of the command are closed after another grace period
+            aJob.mDeadline = now + aJob.mKillGrace;
+        }
+    }
+
+    return running;
+}
+
+void
+ExternalCommandExecutor::complete( ExternalCommandJob &aJob )
+{
+    if( aJob.mPidFd >= 0 )
+    {
+        close( aJob.mPidFd );
+        aJob.mPidFd = -1;
+    }
+
+    if( !aJob.mCancelled )
+        aJob.finished();
+    aJob.mDone = true;
+    notify_all();
+}
+
+void
+ExternalCommandExecutor::wakeup()
+{
+    if( mWakeupPipe[1] < 0 )
+        return;
+
+    ssize_t written;
+    do
+    {
+        written = write( mWakeupPipe[1], "", 1 );
+    } while( written < 0 && EINTR == errno );
+
+    // a full pipe (EAGAIN) already holds a pending wakeup
+    if( written < 0 && EAGAIN != errno && EWOULDBLOCK != errno )
+    {
+        LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+        LOG("ExternalCommandExecutor::wakeup(): writing to wakeup pipe failed (error)");
+        LOG(errno);
+        LOG_END;
+    }
+}
+
+}
@@ -22,6 +22,7 @@
 #include <smart-snmpd/mibmodule.h>
 
 #include <smart-snmpd/mibs/extcmd/datasourceextcmd.h>
+#include <smart-snmpd/mibs/extcmd/extcmdexecutor.h>
 
 #include <agent_pp/snmp_textual_conventions.h>
 
@@ -75,6 +76,14 @@ bool
 ExtCmdMibModule::InitModule(void)
 {
     mDataSources.clear();
+
+    if( !ExternalCommandExecutor::getInstance().start( Config::getInstance().getExternalCommandConcurrency() ) )
+    {
+        LOG_BEGIN(loggerModuleName, ERROR_LOG | 0);
+        LOG("ExtCmdMibModule::InitModule(): failed to start external command executor - commands are run serially");
+        LOG_END;
+    }
+
     return true;
 }
 
@@ -89,6 +98,8 @@ ExtCmdMibModule::ShutdownModule(void)
 
     mDataSources.clear();
 
+    ExternalCommandExecutor::getInstance().stop(); // after the data sources cancelled their commands
+
     delete this;
 
     return true;
@@ -101,6 +112,8 @@ ExtCmdMibModule::RefreshConfig(NS_AGENT Mib &mainMibCtrl)
     map<string, MibObjectConfig> mibConfigs = Config::getInstance().getMibObjectConfigs();
     map<Oidx, DataSourceExternalCommand *> toDelete;
 
+    ExternalCommandExecutor::getInstance().setConcurrency( Config::getInstance().getExternalCommandConcurrency() );
+
     for( map<Oidx, DataSourceExternalCommand *>::iterator iter = mDataSources.begin();
          iter != mDataSources.end();
          ++iter )
@@ -0,0 +1,284 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/mibs/extcmd/parseextbinary.h>
+
+namespace SmartSnmpd
+{
+
+static const char * const loggerModuleName = "smartsnmpd.parseextbinary";
+
+static const unsigned char binary_signature[4] = { 'S', 'S', 'B', 1 };
+static const unsigned char delta_signature[4] = { 'S', 'S', 'D', 1 };
+
+//! maximum length of octet string values
+static const uint32_t max_octets = 65535;
+
+static inline uint32_t
+get_u32( const unsigned char *p )
+{
+    return ( (uint32_t)(p[0]) << 24 ) | ( (uint32_t)(p[1]) << 16 ) | ( (uint32_t)(p[2]) << 8 ) | (uint32_t)(p[3]);
+}
+
+#define LOG_PARSE_EXT_BINARY_ERROR(msg,value) \
+        LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 ); \
+        LOG( msg ); \
+        LOG( value ); \
+        LOG_END
+
+ParseExternalBinary::ParseExternalBinary()
+    : ParseExternalOutput()
+    , mParserState(pebHeader)
+    , mPending()
+    , mNeeded(0)
+{}
+
+ParseExternalBinary::~ParseExternalBinary()
+{}
+
+int
+ParseExternalBinary::begin()
+{
+    mParserState = pebHeader;
+    mPending.clear();
+    mNeeded = 0;
+    mData.clear();
+    mFailed = false;
+    mDelta = false;
+
+    return 0;
+}
+
+int
+ParseExternalBinary::feed(const char *data, size_t length)
+{
+    if( mFailed )
+        return -1;
+
+    const unsigned char *p = (const unsigned char *)data;
+
+    // complete a record split over chunks - only the missing bytes are copied
+    while( !mPending.empty() && ( length > 0 ) )
+    {
+        size_t take = mNeeded - mPending.size();
+        if( take > length )
+            take = length;
+        mPending.append( (const char *)p, take );
+        p += take;
+        length -= take;
+
+        if( mPending.size() < mNeeded )
+            return 0;
+
+        size_t used = decode( (const unsigned char *)mPending.data(), mPending.size(), mNeeded );
+        if( mFailed )
+            return -1;
+        if( used )
+            mPending.clear(); // mNeeded bytes are never exceeded, so the record is consumed completely
+    }
+
+    while( length > 0 )
+    {
+        size_t used = decode( p, length, mNeeded );
+        if( mFailed )
+            return -1;
+        if( 0 == used )
+        {
+            mPending.assign( (const char *)p, length );
+            break;
+        }
+
+        p += used;
+        length -= used;
+    }
+
+    return 0;
+}
+
+int
+ParseExternalBinary::end()
+{
+    if( mFailed )
+        return -1;
+
+    if( ( pebDone != mParserState ) || !mPending.empty() )
+    {
+        LOG_PARSE_EXT_BINARY_ERROR( "ParseExternalBinary::end(): incomplete binary output (pending bytes)", mPending.size() );
+
+        mFailed = true;
+        return -1;
+    }
+
+    return 0;
+}
+
+size_t
+ParseExternalBinary::decode(const unsigned char *data, size_t length, size_t &needed)
+{
+    if( pebHeader == mParserState )
+    {
+        needed = sizeof(binary_signature);
+        if( length < needed )
+            return 0;
+
+        mDelta = ( 0 == memcmp( data, delta_signature, sizeof(delta_signature) ) );
+        if( !mDelta && ( 0 != memcmp( data, binary_signature, sizeof(binary_signature) ) ) )
+        {
+            LOG_PARSE_EXT_BINARY_ERROR( "ParseExternalBinary::decode(): invalid signature (first byte)", (unsigned)(data[0]) );
+            mFailed = true;
+            return 0;
+        }
+
+        mParserState = pebRecords;
+        return needed;
+    }
+
+    if( pebDone == mParserState )
+    {
+        LOG_PARSE_EXT_BINARY_ERROR( "ParseExternalBinary::decode(): data after end of document (bytes)", length );
+        mFailed = true;
+        return 0;
+    }
+
+    needed = 1;
+    if( length < needed )
+        return 0;
+
+    unsigned n = data[0];
+    if( 0 == n )
+    {
+        mParserState = pebDone;
+        return 1;
+    }
+
+    if( n > MAX_OID_LEN )
+    {
+        LOG_PARSE_EXT_BINARY_ERROR( "ParseExternalBinary::decode(): too many sub-identifiers (count)", n );
+        mFailed = true;
+        return 0;
+    }
+
+    needed = 1 + 4 * n + 1;
+    if( length < needed )
+        return 0;
+
+    SmiUINT32 syntax = data[needed - 1];
+    switch( syntax )
+    {
+    case ASN_INTEGER:
+    case SMI_COUNTER:
+    case SMI_GAUGE:
+    case SMI_TIMETICKS:
+    case SMI_UINTEGER:
+    case SMI_IPADDRESS:
+    case ASN_OCTET_STR:
+    case SMI_OPAQUE:
+        needed += 4;
+        break;
+
+    case SMI_COUNTER64:
+        needed += 8;
+        break;
+
+    case ASN_NULL:
+        break;
+
+    default:
+        LOG_PARSE_EXT_BINARY_ERROR( "ParseExternalBinary::decode(): unsupported (syntax)", syntax );
+        mFailed = true;
+        return 0;
+    }
+
+    if( length < needed )
+        return 0;
+
+    const unsigned char *value = data + 1 + 4 * n + 1;
+    if( ( ASN_OCTET_STR == syntax ) || ( SMI_OPAQUE == syntax ) )
+    {
+        uint32_t octets = get_u32( value );
+        if( octets > max_octets )
+        {
+            LOG_PARSE_EXT_BINARY_ERROR( "ParseExternalBinary::decode(): octet string too long (length)", (unsigned long)octets );
+            mFailed = true;
+            return 0;
+        }
+
+        needed += octets;
+        if( length < needed )
+            return 0;
+    }
+
+    // record complete
+    unsigned long subids[MAX_OID_LEN];
+    for( unsigned i = 0; i < n; ++i )
+        subids[i] = get_u32( data + 1 + 4 * i );
+
+    mData.resize( mData.size() + 1 );
+    ExternalDataTuple &edt = mData.back();
+    edt.Oid.set_data( subids, n );
+
+    switch( syntax )
+    {
+    case ASN_INTEGER:
+        edt.Datum = new SnmpInt32( (int32_t)get_u32( value ) );
+        break;
+
+    case SMI_COUNTER:
+        edt.Datum = new Counter32( get_u32( value ) );
+        break;
+
+    case SMI_GAUGE:
+        edt.Datum = new Gauge32( get_u32( value ) );
+        break;
+
+    case SMI_TIMETICKS:
+        edt.Datum = new TimeTicks( get_u32( value ) );
+        break;
+
+    case SMI_UINTEGER:
+        edt.Datum = new SnmpUInt32( get_u32( value ) );
+        break;
+
+    case SMI_COUNTER64:
+        edt.Datum = new Counter64( get_u32( value ), get_u32( value + 4 ) );
+        break;
+
+    case SMI_IPADDRESS:
+        {
+            char buf[16];
+            snprintf( buf, sizeof(buf), "%u.%u.%u.%u", value[0], value[1], value[2], value[3] );
+            edt.Datum = new IpAddress( buf );
+        }
+        break;
+
+    case ASN_OCTET_STR:
+        edt.Datum = new OctetStr( value + 4, get_u32( value ) );
+        break;
+
+    case SMI_OPAQUE:
+        edt.Datum = new OpaqueStr( value + 4, get_u32( value ) );
+        break;
+
+    case ASN_NULL:
+        break; // removed oid
+    }
+
+    return needed;
+}
+
+}
@@ -17,6 +17,7 @@
 #include <build-smart-snmpd.h>
 
 #include <smart-snmpd/mibs/extcmd/parseextjson.h>
+#include <smart-snmpd/mibs/extcmd/parsedecimal.h>
 #include <typeinfo>
 
 namespace SmartSnmpd
@@ -41,6 +42,16 @@ static const char* json_errors[] =
     "JSON_ERROR_CALLBACK"
 };
 
+static const char *pej_states[] =
+{
+    "pejInitial",
+    "pejListEntered",
+    "pejTupleEntered",
+    "pejOidParsed",
+    "pejTypeParsed",
+    "pejDatumParsed"
+};
+
 #define LOG_JSON_ERROR(prefix,rc) \
         LOG_BEGIN(loggerModuleName, ERROR_LOG | 1); \
         LOG(prefix " (error)"); \
@@ -51,10 +62,10 @@ static const char* json_errors[] =
         LOG_END
 
 ParseExternalJson::ParseExternalJson()
-    : mParserState(pejInitial)
+    : ParseExternalOutput()
+    , mParserState(pejInitial)
     , mJsonParser()
     , mSyntax(0)
-    , mData()
 {
     memset( &mJsonParser, 0, sizeof(mJsonParser) );
     int rc = json_parser_init(&mJsonParser, NULL, parser_callback, this);
@@ -76,28 +87,67 @@ ParseExternalJson::~ParseExternalJson()
 }
 
 int
-ParseExternalJson::parse(string const &buf)
+ParseExternalJson::begin()
 {
     if( mJsonParser.callback )
     {
-        mData.clear();
-        size_t length = buf.size();
-        size_t processed = 0;
-        while( length > 0 )
+        // the parser keeps its state after a document - start from scratch
+        json_parser_free(&mJsonParser);
+        memset( &mJsonParser, 0, sizeof(mJsonParser) );
+    }
+
+    int rc = json_parser_init(&mJsonParser, NULL, parser_callback, this);
+    if( rc )
+    {
+        LOG_JSON_ERROR("ParseExternalJson::begin(): Can't initialize parser",rc);
+        mJsonParser.callback = NULL;
+    }
+
+    mParserState = pejInitial;
+    mData.clear();
+    mFailed = ( 0 != rc );
+    mDelta = false;
+
+    return mFailed ? -1 : 0;
+}
+
+int
+ParseExternalJson::feed(const char *data, size_t length)
+{
+    if( mFailed || !mJsonParser.callback )
+        return -1;
+
+    while( length > 0 )
+    {
+        uint32_t p;
+        int rc = json_parser_string( &mJsonParser, data, length > UINT32_MAX ? UINT32_MAX : (uint32_t)length, &p );
+        if( rc )
         {
-            uint32_t p;
-            int rc = json_parser_string( &mJsonParser, buf.c_str() + processed, length > UINT32_MAX ? UINT32_MAX : (uint32_t)length, &p );
-            if( rc )
-            {
-                LOG_JSON_ERROR("Error parsing json output:",rc);
-                return -1;
-            }
-            processed += p;
-            length -= p;
+            LOG_JSON_ERROR("Error parsing json output:",rc);
+            mFailed = true;
+            return -1;
         }
+        data += p;
+        length -= p;
     }
-    else
+
+    return 0;
+}
+
+int
+ParseExternalJson::end()
+{
+    if( mFailed || !mJsonParser.callback )
+        return -1;
+
+    if( !json_parser_is_done( &mJsonParser ) || ( pejInitial != mParserState ) )
     {
+        LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+        LOG("ParseExternalJson::end(): incomplete json output (state)");
+        LOG( pej_states[mParserState] );
+        LOG_END;
+
+        mFailed = true;
         return -1;
     }
 
@@ -119,16 +169,6 @@ static const char *json_parser_types[] =
     "JSON_FALSE"
 };
 
-static const char *pej_states[] =
-{
-    "pejInitial",
-    "pejListEntered",
-    "pejTupleEntered",
-    "pejOidParsed",
-    "pejTypeParsed",
-    "pejDatumParsed"
-};
-
 #define LOG_PARSE_EXT_JSON_ERROR(type) \
         LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 ); \
         LOG("ParseExternalJson::parse_item(): unexpected (json item) encountered in (state)"); \
@@ -149,62 +189,103 @@ static const char *pej_states[] =
         LOG( mSyntax ); \
         LOG_END
 
+#define LOG_PARSE_NUMBER_ERROR(func,what,data,length) \
+        { \
+            string s( data, length ); \
+            LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 ); \
+            LOG( func "(): invalid " what " (data)" ); \
+            LOG( s.c_str() ); \
+            LOG_END; \
+        }
+
 static int
-parse_i32_from_json(const char *data, uint32_t length) throw()
+parse_i32_from_json(const char *data, uint32_t length)
 {
-    int i;
-    char *buf = (char *)alloca( sizeof(char) * (length+1) );
-    memcpy(buf, data, length);
-    buf[length] = 0;
-    if( 1 != sscanf( buf, "%d", &i ) )
+    bool negative = ( length > 0 ) && ( '-' == *data );
+    uint64_t u;
+    if( !parse_decimal( data + ( negative ? 1 : 0 ), data + length, u ) ||
+        ( u > ( negative ? 2147483648ULL : 2147483647ULL ) ) )
     {
-        LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
-        LOG( "parse_i32_from_json(): invalid integer (data)" );
-        LOG( buf );
-        LOG_END;
+        LOG_PARSE_NUMBER_ERROR( "parse_i32_from_json", "integer", data, length );
         throw bad_cast();
     }
-    return i;
+
+    return negative ? (int)( 0 - u ) : (int)u;
 }
 
 static unsigned int
-parse_u32_from_json(const char *data, uint32_t length) throw()
+parse_u32_from_json(const char *data, uint32_t length)
 {
-    unsigned int u;
-    char *buf = (char *)alloca( sizeof(char) * (length+1) );
-    memcpy(buf, data, length);
-    buf[length] = 0;
-    if( 1 != sscanf( buf, "%u", &u ) )
+    uint64_t u;
+    if( !parse_decimal( data, data + length, u ) || ( u > 0xFFFFFFFFULL ) )
     {
-        LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
-        LOG( "parse_u32_from_json(): invalid unsigned integer (data)" );
-        LOG( buf );
-        LOG_END;
+        LOG_PARSE_NUMBER_ERROR( "parse_u32_from_json", "unsigned integer", data, length );
         throw bad_cast();
     }
 
-    return u;
+    return (unsigned int)u;
 }
 
 static uint64_t
-parse_u64_from_json(const char *data, uint32_t length) throw()
+parse_u64_from_json(const char *data, uint32_t length)
 {
-#define U64T_SCANF_FMT (sizeof(uint64_t) == sizeof(unsigned long) ? "%lu" : "%llu" )
-    uint64_t u64;
-    char *buf = (char *)alloca( sizeof(char) * (length+1) );
-    memcpy(buf, data, length);
-    buf[length] = 0;
-    if( 1 != sscanf( buf, U64T_SCANF_FMT, &u64 ) )
+    uint64_t u;
+    if( !parse_decimal( data, data + length, u ) )
     {
-        LOG_BEGIN(loggerModuleName,  ERROR_LOG | 1 );
-        LOG( "parse_u64_from_json(): invalid uint64 (data)" );
-        LOG( buf );
-        LOG_END;
+        LOG_PARSE_NUMBER_ERROR( "parse_u64_from_json", "uint64", data, length );
         throw bad_cast();
     }
 
-    return u64;
-#undef U64T_SCANF_FMT
+    return u;
+}
+
+/**
+ * parses a dotted oid from a json slice
+ *
+ * The sub-identifiers are written into a buffer on the stack and handed
+ * to the oid at once.
+ *
+ * @param data - begin of the oid string (optionally starting with a dot)
+ * @param length - length of the oid string
+ * @param oid - receives the oid
+ *
+ * @return bool - true on success, false for malformed oids
+ */
+static bool
+parse_oid_from_json(const char *data, uint32_t length, Oidx &oid)
+{
+    unsigned long subids[MAX_OID_LEN];
+    unsigned long n = 0;
+    const char *p = data, *e = data + length;
+    bool valid = true;
+
+    if( ( p < e ) && ( '.' == *p ) )
+        ++p;
+
+    while( valid )
+    {
+        const char *dot = (const char *)memchr( p, '.', e - p );
+        const char *end = dot ? dot : e;
+        uint64_t subid;
+
+        valid = ( n < MAX_OID_LEN ) && parse_decimal( p, end, subid ) && ( subid <= 0xFFFFFFFFULL );
+        if( valid )
+            subids[n++] = (unsigned long)subid;
+
+        if( !dot )
+            break;
+        p = dot + 1;
+    }
+
+    if( !valid )
+    {
+        LOG_PARSE_NUMBER_ERROR( "parse_oid_from_json", "oid", data, length );
+        return false;
+    }
+
+    oid.set_data( subids, n );
+
+    return true;
 }
 
 int
@@ -238,6 +319,16 @@ ParseExternalJson::parse_item(int type, const char *data, uint32_t length)
             mParserState = pejInitial;
             break;
 
+        case JSON_STRING:
+            // marker of differential documents - allowed as first element only
+            if( mData.empty() && !mDelta && ( 5 == length ) && ( 0 == memcmp( data, "delta", 5 ) ) )
+            {
+                mDelta = true;
+                break;
+            }
+            LOG_PARSE_EXT_JSON_ERROR(type);
+            return JSON_ERROR_CALLBACK;
+
         default:
             LOG_PARSE_EXT_JSON_ERROR(type);
             return JSON_ERROR_CALLBACK;
@@ -248,10 +339,8 @@ ParseExternalJson::parse_item(int type, const char *data, uint32_t length)
         switch (type)
         {
         case JSON_STRING:
-            { // g++ throws "crosses initialization of ‘std::string s’" otherwise
-                string s(data, length);
-                mData.back().Oid = s.c_str(); // XXX missing Oid::Oid(const char *s, size_t len, bool is_dotted = true );
-            }
+            if( !parse_oid_from_json( data, length, mData.back().Oid ) )
+                return JSON_ERROR_CALLBACK;
             mParserState = pejOidParsed;
             break;
 
@@ -267,7 +356,7 @@ ParseExternalJson::parse_item(int type, const char *data, uint32_t length)
         case JSON_INT:
             try
             {
-                mSyntax = parse_i32_from_json(data, type);
+                mSyntax = parse_i32_from_json(data, length);
                 mParserState = pejTypeParsed;
             }
             catch( bad_cast )
@@ -457,6 +546,16 @@ ParseExternalJson::parse_item(int type, const char *data, uint32_t length)
 
                 break;
 
+            case ASN_NULL:
+                // removed oid - no value
+                if( JSON_NULL != type )
+                {
+                    LOG_PARSE_BAD_TYPE_ERROR(type);
+                    return JSON_ERROR_CALLBACK;
+                }
+
+                break;
+
             default:
                 LOG_PARSE_BAD_TYPE_ERROR(type);
                 return JSON_ERROR_CALLBACK;
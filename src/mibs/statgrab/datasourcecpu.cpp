@@ -30,11 +30,9 @@ namespace SmartSnmpd
 
 static const char * const loggerModuleName = "smartsnmpd.datasource.cpu";
 
-sg_cpu_stats
-calc_diff<sg_cpu_stats>::operator () (sg_cpu_stats const &aComperator, sg_cpu_stats const &aMostRecent) const
+void
+calc_diff<sg_cpu_stats>::operator () (sg_cpu_stats const &aComperator, sg_cpu_stats const &aMostRecent, sg_cpu_stats &result) const
 {
-    sg_cpu_stats result;
-
     result.user = aMostRecent.user - aComperator.user;
     result.kernel = aMostRecent.kernel - aComperator.kernel;
     result.idle = aMostRecent.idle - aComperator.idle;
@@ -51,8 +49,6 @@ calc_diff<sg_cpu_stats>::operator () (sg_cpu_stats const &aComperator, sg_cpu_st
     result.soft_interrupts  = aMostRecent.soft_interrupts - aComperator.soft_interrupts;
 
     result.systime = aMostRecent.systime - aComperator.systime;
-
-    return result;
 }
 
 static DataSourceCPU *instance = NULL;
@@ -159,6 +155,7 @@ DataSourceCPU::checkMibObjConfig( Mib &mainMibCtrl )
 
     if( mMibObj )
     {
+        ThreadSynchronize guard(*this); // the history is resized
         setupHistory(*mMibObj);
 #if 0
         bool needInterval = mMibObj->getConfig().MostRecentIntervalTime != 0;
@@ -251,7 +248,7 @@ DataSourceCPU::updateMibObj()
     if( mMibObj->getConfig().MostRecentIntervalTime )
     {
         sg_cpu_stats const &cpu_diff = diff( *cpu_stats );
-        smCpuMib.setIntervalCpuStats( cpu_stats->systime - cpu_diff.systime, cpu_stats->systime, cpu_diff );
+        smCpuMib.setIntervalCpuStats( getDiffFrom(), getDiffUntil(), cpu_diff );
     }
 
     smCpuMib.setUpdateTimestamp( cpu_stats->systime );
@@ -220,6 +220,12 @@ DataSourceDaemonStatus::updateMibObj()
                        handled_requests += MibIIsnmpCounters::inSetRequests();
     smDaemonMib.setHandledRequests( handled_requests );
 
+    std::vector< std::pair<std::string, UpdateJobStatus> > jobs;
+    UpdateScheduler::getInstance().getJobStatuses( jobs );
+    UpdateTime now = UpdateScheduler::now();
+    for( std::vector< std::pair<std::string, UpdateJobStatus> >::const_iterator iter = jobs.begin(); iter != jobs.end(); ++iter )
+        smDaemonMib.addUpdateJob( iter->first, iter->second, now );
+
     smDaemonMib.setUpdateTimestamp( curProcessStats->systime );
 
     mMibObj->commitContentUpdate();
@@ -29,11 +29,34 @@ namespace SmartSnmpd
 
 static const char * const loggerModuleName = "smartsnmpd.datasource.diskio";
 
-sg_disk_io_stats *
-calc_diff<sg_disk_io_stats *>::operator () (sg_disk_io_stats * const &aComperator, sg_disk_io_stats * const &aMostRecent) const
+void
+calc_diff<sg_disk_io_stats *>::operator () (sg_disk_io_stats * const &aComperator, sg_disk_io_stats * const &aMostRecent, result_type &result) const
 {
-    sg_disk_io_stats *result = sg_get_disk_io_stats_diff_between( aMostRecent, aComperator, NULL );
-    return result;
+    size_t recentEntries = sg_get_nelements( aMostRecent );
+    size_t comperatorEntries = sg_get_nelements( aComperator );
+
+    result.clear(); // keeps the capacity
+    for( size_t i = 0; i < recentEntries; ++i )
+    {
+        sg_disk_io_stats const &recent = aMostRecent[i];
+        result.push_back( recent );
+        if( !recent.disk_name )
+            continue;
+
+        // disks usually keep their position - check the same slot first
+        for( size_t n = 0; n < comperatorEntries; ++n )
+        {
+            sg_disk_io_stats const &comperator = aComperator[( i + n ) % comperatorEntries];
+            if( comperator.disk_name && ( 0 == strcmp( comperator.disk_name, recent.disk_name ) ) )
+            {
+                sg_disk_io_stats &diskDiff = result.back();
+                diskDiff.read_bytes = recent.read_bytes - comperator.read_bytes;
+                diskDiff.write_bytes = recent.write_bytes - comperator.write_bytes;
+                diskDiff.systime = recent.systime - comperator.systime;
+                break;
+            }
+        }
+    }
 }
 
 /**
@@ -150,6 +173,7 @@ DataSourceDiskIO::checkMibObjConfig( Mib &mainMibCtrl )
 
     if( mMibObj )
     {
+        ThreadSynchronize guard(*this); // the history is resized
         setupHistory(*mMibObj);
 #if 0
         bool needInterval = mMibObj->getConfig().MostRecentIntervalTime != 0;
@@ -208,14 +232,11 @@ DataSourceDiskIO::updateMibObj()
 
     if( mMibObj->getConfig().MostRecentIntervalTime )
     {
-        sg_disk_io_stats * disk_io_diff = diff( disk_io_stats );
-        size_t diff_entries = sg_get_nelements( disk_io_diff );
-        time_t from = 0;
+        std::vector<sg_disk_io_stats> const &disk_io_diff = diff( disk_io_stats );
 
-        for( size_t i = 0; i < diff_entries; ++i )
+        for( size_t i = 0; i < disk_io_diff.size(); ++i )
         {
             smDiskIoMib.addIntervalRow( disk_io_diff[i] );
-            from = now - disk_io_diff[i].systime;
         }
 
         LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
@@ -223,7 +244,7 @@ DataSourceDiskIO::updateMibObj()
         LOG(entries);
         LOG_END;
 
-        smDiskIoMib.setIntervalSpec( from, now );
+        smDiskIoMib.setIntervalSpec( getDiffFrom(), getDiffUntil() );
     }
 
     smDiskIoMib.setCount( entries );
@@ -24,6 +24,8 @@
 
 #include <agent_pp/snmp_textual_conventions.h>
 
+#include <algorithm>
+
 namespace SmartSnmpd
 {
 
@@ -31,6 +33,15 @@ static const char * const loggerModuleName = "smartsnmpd.datasource.filesystem";
 
 static DataSourceFileSystem *instance = NULL;
 
+// orders file systems by the key of their stable row index
+struct FileSystemByRowKey
+{
+    bool operator () ( sg_fs_stats const *a, sg_fs_stats const *b ) const
+    {
+        return SmartSnmpdFilesystemMib::rowKey( *a ) < SmartSnmpdFilesystemMib::rowKey( *b );
+    }
+};
+
 DataSourceFileSystem &
 DataSourceFileSystem::getInstance()
 {
@@ -186,20 +197,34 @@ DataSourceFileSystem::updateMibObj()
     MibObject::ContentManagerType &cntMgr = mMibObj->beginContentUpdate();
     cntMgr.clear();
 
-    SmartSnmpdFilesystemMib smFsMib( cntMgr );
+    SmartSnmpdFilesystemMib smFsMib( cntMgr, mMibObj->getConfig().RowIndex, mMibObj->getConfig().Columns );
+
+    mRowFilter.configure( mMibObj->getConfig().RowFilter );
 
+    std::vector<sg_fs_stats const *> fsList;
+    fsList.reserve( entries );
     for( size_t i = 0; i < entries; ++i )
     {
-        smFsMib.addRow( fs_stats[i] );
         lastUpdated = fs_stats[i].systime;
+        if( mRowFilter.matchFilesystem( fs_stats[i] ) )
+            fsList.push_back( &fs_stats[i] );
     }
 
+    // colliding keys get the same indices whatever order the mounts are listed in
+    if( mMibObj->getConfig().RowIndex == rowIndexStable )
+        std::sort( fsList.begin(), fsList.end(), FileSystemByRowKey() );
+
+    size_t rows = fsList.size();
+    for( size_t i = 0; i < rows; ++i )
+        smFsMib.addRow( *fsList[i] );
+
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
-    LOG("DataSourceFileSystem::updateMibObj: added (entries) rows to total stats()");
+    LOG("DataSourceFileSystem::updateMibObj: added (rows) of (entries) file systems to total stats()");
+    LOG(rows);
     LOG(entries);
     LOG_END;
 
-    smFsMib.setCount( entries );
+    smFsMib.setCount( rows );
     smFsMib.setUpdateTimestamp( lastUpdated );
 
     mMibObj->commitContentUpdate();
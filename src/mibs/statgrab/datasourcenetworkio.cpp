@@ -19,21 +19,80 @@
 #include <smart-snmpd/oids.h>
 #include <smart-snmpd/mibs/statgrab/datasourcenetworkio.h>
 #include <smart-snmpd/mibs/statgrab/mibnetworkio.h>
+#include <smart-snmpd/updatescheduler.h>
 
 #include <statgrab.h>
 
 #include <agent_pp/snmp_textual_conventions.h>
 
+#include <algorithm>
+
+#include <string.h>
+
 namespace SmartSnmpd
 {
 
 static const char * const loggerModuleName = "smartsnmpd.datasource.networkio";
 
-sg_network_io_stats *
-calc_diff<sg_network_io_stats *>::operator () (sg_network_io_stats * const &aComperator, sg_network_io_stats * const &aMostRecent) const
+struct NetworkIoByName
+{
+    bool operator () ( sg_network_io_stats const *a, sg_network_io_stats const *b ) const
+    {
+        return strcmp( a->interface_name ? a->interface_name : "", b->interface_name ? b->interface_name : "" ) < 0;
+    }
+};
+
+/**
+ * lists the interface statistics in the order their rows are added:
+ * ordered by name for stable row indices, so interfaces without kernel
+ * interface index (indexed by a hash of their name) get the same indices
+ * whatever order they're listed in
+ */
+static void
+order_rows( sg_network_io_stats const *stats, size_t entries, bool byName, std::vector<sg_network_io_stats const *> &rows )
 {
-    sg_network_io_stats *result = sg_get_network_io_stats_diff_between( aMostRecent, aComperator, NULL );
-    return result;
+    rows.clear();
+    rows.reserve( entries );
+    for( size_t i = 0; i < entries; ++i )
+        rows.push_back( &stats[i] );
+
+    if( byName )
+        std::sort( rows.begin(), rows.end(), NetworkIoByName() );
+}
+
+void
+calc_diff<sg_network_io_stats *>::operator () (sg_network_io_stats * const &aComperator, sg_network_io_stats * const &aMostRecent, result_type &result) const
+{
+    size_t recentEntries = sg_get_nelements( aMostRecent );
+    size_t comperatorEntries = sg_get_nelements( aComperator );
+
+    result.clear(); // keeps the capacity
+    for( size_t i = 0; i < recentEntries; ++i )
+    {
+        sg_network_io_stats const &recent = aMostRecent[i];
+        result.push_back( recent );
+        if( !recent.interface_name )
+            continue;
+
+        // interfaces usually keep their position - check the same slot first
+        for( size_t n = 0; n < comperatorEntries; ++n )
+        {
+            sg_network_io_stats const &comperator = aComperator[( i + n ) % comperatorEntries];
+            if( comperator.interface_name && ( 0 == strcmp( comperator.interface_name, recent.interface_name ) ) )
+            {
+                sg_network_io_stats &networkDiff = result.back();
+                networkDiff.tx = recent.tx - comperator.tx;
+                networkDiff.rx = recent.rx - comperator.rx;
+                networkDiff.ipackets = recent.ipackets - comperator.ipackets;
+                networkDiff.opackets = recent.opackets - comperator.opackets;
+                networkDiff.ierrors = recent.ierrors - comperator.ierrors;
+                networkDiff.oerrors = recent.oerrors - comperator.oerrors;
+                networkDiff.collisions = recent.collisions - comperator.collisions;
+                networkDiff.systime = recent.systime - comperator.systime;
+                break;
+            }
+        }
+    }
 }
 
 /**
@@ -157,7 +216,9 @@ DataSourceNetworkIO::checkMibObjConfig( Mib &mainMibCtrl )
 
     if( mMibObj )
     {
+        ThreadSynchronize guard(*this); // the history is resized
         setupHistory(*mMibObj);
+        mInterfaceRates.clear(); // set up with the new windows on next update
 #if 0
         bool needInterval = mMibObj->getConfig().MostRecentIntervalTime != 0;
 
@@ -264,12 +325,15 @@ DataSourceNetworkIO::updateMibObj()
     MibObject::ContentManagerType &cntMgr = mMibObj->beginContentUpdate();
     cntMgr.clear();
 
-    SmartSnmpdNetworkIoMib smNetworkIoMib( cntMgr );
+    SmartSnmpdNetworkIoMib smNetworkIoMib( cntMgr, mMibObj->getConfig().RowIndex, mMibObj->getConfig().Columns );
+    bool const byName = ( mMibObj->getConfig().RowIndex == rowIndexStable );
+    std::vector<sg_network_io_stats const *> rows;
 
-    for( size_t i = 0; i < entries; ++i )
+    order_rows( network_io_stats, entries, byName, rows );
+    for( size_t i = 0; i < rows.size(); ++i )
     {
-        smNetworkIoMib.addTotalRow( network_io_stats[i] );
-        now = network_io_stats[i].systime;
+        smNetworkIoMib.addTotalRow( *rows[i] );
+        now = rows[i]->systime;
     }
 
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
@@ -279,14 +343,12 @@ DataSourceNetworkIO::updateMibObj()
 
     if( mMibObj->getConfig().MostRecentIntervalTime )
     {
-        sg_network_io_stats * network_io_diff = diff( network_io_stats );
-        size_t diff_entries = sg_get_nelements( network_io_diff );
-        time_t from = 0;
+        std::vector<sg_network_io_stats> const &network_io_diff = diff( network_io_stats );
 
-        for( size_t i = 0; i < diff_entries; ++i )
+        order_rows( network_io_diff.empty() ? NULL : &network_io_diff[0], network_io_diff.size(), byName, rows );
+        for( size_t i = 0; i < rows.size(); ++i )
         {
-            smNetworkIoMib.addIntervalRow( network_io_diff[i] );
-            from = now - network_io_diff[i].systime;
+            smNetworkIoMib.addIntervalRow( *rows[i] );
         }
 
         LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
@@ -294,9 +356,12 @@ DataSourceNetworkIO::updateMibObj()
         LOG(entries);
         LOG_END;
 
-        smNetworkIoMib.setIntervalSpec( from, now );
+        smNetworkIoMib.setIntervalSpec( getDiffFrom(), getDiffUntil() );
     }
 
+    if( !mMibObj->getConfig().RateWindows.empty() )
+        updateRates( network_io_stats, entries, smNetworkIoMib );
+
     smNetworkIoMib.setCount( entries );
     smNetworkIoMib.setUpdateTimestamp( now );
 
@@ -306,4 +371,71 @@ DataSourceNetworkIO::updateMibObj()
     return true;
 }
 
+void
+DataSourceNetworkIO::updateRates( sg_network_io_stats const *networkIoStats, size_t entries, NetworkIoMib &networkIoMib )
+{
+    MibObjectConfig const &mibObjCfg = mMibObj->getConfig();
+    UpdateTime now = UpdateScheduler::now();
+
+    for( std::vector<InterfaceRates>::iterator iter = mInterfaceRates.begin(); iter != mInterfaceRates.end(); ++iter )
+        iter->Seen = false;
+
+    for( size_t i = 0; i < entries; ++i )
+    {
+        sg_network_io_stats const &networkIo = networkIoStats[i];
+        if( !networkIo.interface_name )
+            continue;
+
+        std::vector<InterfaceRates>::iterator iter = mInterfaceRates.begin();
+        while( ( iter != mInterfaceRates.end() ) && ( iter->Name != networkIo.interface_name ) )
+            ++iter;
+
+        if( iter == mInterfaceRates.end() )
+        {
+            // first update of this interface - nothing to calculate a rate from
+            mInterfaceRates.push_back( InterfaceRates() );
+            InterfaceRates &rates = mInterfaceRates.back();
+            rates.Name = networkIo.interface_name;
+            rates.LastTx = networkIo.tx;
+            rates.LastRx = networkIo.rx;
+            rates.LastUpdate = now;
+            rates.Seen = true;
+            rates.Tx.setup( mibObjCfg.CacheTime, mibObjCfg.RateWindows, mibObjCfg.RatePercentile );
+            rates.Rx.setup( mibObjCfg.CacheTime, mibObjCfg.RateWindows, mibObjCfg.RatePercentile );
+            continue;
+        }
+
+        // counters going backwards have been reset - restart from the current values
+        if( ( now > iter->LastUpdate ) && ( networkIo.tx >= iter->LastTx ) && ( networkIo.rx >= iter->LastRx ) )
+        {
+            UpdateTime elapsed = now - iter->LastUpdate;
+            iter->Tx.add( ( networkIo.tx - iter->LastTx ) * 1000 / elapsed, now );
+            iter->Rx.add( ( networkIo.rx - iter->LastRx ) * 1000 / elapsed, now );
+        }
+
+        iter->LastTx = networkIo.tx;
+        iter->LastRx = networkIo.rx;
+        iter->LastUpdate = now;
+        iter->Seen = true;
+    }
+
+    for( std::vector<InterfaceRates>::iterator iter = mInterfaceRates.begin(); iter != mInterfaceRates.end(); )
+    {
+        if( !iter->Seen )
+        {
+            iter = mInterfaceRates.erase( iter );
+            continue;
+        }
+
+        RateHistory::Summary tx, rx;
+        for( size_t w = 0; w < iter->Tx.getWindowCount(); ++w )
+        {
+            if( iter->Tx.summarize( w, tx ) && iter->Rx.summarize( w, rx ) )
+                networkIoMib.addRateRow( iter->Name.c_str(), iter->Tx.getWindow( w ), tx, rx );
+        }
+
+        ++iter;
+    }
+}
+
 }
@@ -17,11 +17,14 @@
 #include <build-smart-snmpd.h>
 
 #include <smart-snmpd/oids.h>
+#include <smart-snmpd/config.h>
 #include <smart-snmpd/mibs/statgrab/datasourceprocess.h>
 #include <smart-snmpd/mibs/statgrab/mibprocess.h>
 
 #include <agent_pp/snmp_textual_conventions.h>
 
+#include <algorithm>
+
 namespace SmartSnmpd
 {
 
@@ -29,6 +32,8 @@ static const char * const loggerModuleName = "smartsnmpd.datasource.process";
 
 static DataSourceProcess *instance = NULL;
 
+const std::vector<unsigned long>::size_type DataSourceProcess::noRow;
+
 DataSourceProcess &
 DataSourceProcess::getInstance()
 {
@@ -52,6 +57,158 @@ DataSourceProcess::destroyInstance()
     delete ptr;
 }
 
+void
+DataSourceProcess::updateProcessRow( MibObject::ContentManagerType::TableType &rows, sg_process_stats const &proc, MibObjectConfig const &cfg )
+{
+    std::map<pid_t, ProcessCacheEntry>::iterator iter = mProcessCache.find( proc.pid );
+    bool known = ( iter != mProcessCache.end() ) && ( iter->second.StartTime == proc.start_time );
+
+    if( iter == mProcessCache.end() )
+    {
+        iter = mProcessCache.insert( std::make_pair( proc.pid, ProcessCacheEntry() ) ).first;
+        iter->second.RowPos = noRow;
+    }
+
+    ProcessCacheEntry &entry = iter->second;
+
+    // columns 11, 13, 15, 17 and 19 of smProcessTable
+    if( ( !known || ( entry.Uid != proc.uid ) ) && cfg.isColumnEnabled( 11 ) )
+        entry.Details.UserName = mSysUserInfo.getusernamebyuid( proc.uid );
+    if( ( !known || ( entry.Gid != proc.gid ) ) && cfg.isColumnEnabled( 13 ) )
+        entry.Details.GroupName = mSysUserInfo.getgroupnamebygid( proc.gid );
+    if( ( !known || ( entry.EffectiveUid != proc.euid ) ) && cfg.isColumnEnabled( 15 ) )
+        entry.Details.EffectiveUserName = mSysUserInfo.getusernamebyuid( proc.euid );
+    if( ( !known || ( entry.EffectiveGid != proc.egid ) ) && cfg.isColumnEnabled( 17 ) )
+        entry.Details.EffectiveGroupName = mSysUserInfo.getgroupnamebygid( proc.egid );
+    if( ( !known || ( entry.CpuPercent != proc.cpu_percent ) ) && cfg.isColumnEnabled( 19 ) )
+        entry.Details.CpuPercent = SmartSnmpdProcessMib::fmtPercent( proc.cpu_percent );
+
+    entry.StartTime = proc.start_time;
+    entry.Uid = proc.uid;
+    entry.Gid = proc.gid;
+    entry.EffectiveUid = proc.euid;
+    entry.EffectiveGid = proc.egid;
+    entry.CpuPercent = proc.cpu_percent;
+    entry.Generation = mGeneration;
+
+    if( entry.RowPos == noRow )
+    {
+        // appeared since the previous refresh (or passes the filter again)
+        MibObject::ContentManagerType::TableType::RowType row = rows.addRow( (unsigned long)(proc.pid) );
+        SmartSnmpdProcessMib::setRowColumns( row, proc, entry.Details );
+        entry.RowPos = row.getRowPosition();
+    }
+    else
+    {
+        // a reused process id keeps its row, all values differ anyway
+        MibObject::ContentManagerType::TableType::RowType row = rows.updateRow( entry.RowPos );
+        SmartSnmpdProcessMib::setRowColumns( row, proc, entry.Details );
+    }
+}
+
+// orders by descending usage, equal usage by process id to keep the ranking stable
+struct ProcessByCpuPercent
+{
+    bool operator () ( sg_process_stats const *a, sg_process_stats const *b ) const
+    {
+        return ( a->cpu_percent != b->cpu_percent ) ? ( a->cpu_percent > b->cpu_percent ) : ( a->pid < b->pid );
+    }
+};
+
+struct ProcessByResident
+{
+    bool operator () ( sg_process_stats const *a, sg_process_stats const *b ) const
+    {
+        return ( a->proc_resident != b->proc_resident ) ? ( a->proc_resident > b->proc_resident ) : ( a->pid < b->pid );
+    }
+};
+
+struct ProcessByCpuTime
+{
+    bool operator () ( sg_process_stats const *a, sg_process_stats const *b ) const
+    {
+        return ( a->time_spent != b->time_spent ) ? ( a->time_spent > b->time_spent ) : ( a->pid < b->pid );
+    }
+};
+
+template <class Compare>
+static size_t
+rank_processes( std::vector<sg_process_stats const *> &ranking, size_t count, Compare cmp )
+{
+    if( ranking.size() > count )
+        std::nth_element( ranking.begin(), ranking.begin() + count, ranking.end(), cmp );
+    else
+        count = ranking.size();
+
+    std::sort( ranking.begin(), ranking.begin() + count, cmp );
+
+    return count;
+}
+
+void
+DataSourceProcess::addTopRows( ProcessMib &processMib, size_t count )
+{
+    for( int list = processTopCpu; list < processTopListCount; ++list )
+    {
+        size_t n;
+
+        mTopRanking.assign( mTopCandidates.begin(), mTopCandidates.end() );
+        switch( list )
+        {
+        case processTopCpu:
+            n = rank_processes( mTopRanking, count, ProcessByCpuPercent() );
+            break;
+        case processTopResident:
+            n = rank_processes( mTopRanking, count, ProcessByResident() );
+            break;
+        default:
+            n = rank_processes( mTopRanking, count, ProcessByCpuTime() );
+            break;
+        }
+
+        for( size_t i = 0; i < n; ++i )
+            processMib.addTopRow( (ProcessTopList)list, *mTopRanking[i], mSysUserInfo.getusernamebyuid( mTopRanking[i]->uid ) );
+    }
+
+    // the pointers refer to the statistics of this refresh only
+    mTopCandidates.clear();
+    mTopRanking.clear();
+}
+
+void
+DataSourceProcess::expireProcessCache( MibContainerTableData &rows )
+{
+    std::vector<std::vector<unsigned long>::size_type> removed;
+
+    std::map<pid_t, ProcessCacheEntry>::iterator iter = mProcessCache.begin();
+    while( iter != mProcessCache.end() )
+    {
+        if( iter->second.Generation != mGeneration )
+        {
+            if( iter->second.RowPos != noRow )
+                removed.push_back( iter->second.RowPos );
+            mProcessCache.erase( iter++ );
+        }
+        else
+            ++iter;
+    }
+
+    if( removed.empty() && rows.isSorted() )
+    {
+        rows.compact();
+        return;
+    }
+
+    std::sort( removed.begin(), removed.end() );
+    rows.removeRows( removed );
+    rows.sort(); // rows of new processes might have been appended out of order
+    rows.compact();
+
+    // the rows moved - their index is the process id
+    for( std::vector<unsigned long>::size_type pos = 0; pos < rows.getRowCount(); ++pos )
+        mProcessCache[(pid_t)(rows.getRowIndex( pos ))].RowPos = pos;
+}
+
 #if 0
 static const index_info indProcessTable[1] = {
     {sNMP_SYNTAX_INT, FALSE, 1, 1}
@@ -121,23 +278,73 @@ DataSourceProcess::initMibObj()
 bool
 DataSourceProcess::updateMibObj()
 {
+    StatgrabSettings const &sgs = Config::getInstance().getStatgrabSettings();
+    MibObjectConfig const &cfg = mMibObj->getConfig();
     size_t entries = 0;
-    sg_process_stats *process_stats = sg_get_process_stats_r(&entries);
-    if( !process_stats )
+    sg_process_stats *sg_stats = NULL;
+    sg_process_stats const *process_stats = NULL;
+
+    // the procfs collector keeps state between refreshes
+    ThreadSynchronize guard(*this);
+
+    mRowFilter.configure( cfg.RowFilter );
+
+    if( ( processCollectorProcfs == sgs.ProcessCollector ) && ProcfsProcessCollector::isAvailable() )
     {
-        report_sg_error( "DataSourceProcess::updateMibObj", "sg_get_process_stats() failed" );
+        // read status and cmdline only for the published columns
+        unsigned fields = 0;
+        for( unsigned long col = 10; col <= 17; ++col )
+        {
+            if( cfg.isColumnEnabled( col ) )
+                fields |= ProcfsProcessCollector::fieldCredentials;
+        }
+        if( mRowFilter.hasUserPattern() || sgs.ProcessTopCount )
+            fields |= ProcfsProcessCollector::fieldCredentials;
+        if( cfg.isColumnEnabled( 4 ) )
+            fields |= ProcfsProcessCollector::fieldArguments;
 
-        return false;
+        int rc = mProcfsCollector.collect( fields, sgs.ProcessThreads );
+        if( 0 != rc )
+        {
+            LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+            LOG("DataSourceProcess::updateMibObj: scanning /proc failed (errno)");
+            LOG(rc);
+            LOG_END;
+
+            return false;
+        }
+
+        process_stats = mProcfsCollector.getStats();
+        entries = mProcfsCollector.getCount();
+
+        LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
+        LOG("DataSourceProcess::updateMibObj: ProcfsProcessCollector::collect()");
+        LOG_END;
     }
+    else
+    {
+        if( processCollectorProcfs == sgs.ProcessCollector )
+        {
+            LOG_BEGIN(loggerModuleName, WARNING_LOG | 2);
+            LOG("DataSourceProcess::updateMibObj: /proc can't be scanned on this system, using libstatgrab");
+            LOG_END;
+        }
 
-    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
-    LOG("DataSourceProcess::updateMibObj: sg_get_process_stats()");
-    LOG_END;
+        process_stats = sg_stats = sg_get_process_stats_r(&entries);
+        if( !process_stats )
+        {
+            report_sg_error( "DataSourceProcess::updateMibObj", "sg_get_process_stats() failed" );
+
+            return false;
+        }
+
+        LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
+        LOG("DataSourceProcess::updateMibObj: sg_get_process_stats()");
+        LOG_END;
+    }
 
     sg_process_count proc_counts;
     memset( &proc_counts, 0, sizeof(proc_counts) );
-
-    ThreadSynchronize guard(*this);
 #if 0
     MibTable *procTable = getProcessTable();
     for( size_t i = 0; i < entries; ++i )
@@ -213,13 +420,35 @@ DataSourceProcess::updateMibObj()
     MibObject::ContentManagerType &cntMgr = mMibObj->beginContentUpdate();
     cntMgr.clear();
 
-    SmartSnmpdProcessMib smProcessMib( cntMgr );
+    SmartSnmpdProcessMib smProcessMib( cntMgr, cfg.RowIndex, cfg.Columns );
+
+    MibObject::ContentManagerType::TableType processRows( mProcessRows, SM_PROCESS_TABLE_KEY, 19 );
+    if( !sgs.ProcessDeltaUpdate || ( cfg.Columns != mProcessCacheColumns ) )
+    {
+        // forget everything built during previous refreshes
+        mProcessCache.clear();
+        mProcessRows.clear();
+        processRows.setEnabledColumns( cfg.Columns );
+        mProcessCacheColumns = cfg.Columns;
+    }
+    ++mGeneration;
 
+    size_t rows = 0;
     for( size_t i = 0; i < entries; ++i )
     {
-        smProcessMib.addRow( process_stats[i] );
         now = process_stats[i].systime;
 
+        // the counters cover all processes, the filter applies to the table only
+        if( mRowFilter.matchProcess( process_stats[i] ) &&
+            ( !mRowFilter.hasUserPattern() || mRowFilter.matchUser( mSysUserInfo.getusernamebyuid( process_stats[i].uid ) ) ) )
+        {
+            updateProcessRow( processRows, process_stats[i], cfg );
+            ++rows;
+
+            if( sgs.ProcessTopCount )
+                mTopCandidates.push_back( &process_stats[i] );
+        }
+
         ++proc_counts.total;
 
         switch( process_stats[i].state )
@@ -243,7 +472,9 @@ DataSourceProcess::updateMibObj()
     }
 
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 1);
-    LOG("DataSourceProcess::updateMibObj: added (total) (running) (sleeping) (stopped) (zombie) (unknown) rows to total stats");
+    LOG("DataSourceProcess::updateMibObj: updated (rows) of (total) (running) (sleeping) (stopped) (zombie) (unknown) processes");
+    LOG(rows);
+    LOG(proc_counts.total);
     LOG(proc_counts.running);
     LOG(proc_counts.sleeping);
     LOG(proc_counts.stopped);
@@ -251,13 +482,21 @@ DataSourceProcess::updateMibObj()
     LOG(proc_counts.unknown);
     LOG_END;
 
+    // drop the rows of exited processes before they're published
+    expireProcessCache( mProcessRows.getTableData( processRows.getTableEntryOid(), 19 ) );
+    smProcessMib.setRows( processRows );
+
+    if( sgs.ProcessTopCount )
+        addTopRows( smProcessMib, sgs.ProcessTopCount );
+
     smProcessMib.setCounts( proc_counts );
     smProcessMib.setUpdateTimestamp( now );
 
     mMibObj->commitContentUpdate();
 #endif
 
-    sg_free_process_stats( process_stats );
+    if( sg_stats )
+        sg_free_process_stats( sg_stats );
 
     return true;
 }
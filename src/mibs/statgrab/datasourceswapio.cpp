@@ -27,17 +27,13 @@ namespace SmartSnmpd
 
 static const char * const loggerModuleName = "smartsnmpd.datasource.swapio";
 
-sg_page_stats
-calc_diff<sg_page_stats>::operator () (sg_page_stats const &aComperator, sg_page_stats const &aMostRecent) const
+void
+calc_diff<sg_page_stats>::operator () (sg_page_stats const &aComperator, sg_page_stats const &aMostRecent, sg_page_stats &result) const
 {
-    sg_page_stats result;
-
     result.pages_pagein = aMostRecent.pages_pagein - aComperator.pages_pagein;
     result.pages_pageout = aMostRecent.pages_pageout - aComperator.pages_pageout;
 
     result.systime = aMostRecent.systime - aComperator.systime;
-
-    return result;
 }
 
 static DataSourceSwapIO *instance = NULL;
@@ -124,6 +120,7 @@ DataSourceSwapIO::checkMibObjConfig( Mib &mainMibCtrl )
 
     if( mMibObj )
     {
+        ThreadSynchronize guard(*this); // the history is resized
         setupHistory(*mMibObj);
 #if 0
         bool needInterval = mMibObj->getConfig().MostRecentIntervalTime != 0;
@@ -194,7 +191,7 @@ DataSourceSwapIO::updateMibObj()
     if( mMibObj->getConfig().MostRecentIntervalTime )
     {
         sg_page_stats const &page_diff = diff( *page_stats );
-        smPageIoMib.setIntervalSwapIoStats( page_stats->systime - page_diff.systime, page_stats->systime, page_diff );
+        smPageIoMib.setIntervalSwapIoStats( getDiffFrom(), getDiffUntil(), page_diff );
     }
 
     smPageIoMib.setUpdateTimestamp( page_stats->systime );
@@ -159,7 +159,7 @@ DataSourceUserLogin::updateMibObj()
     MibObject::ContentManagerType &cntMgr = mMibObj->beginContentUpdate();
     cntMgr.clear();
 
-    SmartSnmpdUserLoginMib smUserLoginMib( cntMgr );
+    SmartSnmpdUserLoginMib smUserLoginMib( cntMgr, mMibObj->getConfig().Columns );
 
     for( size_t i = 0; i < entries; ++i )
     {
@@ -0,0 +1,469 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/mibs/statgrab/procfsprocess.h>
+#include <smart-snmpd/log.h>
+
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#if defined(__linux__) && defined(HAVE_OPENAT) && defined(HAVE_FDOPENDIR)
+# define WITH_PROCFS_COLLECTOR 1
+#endif
+
+#ifndef O_CLOEXEC
+# define O_CLOEXEC 0
+#endif
+
+namespace SmartSnmpd
+{
+
+static const char * const loggerModuleName = "smartsnmpd.datasource.process.procfs";
+
+/**
+ * minimum number of processes worth an own scan thread
+ */
+static const size_t MIN_PIDS_PER_THREAD = 512;
+
+/**
+ * scans a slice of the process ids, executed by one thread
+ */
+struct ProcfsScanJob
+{
+    ProcfsScanJob()
+        : ProcFd(-1)
+        , Fields(0)
+        , BootTime(0)
+        , Now(0)
+        , ClockTicks(100)
+        , PageSize(4096)
+        , Pids(NULL)
+        , Count(0)
+        , Buffer(4096)
+        , Stats()
+        , Names()
+        , Titles()
+    {}
+
+    int ProcFd;
+    unsigned Fields;
+    time_t BootTime;
+    time_t Now;
+    long ClockTicks;
+    long PageSize;
+    pid_t const *Pids;
+    size_t Count;
+    //! read buffer, grows to the largest file read
+    std::vector<char> Buffer;
+    std::vector<sg_process_stats> Stats;
+    //! storage of the strings referenced by Stats
+    std::vector<std::string> Names;
+    std::vector<std::string> Titles;
+
+    void run();
+    bool scan( pid_t pid, sg_process_stats &proc, std::string &name, std::string &title );
+};
+
+#ifdef WITH_PROCFS_COLLECTOR
+/**
+ * reads a file below /proc completely into buf
+ *
+ * @param dirfd - file descriptor of /proc
+ * @param path - path relative to /proc
+ * @param buf - buffer, enlarged when the file doesn't fit, NUL terminated on success
+ *
+ * @return ssize_t - number of bytes read, -1 on error (errno is set)
+ */
+static ssize_t
+read_proc_file( int dirfd, char const *path, std::vector<char> &buf )
+{
+    int fd = openat( dirfd, path, O_RDONLY | O_CLOEXEC );
+    if( fd < 0 )
+        return -1;
+
+    size_t len = 0;
+    for(;;)
+    {
+        if( len + 1 >= buf.size() )
+            buf.resize( buf.size() * 2 );
+
+        ssize_t n = read( fd, &buf[len], buf.size() - len - 1 );
+        if( n < 0 )
+        {
+            if( EINTR == errno )
+                continue;
+
+            int errno_code = errno;
+            close( fd );
+            errno = errno_code;
+            return -1;
+        }
+        if( 0 == n )
+            break;
+
+        len += n;
+    }
+
+    close( fd );
+    buf[len] = '\0';
+
+    return len;
+}
+
+static sg_process_state
+map_process_state( char state )
+{
+    switch( state )
+    {
+    case 'R':
+        return SG_PROCESS_STATE_RUNNING;
+    case 'S':
+    case 'D':
+        return SG_PROCESS_STATE_SLEEPING;
+    case 'T':
+        return SG_PROCESS_STATE_STOPPED;
+    case 'Z':
+        return SG_PROCESS_STATE_ZOMBIE;
+    default:
+        return SG_PROCESS_STATE_UNKNOWN;
+    }
+}
+
+/**
+ * parses the real and effective id of a "Uid:" or "Gid:" line of /proc/<pid>/status
+ *
+ * @return bool - true when the line has been found
+ */
+static bool
+parse_status_ids( char const *status, char const *tag, unsigned long &real, unsigned long &effective )
+{
+    char const *line = strstr( status, tag );
+    if( !line )
+        return false;
+
+    char *end;
+    real = strtoul( line + strlen( tag ), &end, 10 );
+    effective = strtoul( end, &end, 10 );
+
+    return true;
+}
+
+bool
+ProcfsScanJob::scan( pid_t pid, sg_process_stats &proc, std::string &name, std::string &title )
+{
+    char path[32];
+
+    snprintf( path, sizeof(path), "%d/stat", (int)pid );
+    if( read_proc_file( ProcFd, path, Buffer ) <= 0 )
+        return false;
+
+    // the command name may contain blanks and parentheses
+    char *buf = &Buffer[0];
+    char *lpar = strchr( buf, '(' );
+    char *rpar = strrchr( buf, ')' );
+    if( !lpar || !rpar || ( rpar < lpar ) || ( ' ' != rpar[1] ) )
+        return false;
+
+    name.assign( lpar + 1, rpar );
+
+    // fields[i] is field i + 3 of proc(5), from state up to rss
+    static const size_t nfields = 22;
+    char *fields[nfields];
+    size_t n = 0;
+    char *p = rpar + 2;
+    while( ( n < nfields ) && *p )
+    {
+        fields[n++] = p;
+        while( *p && ( ' ' != *p ) )
+            ++p;
+        if( *p )
+            *p++ = '\0';
+    }
+    if( n < nfields )
+        return false;
+
+    unsigned long long utime = strtoull( fields[11], NULL, 10 );
+    unsigned long long stime = strtoull( fields[12], NULL, 10 );
+    unsigned long long starttime = strtoull( fields[19], NULL, 10 );
+
+    memset( &proc, 0, sizeof(proc) );
+    proc.pid = pid;
+    proc.state = map_process_state( fields[0][0] );
+    proc.parent = strtol( fields[1], NULL, 10 );
+    proc.pgid = strtol( fields[2], NULL, 10 );
+    proc.sessid = strtol( fields[3], NULL, 10 );
+    proc.nice = strtol( fields[16], NULL, 10 );
+    proc.proc_size = strtoull( fields[20], NULL, 10 );
+    proc.proc_resident = strtoull( fields[21], NULL, 10 ) * PageSize;
+    proc.start_time = BootTime + (time_t)( starttime / ClockTicks );
+    proc.time_spent = (time_t)( ( utime + stime ) / ClockTicks );
+    proc.systime = Now;
+
+    // average over the lifetime of the process, like libstatgrab does on Linux
+    if( Now > proc.start_time )
+        proc.cpu_percent = 100.0 * (double)( utime + stime ) / ClockTicks / (double)( Now - proc.start_time );
+
+    if( Fields & ProcfsProcessCollector::fieldCredentials )
+    {
+        snprintf( path, sizeof(path), "%d/status", (int)pid );
+        if( read_proc_file( ProcFd, path, Buffer ) <= 0 )
+            return false;
+
+        unsigned long real, effective;
+        if( parse_status_ids( &Buffer[0], "\nUid:", real, effective ) )
+        {
+            proc.uid = real;
+            proc.euid = effective;
+        }
+        if( parse_status_ids( &Buffer[0], "\nGid:", real, effective ) )
+        {
+            proc.gid = real;
+            proc.egid = effective;
+        }
+    }
+
+    title.clear();
+    if( Fields & ProcfsProcessCollector::fieldArguments )
+    {
+        snprintf( path, sizeof(path), "%d/cmdline", (int)pid );
+        ssize_t len = read_proc_file( ProcFd, path, Buffer );
+        if( len < 0 )
+            return false;
+
+        // arguments are separated by NUL characters
+        while( ( len > 0 ) && ( ( '\0' == Buffer[len - 1] ) || ( ' ' == Buffer[len - 1] ) ) )
+            --len;
+        for( ssize_t i = 0; i < len; ++i )
+        {
+            if( '\0' == Buffer[i] )
+                Buffer[i] = ' ';
+        }
+        title.assign( &Buffer[0], len );
+    }
+
+    return true;
+}
+
+void
+ProcfsScanJob::run()
+{
+    Stats.resize( Count );
+    if( Names.size() < Count )
+    {
+        Names.resize( Count );
+        Titles.resize( Count );
+    }
+
+    size_t found = 0;
+    for( size_t i = 0; i < Count; ++i )
+    {
+        // processes exiting during the scan are skipped
+        if( scan( Pids[i], Stats[found], Names[found], Titles[found] ) )
+            ++found;
+    }
+    Stats.resize( found );
+
+    for( size_t i = 0; i < found; ++i )
+    {
+        Stats[i].process_name = const_cast<char *>( Names[i].c_str() );
+        Stats[i].proctitle = const_cast<char *>( Titles[i].c_str() );
+    }
+}
+
+static void *
+procfs_scan_thread( void *arg )
+{
+    static_cast<ProcfsScanJob *>(arg)->run();
+    return NULL;
+}
+#endif
+
+ProcfsProcessCollector::ProcfsProcessCollector()
+    : mProcFd(-1)
+    , mBootTime(0)
+    , mPids()
+    , mJobs()
+    , mStats()
+{}
+
+ProcfsProcessCollector::~ProcfsProcessCollector()
+{
+    for( std::vector<ProcfsScanJob *>::iterator iter = mJobs.begin(); iter != mJobs.end(); ++iter )
+        delete *iter;
+
+    if( mProcFd >= 0 )
+        close( mProcFd );
+}
+
+bool
+ProcfsProcessCollector::isAvailable()
+{
+#ifdef WITH_PROCFS_COLLECTOR
+    return 0 == access( "/proc/self/stat", R_OK );
+#else
+    return false;
+#endif
+}
+
+int
+ProcfsProcessCollector::readPids()
+{
+#ifdef WITH_PROCFS_COLLECTOR
+    // fdopendir() takes the descriptor, keep mProcFd for openat()
+    int fd = openat( mProcFd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    if( fd < 0 )
+        return errno;
+
+    DIR *dir = fdopendir( fd );
+    if( !dir )
+    {
+        int errno_code = errno;
+        close( fd );
+        return errno_code;
+    }
+
+    mPids.clear();
+    struct dirent *entry;
+    while( NULL != ( entry = readdir( dir ) ) )
+    {
+        if( isdigit( (unsigned char)(entry->d_name[0]) ) )
+            mPids.push_back( (pid_t)strtol( entry->d_name, NULL, 10 ) );
+    }
+
+    closedir( dir );
+
+    return 0;
+#else
+    return ENOSYS;
+#endif
+}
+
+int
+ProcfsProcessCollector::collect( unsigned fields, unsigned threads )
+{
+    mStats.clear();
+
+#ifdef WITH_PROCFS_COLLECTOR
+    if( mProcFd < 0 )
+    {
+        mProcFd = open( "/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+        if( mProcFd < 0 )
+            return errno;
+    }
+
+    if( mJobs.empty() )
+        mJobs.push_back( new ProcfsScanJob() );
+
+    if( 0 == mBootTime )
+    {
+        std::vector<char> &buf = mJobs[0]->Buffer;
+        char const *btime;
+        if( ( read_proc_file( mProcFd, "stat", buf ) <= 0 ) || ( NULL == ( btime = strstr( &buf[0], "\nbtime " ) ) ) )
+        {
+            LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
+            LOG( "ProcfsProcessCollector::collect(): can't determine boot time from /proc/stat" );
+            LOG_END;
+
+            return ENOENT;
+        }
+        mBootTime = (time_t)strtoul( btime + 7, NULL, 10 );
+    }
+
+    int rc = readPids();
+    if( 0 != rc )
+        return rc;
+
+    // don't start threads which would scan a handful of processes only
+    size_t slices = threads ? threads : 1;
+    if( slices > mPids.size() / MIN_PIDS_PER_THREAD )
+        slices = mPids.size() / MIN_PIDS_PER_THREAD;
+    if( 0 == slices )
+        slices = 1;
+
+    while( mJobs.size() < slices )
+        mJobs.push_back( new ProcfsScanJob() );
+
+    time_t now = time(NULL);
+    long clockTicks = sysconf( _SC_CLK_TCK );
+    long pageSize = sysconf( _SC_PAGESIZE );
+    size_t sliceSize = ( mPids.size() + slices - 1 ) / slices;
+    std::vector<pthread_t> tids( slices );
+    std::vector<bool> started( slices, false );
+
+    for( size_t i = 0; i < slices; ++i )
+    {
+        ProcfsScanJob &job = *mJobs[i];
+        size_t first = std::min( i * sliceSize, mPids.size() );
+
+        job.ProcFd = mProcFd;
+        job.Fields = fields;
+        job.BootTime = mBootTime;
+        job.Now = now;
+        job.ClockTicks = clockTicks > 0 ? clockTicks : 100;
+        job.PageSize = pageSize > 0 ? pageSize : 4096;
+        job.Pids = mPids.empty() ? NULL : &mPids[first];
+        job.Count = std::min( sliceSize, mPids.size() - first );
+
+        // the first slice is scanned by the calling thread
+        if( i > 0 )
+            started[i] = ( 0 == pthread_create( &tids[i], NULL, &procfs_scan_thread, &job ) );
+    }
+
+    mJobs[0]->run();
+
+    size_t total = 0;
+    for( size_t i = 0; i < slices; ++i )
+    {
+        if( started[i] )
+            pthread_join( tids[i], NULL );
+        else if( i > 0 )
+            mJobs[i]->run();
+
+        total += mJobs[i]->Stats.size();
+    }
+
+    mStats.reserve( total );
+    for( size_t i = 0; i < slices; ++i )
+        mStats.insert( mStats.end(), mJobs[i]->Stats.begin(), mJobs[i]->Stats.end() );
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 1 );
+    LOG( "ProcfsProcessCollector::collect(): (pids) (processes) (threads)" );
+    LOG( mPids.size() );
+    LOG( mStats.size() );
+    LOG( slices );
+    LOG_END;
+
+    return 0;
+#else
+    (void)fields;
+    (void)threads;
+
+    return ENOSYS;
+#endif
+}
+
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/mibs/statgrab/rowfilter.h>
+#include <smart-snmpd/log.h>
+
+#include <string.h>
+
+namespace SmartSnmpd
+{
+
+static const char * const loggerModuleName = "smartsnmpd.datasource.rowfilter";
+
+RowFilter::RowFilter()
+    : mConfig()
+    , mName()
+    , mUser()
+    , mHasName(false)
+    , mHasUser(false)
+    , mStates(0)
+{}
+
+RowFilter::~RowFilter()
+{
+    release();
+}
+
+void
+RowFilter::release()
+{
+    if( mHasName )
+        regfree( &mName );
+    if( mHasUser )
+        regfree( &mUser );
+
+    mHasName = mHasUser = false;
+}
+
+bool
+RowFilter::compile( regex_t &re, std::string const &pattern )
+{
+    if( pattern.empty() )
+        return false;
+
+    int rc = regcomp( &re, pattern.c_str(), REG_EXTENDED | REG_NOSUB );
+    if( 0 != rc )
+    {
+        char errbuf[256];
+        regerror( rc, &re, errbuf, sizeof(errbuf) );
+
+        // the configuration has been validated, so this is hardly reached
+        LOG_BEGIN( loggerModuleName, ERROR_LOG | 1 );
+        LOG( "RowFilter::compile(): (pattern) (error) - pattern ignored" );
+        LOG( pattern.c_str() );
+        LOG( errbuf );
+        LOG_END;
+
+        return false;
+    }
+
+    return true;
+}
+
+void
+RowFilter::configure( RowFilterConfig const &cfg )
+{
+    if( cfg == mConfig )
+        return;
+
+    release();
+    mConfig = cfg;
+
+    mHasName = compile( mName, mConfig.Name );
+    mHasUser = compile( mUser, mConfig.User );
+
+    static struct { char const *Name; sg_process_state State; } const states[] = {
+        { "running", SG_PROCESS_STATE_RUNNING },
+        { "sleeping", SG_PROCESS_STATE_SLEEPING },
+        { "stopped", SG_PROCESS_STATE_STOPPED },
+        { "zombie", SG_PROCESS_STATE_ZOMBIE },
+        { "unknown", SG_PROCESS_STATE_UNKNOWN }
+    };
+
+    mStates = 0;
+    for( vector<string>::const_iterator iter = mConfig.States.begin(); iter != mConfig.States.end(); ++iter )
+    {
+        for( size_t i = 0; i < sizeof(states) / sizeof(states[0]); ++i )
+        {
+            if( *iter == states[i].Name )
+                mStates |= 1U << states[i].State;
+        }
+    }
+}
+
+bool
+RowFilter::matchProcess( sg_process_stats const &proc ) const
+{
+    // cheap criteria first
+    if( mStates && !( mStates & ( 1U << proc.state ) ) )
+        return false;
+    if( proc.proc_resident < mConfig.MinResident )
+        return false;
+    if( proc.cpu_percent < mConfig.MinCpuPercent )
+        return false;
+    if( mHasName && ( !proc.process_name || ( 0 != regexec( &mName, proc.process_name, 0, NULL, 0 ) ) ) )
+        return false;
+
+    return true;
+}
+
+bool
+RowFilter::matchUser( std::string const &userName ) const
+{
+    return !mHasUser || ( 0 == regexec( &mUser, userName.c_str(), 0, NULL, 0 ) );
+}
+
+bool
+RowFilter::matchFilesystem( sg_fs_stats const &fs ) const
+{
+    if( !mConfig.FsTypes.empty() )
+    {
+        if( !fs.fs_type )
+            return false;
+
+        vector<string>::const_iterator iter = mConfig.FsTypes.begin();
+        while( ( iter != mConfig.FsTypes.end() ) && ( *iter != fs.fs_type ) )
+            ++iter;
+        if( iter == mConfig.FsTypes.end() )
+            return false;
+    }
+
+    if( !mConfig.MountPrefixes.empty() )
+    {
+        if( !fs.mnt_point )
+            return false;
+
+        for( vector<string>::const_iterator iter = mConfig.MountPrefixes.begin(); iter != mConfig.MountPrefixes.end(); ++iter )
+        {
+            // "/data" matches "/data" and "/data/x" but not "/database"
+            size_t len = iter->length();
+            if( ( 0 == strncmp( fs.mnt_point, iter->c_str(), len ) ) &&
+                ( ( '\0' == fs.mnt_point[len] ) || ( '/' == fs.mnt_point[len] ) || ( len && ( '/' == (*iter)[len - 1] ) ) ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -26,8 +26,76 @@ namespace SmartSnmpd
 static const char * const loggerModuleName = "smartsnmpd.mibutils.mibcontainer";
 
 const Oidx MibContainerTable::TableEntryKey = SM_TABLE_ENTRY_KEY;
+const unsigned long MibContainerTable::HashedRowBase;
 
-Oidx MibContainer::find_succ(Oidx const &o, Request *)
+MibContainer & MibContainer::sort()
+{
+    for( TableDataContainerType::iterator i = mTables.begin(); i != mTables.end(); ++i )
+        i->sort();
+
+    if( mSorted )
+        return *this;
+
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 8);
+    LOG("MibContainer::sort: (oid)(entries)");
+    LOG(mBaseOid.get_printable());
+    LOG(mContent.size());
+    LOG_END;
+
+    std::stable_sort( mContent.begin(), mContent.end() );
+
+    // remove duplicates, keep the most recently added entry of each run
+    ContainerType::iterator dst = mContent.begin();
+    for( ContainerType::iterator src = mContent.begin(); src != mContent.end(); ++src )
+    {
+        ContainerType::iterator next = src + 1;
+        if( ( next != mContent.end() ) && !( *src < *next ) )
+            continue;
+
+        if( dst != src )
+            *dst = *src;
+        ++dst;
+    }
+    mContent.erase( dst, mContent.end() );
+
+    mSorted = true;
+
+    return *this;
+}
+
+MibContainer & MibContainer::remove( std::vector<Oidx> const &suffixes )
+{
+    if( suffixes.empty() )
+        return *this;
+
+    sort();
+
+    ContainerType keys;
+    keys.reserve( suffixes.size() );
+    for( std::vector<Oidx>::const_iterator i = suffixes.begin(); i != suffixes.end(); ++i )
+        keys.push_back( Vbx( *i ) );
+    std::sort( keys.begin(), keys.end() );
+
+    // merge both sorted sequences, keep the entries without key
+    ContainerType::const_iterator key = keys.begin();
+    ContainerType::iterator dst = mContent.begin();
+    for( ContainerType::iterator src = mContent.begin(); src != mContent.end(); ++src )
+    {
+        while( ( key != keys.end() ) && ( *key < *src ) )
+            ++key;
+        if( ( key != keys.end() ) && !( *src < *key ) )
+            continue;
+
+        if( dst != src )
+            *dst = *src;
+        ++dst;
+    }
+    mContent.erase( dst, mContent.end() );
+
+    return *this;
+}
+
+Oidx MibContainer::find_succ(Oidx const &o, Request *) const
 {
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 6);
     LOG("MibContainer::find_succ: (oid)(o)");
@@ -36,7 +104,8 @@ Oidx MibContainer::find_succ(Oidx const &o, Request *)
     LOG_END;
 
     Oidx rc;
-    set<Vbx>::const_iterator i;
+    Oidx tmpoid;
+    ContainerType::const_iterator i;
     if( o <= mBaseOid )
     {
         i = mContent.begin();
@@ -45,18 +114,31 @@ Oidx MibContainer::find_succ(Oidx const &o, Request *)
     {
         if( mBaseOid.is_root_of( o ) )
         {
-            Vbx tmpvb( o.cut_left( mBaseOid.len() ) );
-            i = mContent.upper_bound( tmpvb );
+            tmpoid = o.cut_left( mBaseOid.len() );
         }
         else
         {
-            i = mContent.upper_bound( Vbx( o ) );
+            tmpoid = o;
         }
+
+        i = std::upper_bound( mContent.begin(), mContent.end(), Vbx( tmpoid ) );
     }
 
     if( i != mContent.end() )
     {
-        rc = mBaseOid + i->get_oid();
+        rc = i->get_oid();
+    }
+
+    for( TableDataContainerType::const_iterator t = mTables.begin(); t != mTables.end(); ++t )
+    {
+        Oidx tblSucc;
+        if( t->find_succ( tmpoid, tblSucc ) && ( ( rc.len() == 0 ) || ( tblSucc < rc ) ) )
+            rc = tblSucc;
+    }
+
+    if( rc.len() != 0 )
+    {
+        rc = mBaseOid + rc;
     }
 
     LOG_BEGIN(loggerModuleName, DEBUG_LOG | 6);
@@ -68,7 +150,7 @@ Oidx MibContainer::find_succ(Oidx const &o, Request *)
     return rc;
 }
 
-void MibContainer::get_request( Request *aReq, int idx )
+void MibContainer::get_request( Request *aReq, int idx ) const
 {
     Oidx tmpoid;
 
@@ -93,7 +175,22 @@ void MibContainer::get_request( Request *aReq, int idx )
         return;
     }
 
-    set<Vbx>::const_iterator entry = findItem( tmpoid, true );
+    for( TableDataContainerType::const_iterator t = mTables.begin(); t != mTables.end(); ++t )
+    {
+        if( t->getTableEntryOid().is_root_of( tmpoid ) )
+        {
+            Vbx vb( aReq->get_oid(idx) );
+            if( !t->get( tmpoid, vb ) )
+            {
+                vb.set_syntax(sNMP_SYNTAX_NOSUCHINSTANCE);
+            }
+            // error status (v1) will be set by RequestList
+            aReq->finish(idx, vb);
+            return;
+        }
+    }
+
+    ContainerType::const_iterator entry = findItem( tmpoid, true );
     if( entry == mContent.end() )
     {
         Vbx vb( aReq->get_oid(idx) );
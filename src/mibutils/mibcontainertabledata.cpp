@@ -0,0 +1,519 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/log.h>
+#include <smart-snmpd/mibutils/mibcontainertabledata.h>
+
+#include <algorithm>
+
+namespace SmartSnmpd
+{
+
+static const char * const loggerModuleName = "smartsnmpd.mibutils.mibcontainertabledata";
+
+struct row_position_less
+{
+    row_position_less( std::vector<unsigned long> const &aRowIndices )
+        : mRowIndices( aRowIndices )
+    {}
+
+    bool operator () ( std::vector<unsigned long>::size_type a, std::vector<unsigned long>::size_type b ) const
+    {
+        return mRowIndices[a] < mRowIndices[b];
+    }
+
+    std::vector<unsigned long> const &mRowIndices;
+};
+
+MibContainerTableData::MibContainerTableData( MibContainerTableData const &ref )
+    : mTableEntryOid( ref.mTableEntryOid )
+    , mRowIndices( ref.mRowIndices )
+    , mColumns( ref.mColumns )
+    , mColumnEnabled( ref.mColumnEnabled )
+    , mStrings( ref.mStrings )
+    , mForeign()
+    , mSorted( ref.mSorted )
+    , mStringGarbage( ref.mStringGarbage )
+{
+    mForeign.reserve( ref.mForeign.size() );
+    for( std::vector<SnmpSyntax *>::const_iterator i = ref.mForeign.begin(); i != ref.mForeign.end(); ++i )
+        mForeign.push_back( (*i)->clone() );
+}
+
+MibContainerTableData &
+MibContainerTableData::operator = ( MibContainerTableData const &ref )
+{
+    if( this == &ref )
+        return *this;
+
+    clearForeign();
+
+    mTableEntryOid = ref.mTableEntryOid;
+    mRowIndices = ref.mRowIndices;
+    mColumns = ref.mColumns;
+    mColumnEnabled = ref.mColumnEnabled;
+    mStrings = ref.mStrings;
+    mSorted = ref.mSorted;
+    mStringGarbage = ref.mStringGarbage;
+
+    mForeign.reserve( ref.mForeign.size() );
+    for( std::vector<SnmpSyntax *>::const_iterator i = ref.mForeign.begin(); i != ref.mForeign.end(); ++i )
+        mForeign.push_back( (*i)->clone() );
+
+    return *this;
+}
+
+void
+MibContainerTableData::clearForeign()
+{
+    for( std::vector<SnmpSyntax *>::iterator i = mForeign.begin(); i != mForeign.end(); ++i )
+        delete *i;
+    mForeign.clear();
+}
+
+void
+MibContainerTableData::clear()
+{
+    mRowIndices.clear();
+    for( std::vector<ColumnType>::iterator i = mColumns.begin(); i != mColumns.end(); ++i )
+        i->clear();
+    mStrings.clear();
+    clearForeign();
+    mSorted = true;
+    mStringGarbage = 0;
+}
+
+void
+MibContainerTableData::reserve( std::vector<unsigned long>::size_type n )
+{
+    mRowIndices.reserve( n );
+    for( std::vector<ColumnType>::size_type i = 0; i < mColumns.size(); ++i )
+    {
+        if( mColumnEnabled[i] )
+            mColumns[i].reserve( n );
+    }
+}
+
+void
+MibContainerTableData::setEnabledColumns( std::vector<unsigned long> const &aColumns )
+{
+    for( std::vector<ColumnType>::size_type i = 0; i < mColumns.size(); ++i )
+    {
+        mColumnEnabled[i] = aColumns.empty() || std::binary_search( aColumns.begin(), aColumns.end(), (unsigned long)( i + 1 ) );
+        if( mColumnEnabled[i] )
+            mColumns[i].resize( mRowIndices.size() );
+        else
+            ColumnType().swap( mColumns[i] );
+    }
+}
+
+std::vector<unsigned long>::size_type
+MibContainerTableData::appendRow( unsigned long aRowIdx )
+{
+    if( !mRowIndices.empty() && ( mRowIndices.back() >= aRowIdx ) )
+        mSorted = false;
+
+    mRowIndices.push_back( aRowIdx );
+    for( std::vector<ColumnType>::size_type i = 0; i < mColumns.size(); ++i )
+    {
+        if( mColumnEnabled[i] )
+            mColumns[i].push_back( Cell() );
+    }
+
+    return mRowIndices.size() - 1;
+}
+
+MibContainerTableData::Cell &
+MibContainerTableData::cellAt( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx )
+{
+    if( !isColumnEnabled( aColIdx ) )
+        throw std::out_of_range( "MibContainerTableData: invalid or disabled column index" );
+    if( aRowPos >= mRowIndices.size() )
+        throw std::out_of_range( "MibContainerTableData: invalid row position" );
+
+    return mColumns[aColIdx - 1][aRowPos];
+}
+
+bool
+MibContainerTableData::storeCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SmiUINT32 syntax, unsigned long long value, bool onlyChanged )
+{
+    Cell &cell = cellAt( aRowPos, aColIdx );
+    if( onlyChanged && ( cell.Storage == csNumber ) && ( cell.Syntax == syntax ) && ( cell.Value == value ) )
+        return false;
+
+    releaseCell( cell );
+    cell.Storage = csNumber;
+    cell.Syntax = syntax;
+    cell.Length = 0;
+    cell.Value = value;
+
+    return true;
+}
+
+bool
+MibContainerTableData::storeCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, char const *s, unsigned long len, bool onlyChanged )
+{
+    Cell &cell = cellAt( aRowPos, aColIdx );
+    if( onlyChanged && ( cell.Storage == csString ) && ( cell.Length == len ) && ( 0 == mStrings.compare( cell.Value, len, s, len ) ) )
+        return false;
+
+    releaseCell( cell );
+    cell.Storage = csString;
+    cell.Syntax = sNMP_SYNTAX_OCTETS;
+    cell.Length = len;
+    cell.Value = mStrings.size();
+    mStrings.append( s, len );
+
+    return true;
+}
+
+bool
+MibContainerTableData::storeCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SnmpSyntax const &syn, bool onlyChanged )
+{
+    switch( syn.get_syntax() )
+    {
+    case sNMP_SYNTAX_INT32:
+        return storeCell( aRowPos, aColIdx, sNMP_SYNTAX_INT32, (unsigned long long)(long long)(long)( static_cast<SnmpInt32 const &>(syn) ), onlyChanged );
+
+    case sNMP_SYNTAX_UINT32:
+    case sNMP_SYNTAX_CNTR32:
+    case sNMP_SYNTAX_TIMETICKS:
+        return storeCell( aRowPos, aColIdx, syn.get_syntax(), (unsigned long)( static_cast<SnmpUInt32 const &>(syn) ), onlyChanged );
+
+    case sNMP_SYNTAX_CNTR64:
+        {
+            Counter64 const &c64 = static_cast<Counter64 const &>(syn);
+            return storeCell( aRowPos, aColIdx, sNMP_SYNTAX_CNTR64, ( ( (unsigned long long)c64.high() ) << 32 ) | c64.low(), onlyChanged );
+        }
+
+    case sNMP_SYNTAX_OCTETS:
+        {
+            OctetStr const &os = static_cast<OctetStr const &>(syn);
+            return storeCell( aRowPos, aColIdx, reinterpret_cast<char const *>( os.data() ), os.len(), onlyChanged );
+        }
+
+    default:
+        {
+            // foreign values aren't compared - they're rare and kept until clear()
+            Cell &cell = cellAt( aRowPos, aColIdx );
+            releaseCell( cell );
+            cell.Storage = csForeign;
+            cell.Syntax = syn.get_syntax();
+            cell.Length = 0;
+            cell.Value = mForeign.size();
+            mForeign.push_back( syn.clone() );
+        }
+        return true;
+    }
+}
+
+void
+MibContainerTableData::setCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SmiUINT32 syntax, unsigned long long value )
+{
+    (void)storeCell( aRowPos, aColIdx, syntax, value, false );
+}
+
+void
+MibContainerTableData::setCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, char const *s, unsigned long len )
+{
+    (void)storeCell( aRowPos, aColIdx, s, len, false );
+}
+
+void
+MibContainerTableData::setCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SnmpSyntax const &syn )
+{
+    (void)storeCell( aRowPos, aColIdx, syn, false );
+}
+
+void
+MibContainerTableData::setNullCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx )
+{
+    Cell &cell = cellAt( aRowPos, aColIdx );
+    releaseCell( cell );
+    cell.Storage = csNull;
+    cell.Syntax = sNMP_SYNTAX_NULL;
+    cell.Length = 0;
+    cell.Value = 0;
+}
+
+bool
+MibContainerTableData::updateCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SmiUINT32 syntax, unsigned long long value )
+{
+    return storeCell( aRowPos, aColIdx, syntax, value, true );
+}
+
+bool
+MibContainerTableData::updateCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, char const *s, unsigned long len )
+{
+    return storeCell( aRowPos, aColIdx, s, len, true );
+}
+
+bool
+MibContainerTableData::updateCell( std::vector<unsigned long>::size_type aRowPos, unsigned long aColIdx, SnmpSyntax const &syn )
+{
+    return storeCell( aRowPos, aColIdx, syn, true );
+}
+
+void
+MibContainerTableData::removeRows( std::vector<std::vector<unsigned long>::size_type> const &aRowPositions )
+{
+    if( aRowPositions.empty() )
+        return;
+
+    for( std::vector<ColumnType>::iterator col = mColumns.begin(); col != mColumns.end(); ++col )
+    {
+        // disabled columns hold no cells
+        if( col->empty() )
+            continue;
+
+        std::vector<std::vector<unsigned long>::size_type>::const_iterator removed = aRowPositions.begin();
+        std::vector<unsigned long>::size_type dst = 0;
+        for( std::vector<unsigned long>::size_type src = 0; src < col->size(); ++src )
+        {
+            if( ( removed != aRowPositions.end() ) && ( *removed == src ) )
+            {
+                releaseCell( (*col)[src] );
+                ++removed;
+                continue;
+            }
+            (*col)[dst++] = (*col)[src];
+        }
+        col->resize( dst );
+    }
+
+    std::vector<std::vector<unsigned long>::size_type>::const_iterator removed = aRowPositions.begin();
+    std::vector<unsigned long>::size_type dst = 0;
+    for( std::vector<unsigned long>::size_type src = 0; src < mRowIndices.size(); ++src )
+    {
+        if( ( removed != aRowPositions.end() ) && ( *removed == src ) )
+        {
+            ++removed;
+            continue;
+        }
+        mRowIndices[dst++] = mRowIndices[src];
+    }
+    mRowIndices.resize( dst );
+}
+
+void
+MibContainerTableData::renumberRows()
+{
+    for( std::vector<unsigned long>::size_type i = 0; i < mRowIndices.size(); ++i )
+        mRowIndices[i] = i + 1;
+
+    mSorted = true;
+}
+
+void
+MibContainerTableData::compact()
+{
+    if( mStringGarbage <= mStrings.size() / 2 )
+        return;
+
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 8);
+    LOG("MibContainerTableData::compact: (oid)(arena size)(unreferenced)");
+    LOG(mTableEntryOid.get_printable());
+    LOG(mStrings.size());
+    LOG(mStringGarbage);
+    LOG_END;
+
+    std::string strings;
+    strings.reserve( mStrings.size() - mStringGarbage );
+
+    for( std::vector<ColumnType>::iterator col = mColumns.begin(); col != mColumns.end(); ++col )
+    {
+        for( ColumnType::iterator cell = col->begin(); cell != col->end(); ++cell )
+        {
+            if( cell->Storage != csString )
+                continue;
+
+            std::string::size_type offset = strings.size();
+            strings.append( mStrings, cell->Value, cell->Length );
+            cell->Value = offset;
+        }
+    }
+
+    mStrings.swap( strings );
+    mStringGarbage = 0;
+}
+
+void
+MibContainerTableData::sort()
+{
+    if( mSorted )
+        return;
+
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 8);
+    LOG("MibContainerTableData::sort: (oid)(rows)");
+    LOG(mTableEntryOid.get_printable());
+    LOG(mRowIndices.size());
+    LOG_END;
+
+    std::vector<std::vector<unsigned long>::size_type> perm( mRowIndices.size() );
+    for( std::vector<unsigned long>::size_type i = 0; i < perm.size(); ++i )
+        perm[i] = i;
+
+    std::stable_sort( perm.begin(), perm.end(), row_position_less( mRowIndices ) );
+
+    // keep the most recently added row for duplicate indices
+    std::vector<std::vector<unsigned long>::size_type>::size_type dst = 0;
+    for( std::vector<std::vector<unsigned long>::size_type>::size_type src = 0; src < perm.size(); ++src )
+    {
+        if( ( src + 1 < perm.size() ) && ( mRowIndices[perm[src]] == mRowIndices[perm[src + 1]] ) )
+            continue;
+        perm[dst++] = perm[src];
+    }
+    perm.resize( dst );
+
+    std::vector<unsigned long> rowIndices;
+    rowIndices.reserve( perm.size() );
+    for( std::vector<std::vector<unsigned long>::size_type>::size_type i = 0; i < perm.size(); ++i )
+        rowIndices.push_back( mRowIndices[perm[i]] );
+    mRowIndices.swap( rowIndices );
+
+    for( std::vector<ColumnType>::iterator col = mColumns.begin(); col != mColumns.end(); ++col )
+    {
+        // disabled columns hold no cells
+        if( col->empty() )
+            continue;
+
+        ColumnType sorted;
+        sorted.reserve( perm.size() );
+        for( std::vector<std::vector<unsigned long>::size_type>::size_type i = 0; i < perm.size(); ++i )
+            sorted.push_back( (*col)[perm[i]] );
+        col->swap( sorted );
+    }
+
+    mSorted = true;
+}
+
+void
+MibContainerTableData::materialize( Cell const &cell, Vbx &vb ) const
+{
+    switch( cell.Storage )
+    {
+    case csNumber:
+        switch( cell.Syntax )
+        {
+        case sNMP_SYNTAX_INT32:
+            vb.set_value( SnmpInt32( (long)(long long)cell.Value ) );
+            break;
+
+        case sNMP_SYNTAX_CNTR32:
+            vb.set_value( Counter32( (unsigned long)cell.Value ) );
+            break;
+
+        case sNMP_SYNTAX_TIMETICKS:
+            vb.set_value( TimeTicks( (unsigned long)cell.Value ) );
+            break;
+
+        case sNMP_SYNTAX_CNTR64:
+            vb.set_value( Counter64( cell.Value ) );
+            break;
+
+        default:
+            vb.set_value( SnmpUInt32( (unsigned long)cell.Value ) );
+            break;
+        }
+        break;
+
+    case csString:
+        vb.set_value( OctetStr( reinterpret_cast<unsigned char const *>( mStrings.data() + cell.Value ), cell.Length ) );
+        break;
+
+    case csForeign:
+        vb.set_value( *mForeign[cell.Value] );
+        break;
+
+    default:
+        vb.set_null();
+        break;
+    }
+}
+
+bool
+MibContainerTableData::get( Oidx const &o, Vbx &vb ) const
+{
+    unsigned long const n = mTableEntryOid.len();
+
+    if( ( o.len() != n + 2 ) || !mTableEntryOid.is_root_of( o ) )
+        return false;
+
+    unsigned long const colIdx = o[n];
+    if( !isColumnEnabled( colIdx ) )
+        return false;
+
+    std::vector<unsigned long>::const_iterator row = std::lower_bound( mRowIndices.begin(), mRowIndices.end(), (unsigned long)o[n + 1] );
+    if( ( row == mRowIndices.end() ) || ( *row != o[n + 1] ) )
+        return false;
+
+    Cell const &cell = mColumns[colIdx - 1][row - mRowIndices.begin()];
+    if( cell.Storage == csUnset )
+        return false;
+
+    materialize( cell, vb );
+
+    return true;
+}
+
+bool
+MibContainerTableData::firstCellFrom( unsigned long aColIdx, std::vector<unsigned long>::size_type aRowPos, Oidx &succ ) const
+{
+    for( ; aColIdx <= mColumns.size(); ++aColIdx, aRowPos = 0 )
+    {
+        ColumnType const &col = mColumns[aColIdx - 1];
+        for( ; aRowPos < col.size(); ++aRowPos )
+        {
+            if( col[aRowPos].Storage != csUnset )
+            {
+                succ = mTableEntryOid;
+                succ += aColIdx;
+                succ += mRowIndices[aRowPos];
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool
+MibContainerTableData::find_succ( Oidx const &o, Oidx &succ ) const
+{
+    unsigned long const n = mTableEntryOid.len();
+
+    if( mTableEntryOid.is_root_of( o ) )
+    {
+        unsigned long colIdx = o[n];
+        std::vector<unsigned long>::size_type rowPos = 0;
+
+        if( colIdx < 1 )
+            colIdx = 1;
+        else if( o.len() > n + 1 )
+            rowPos = std::upper_bound( mRowIndices.begin(), mRowIndices.end(), (unsigned long)o[n + 1] ) - mRowIndices.begin();
+
+        return firstCellFrom( colIdx, rowPos, succ );
+    }
+
+    if( o <= mTableEntryOid )
+        return firstCellFrom( 1, 0, succ );
+
+    return false;
+}
+
+}
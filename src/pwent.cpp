@@ -19,6 +19,10 @@
 #include <smart-snmpd/pwent.h>
 #include <smart-snmpd/log.h>
 
+#include <sys/stat.h>
+#include <pthread.h>
+#include <time.h>
+
 #if defined(WITH_USER_LOOKUP) && (WITH_USER_LOOKUP != 0)
 # if defined(WITH_PAM_USER_LOOKUP) || defined(WITH_FILE_USER_LOOKUP)
 #  include <pwd.h>
@@ -131,6 +135,181 @@ SystemUserInfo::guess_pwent_bufsize()
 }
 #endif
 
+/**
+ * cached lookup result
+ */
+template< class V >
+struct NameCacheEntry
+{
+    NameCacheEntry()
+        : Value()
+        , Expires(0)
+    {}
+
+    V Value;
+    time_t Expires;
+};
+
+/**
+ * resolved user and group information shared by all SystemUserInfo instances
+ */
+struct SharedNameCache
+{
+    SharedNameCache()
+        : PwUid()
+        , PwName()
+        , GrGid()
+        , GrName()
+        , Credentials()
+        , PasswdMtime(0)
+        , GroupMtime(0)
+        , NextCheck(0)
+        , Generation(0)
+        , PositiveTtl(300)
+        , NegativeTtl(60)
+    {}
+
+    std::map<uid_t, NameCacheEntry<string> > PwUid;
+    std::map<string, NameCacheEntry<uid_t> > PwName;
+    std::map<gid_t, NameCacheEntry<string> > GrGid;
+    std::map<string, NameCacheEntry<gid_t> > GrName;
+    std::map<string, NameCacheEntry<SystemUserInfo::Credentials> > Credentials;
+    //! modification times of /etc/passwd and /etc/group the entries base on
+    time_t PasswdMtime;
+    time_t GroupMtime;
+    //! time of the next check of the modification times
+    time_t NextCheck;
+    //! incremented whenever the cache is dropped
+    unsigned long Generation;
+    //! seconds to keep resolved and failed lookups
+    time_t PositiveTtl;
+    time_t NegativeTtl;
+};
+
+static SharedNameCache nameCache;
+static pthread_mutex_t nameCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * holds the lock of the shared name cache while in scope
+ */
+class NameCacheGuard
+{
+public:
+    NameCacheGuard() { pthread_mutex_lock( &nameCacheLock ); }
+    ~NameCacheGuard() { pthread_mutex_unlock( &nameCacheLock ); }
+
+private:
+    NameCacheGuard(NameCacheGuard const &);
+    NameCacheGuard & operator = (NameCacheGuard const &);
+};
+
+/**
+ * drops all entries of the shared name cache (called with lock held)
+ */
+static void
+drop_name_cache()
+{
+    nameCache.PwUid.clear();
+    nameCache.PwName.clear();
+    nameCache.GrGid.clear();
+    nameCache.GrName.clear();
+    nameCache.Credentials.clear();
+    ++nameCache.Generation;
+}
+
+/**
+ * drops the shared name cache when the user or group database has been
+ * modified, checked at most once per second (called with lock held)
+ *
+ * @param now - current time
+ */
+static void
+check_name_cache( time_t now )
+{
+    if( now < nameCache.NextCheck )
+        return;
+    nameCache.NextCheck = now + 1;
+
+    struct stat st;
+    time_t passwdMtime = ( 0 == stat( "/etc/passwd", &st ) ) ? st.st_mtime : 0;
+    time_t groupMtime = ( 0 == stat( "/etc/group", &st ) ) ? st.st_mtime : 0;
+    if( ( passwdMtime != nameCache.PasswdMtime ) || ( groupMtime != nameCache.GroupMtime ) )
+    {
+        drop_name_cache();
+        nameCache.PasswdMtime = passwdMtime;
+        nameCache.GroupMtime = groupMtime;
+    }
+}
+
+/**
+ * fetches a valid entry from the shared name cache
+ *
+ * @param cache - the map of the shared cache to search
+ * @param key - key to look for
+ * @param value - receives the cached value
+ * @param generation - receives the generation to pass to store_cached()
+ *
+ * @return bool - true when a valid entry has been found
+ */
+template< class K, class V >
+static bool
+find_cached( std::map< K, NameCacheEntry<V> > const &cache, K const &key, V &value, unsigned long &generation )
+{
+    NameCacheGuard guard;
+    time_t now = time(NULL);
+
+    check_name_cache( now );
+    generation = nameCache.Generation;
+
+    typename std::map< K, NameCacheEntry<V> >::const_iterator iter = cache.find( key );
+    if( ( iter == cache.end() ) || ( iter->second.Expires <= now ) )
+        return false;
+
+    value = iter->second.Value;
+    return true;
+}
+
+/**
+ * puts a lookup result into the shared name cache unless the cache has
+ * been dropped since the lookup started
+ *
+ * @param cache - the map of the shared cache to update
+ * @param key - key of the entry
+ * @param value - the resolved value
+ * @param found - false for a failed lookup
+ * @param generation - generation delivered by find_cached()
+ */
+template< class K, class V >
+static void
+store_cached( std::map< K, NameCacheEntry<V> > &cache, K const &key, V const &value, bool found, unsigned long generation )
+{
+    NameCacheGuard guard;
+    time_t ttl = found ? nameCache.PositiveTtl : nameCache.NegativeTtl;
+
+    if( ( ttl <= 0 ) || ( generation != nameCache.Generation ) )
+        return;
+
+    NameCacheEntry<V> &entry = cache[key];
+    entry.Value = value;
+    entry.Expires = time(NULL) + ttl;
+}
+
+void
+SystemUserInfo::invalidate()
+{
+    NameCacheGuard guard;
+    drop_name_cache();
+}
+
+void
+SystemUserInfo::setCacheTimeouts(unsigned long positive, unsigned long negative)
+{
+    NameCacheGuard guard;
+    nameCache.PositiveTtl = (time_t)( ( positive + 999 ) / 1000 );
+    nameCache.NegativeTtl = (time_t)( ( negative + 999 ) / 1000 );
+}
+
+
 #if defined(WITH_USER_LOOKUP) && (WITH_USER_LOOKUP != 0)
 
 # if defined(WITH_PAM_USER_LOOKUP) || \
@@ -413,150 +592,249 @@ findgroupbyname(const char *name, struct group *grp, char *buf, size_t buflen, s
     return rc;
 }
 
-string const &
-SystemUserInfo::getusernamebyuid(uid_t id)
+static int
+findgroupsbyuser(const char *name, gid_t gid, vector<gid_t> &groups, char *buf, size_t buflen)
 {
-    map<uid_t, string>::iterator iter = mPwUidCache.lower_bound( id );
-    if( iter != mPwUidCache.end() && iter->first == id )
-    {
-        return iter->second;
-    }
-    else
-    {
-        struct passwd pwent, *result = NULL;
-        memset( &pwent, 0, sizeof(pwent) );
-
-        int rc = finduserbyuid(id, &pwent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result);
+    int rc = 0;
+# if defined(WITH_PAM_USER_LOOKUP) || \
+     ( defined(WITH_FILE_USER_LOOKUP) && \
+       !( defined(HAVE_FGETGRENT_R) && defined(HAVE_FGETPWENT_R) ) )
+    rc = pthread_mutex_lock( &pw_gr_serializer );
+    if( rc != 0 )
+        return ENOENT;
+# endif
 
-        LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
-        LOG( "getusernamebyuid(id): (rc)(pwent.pw_name)" );
-        LOG(id);
-        LOG(rc);
-        LOG(to_string((void *)(pwent.pw_name)).c_str());
-        LOG_END;
+    groups.clear();
+    groups.push_back( gid );
 
-        if( ( 0 == rc ) && (pwent.pw_name) )
+# if defined(WITH_PAM_USER_LOOKUP)
+#  if defined(HAVE_GETGROUPLIST)
+    (void)buf;
+    (void)buflen;
+    for( int ngroups = 32; ; )
+    {
+        vector<gid_t> list( ngroups );
+        int n = ngroups;
+        if( getgrouplist( name, gid, &list[0], &n ) >= 0 )
         {
-            iter = mPwUidCache.insert( iter, make_pair( id, pwent.pw_name ) );
-            mPwNameCache.insert( make_pair( pwent.pw_name, id ) );
+            list.resize( n );
+            groups.swap( list );
+            break;
         }
-        else
+
+        // some implementations don't report the required size
+        ngroups = ( n > ngroups ) ? n : ngroups * 2;
+        if( ngroups > 65536 )
         {
-            iter = mPwUidCache.insert( iter, make_pair( id, emptyString ) );
+            rc = E2BIG;
+            break;
         }
-
-        return iter->second;
     }
-}
-
-string const &
-SystemUserInfo::getgroupnamebygid(gid_t id)
-{
-    map<uid_t, string>::iterator iter = mGrGidCache.lower_bound( id );
-    if( iter != mGrGidCache.end() && iter->first == id )
+#  else
+    // supplementary groups can't be determined - only the primary group is used
+    (void)name;
+    (void)buf;
+    (void)buflen;
+#  endif
+# elif defined(WITH_FILE_USER_LOOKUP)
+    FILE *fp = fopen( "/etc/group", "r" );
+    if( 0 == fp )
     {
-        return iter->second;
+        rc = errno;
     }
     else
     {
+#  if defined(HAVE_FGETGRENT_R)
         struct group grent, *result = NULL;
-        memset( &grent, 0, sizeof(grent) );
-
-        int rc = findgroupbygid(id, &grent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result);
-
-        LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
-        LOG( "getgroupnamebygid(id): (rc)(grent.gr_name)" );
-        LOG(id);
-        LOG(rc);
-        LOG(to_string((void *)(grent.gr_name)).c_str());
-        LOG_END;
-
-        if( ( 0 == rc ) && (grent.gr_name) )
+        while( 0 == fgetgrent_r( fp, &grent, buf, buflen, &result ) )
         {
-            iter = mGrGidCache.insert( iter, make_pair( id, grent.gr_name ) );
-            mGrNameCache.insert( make_pair( grent.gr_name, id ) );
-        }
-        else
-        {
-            iter = mGrGidCache.insert( iter, make_pair( id, emptyString ) );
-        }
+            if( grent.gr_gid == gid || 0 == grent.gr_mem )
+                continue;
 
-        return iter->second;
+            for( char **mem = grent.gr_mem; *mem; ++mem )
+            {
+                if( strcmp( name, *mem ) == 0 )
+                {
+                    groups.push_back( grent.gr_gid );
+                    break;
+                }
+            }
+        }
+#  elif defined(HAVE_FGETGRENT)
+#   error non-reentrant function support using fgetgrent() currently not implemented
+#  else
+#   error neither fgetgrent_r() nor fgetgrent() available
+#  endif
+        fclose( fp );
     }
+# endif
+
+# if defined(WITH_PAM_USER_LOOKUP) || \
+     ( defined(WITH_FILE_USER_LOOKUP) && \
+       !( defined(HAVE_FGETGRENT_R) && defined(HAVE_FGETPWENT_R) ) )
+    pthread_mutex_unlock( &pw_gr_serializer );
+# endif
+
+    return rc;
 }
 
-uid_t
-SystemUserInfo::getuseridbyname(string const &name)
+string
+SystemUserInfo::getusernamebyuid(uid_t id)
 {
-    map<string, uid_t>::iterator iter = mPwNameCache.lower_bound( name );
-    if( iter != mPwNameCache.end() && iter->first == name )
+    string name;
+    unsigned long generation;
+    if( find_cached( nameCache.PwUid, id, name, generation ) )
+        return name;
+
+    struct passwd pwent, *result = NULL;
+    memset( &pwent, 0, sizeof(pwent) );
+
+    int rc = finduserbyuid(id, &pwent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result);
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
+    LOG( "getusernamebyuid(id): (rc)(pwent.pw_name)" );
+    LOG(id);
+    LOG(rc);
+    LOG(to_string((void *)(pwent.pw_name)).c_str());
+    LOG_END;
+
+    bool found = ( 0 == rc ) && ( 0 != result ) && (pwent.pw_name);
+    if( found )
     {
-        return iter->second;
+        name = pwent.pw_name;
+        store_cached( nameCache.PwName, name, id, true, generation );
     }
-    else
-    {
-        struct passwd pwent, *result = NULL;
-        memset( &pwent, 0, sizeof(pwent) );
+    store_cached( nameCache.PwUid, id, name, found, generation );
 
-        int rc = finduserbyname( name.c_str(), &pwent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result );
+    return name;
+}
 
-        LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
-        LOG( "getuseridbyname(name): (rc)(uid)" );
-        LOG(name.c_str());
-        LOG(rc);
-        LOG(pwent.pw_uid);
-        LOG_END;
+string
+SystemUserInfo::getgroupnamebygid(gid_t id)
+{
+    string name;
+    unsigned long generation;
+    if( find_cached( nameCache.GrGid, id, name, generation ) )
+        return name;
 
-        if( 0 == rc )
-        {
-            mPwUidCache.insert( make_pair( pwent.pw_uid, name ) );
-        }
-        else
-        {
-            pwent.pw_uid = (uid_t)-1;
-        }
+    struct group grent, *result = NULL;
+    memset( &grent, 0, sizeof(grent) );
+
+    int rc = findgroupbygid(id, &grent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result);
 
-        iter = mPwNameCache.insert( iter, make_pair( name, pwent.pw_uid ) );
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
+    LOG( "getgroupnamebygid(id): (rc)(grent.gr_name)" );
+    LOG(id);
+    LOG(rc);
+    LOG(to_string((void *)(grent.gr_name)).c_str());
+    LOG_END;
 
-        return pwent.pw_uid;
+    bool found = ( 0 == rc ) && ( 0 != result ) && (grent.gr_name);
+    if( found )
+    {
+        name = grent.gr_name;
+        store_cached( nameCache.GrName, name, id, true, generation );
     }
+    store_cached( nameCache.GrGid, id, name, found, generation );
+
+    return name;
+}
+
+uid_t
+SystemUserInfo::getuseridbyname(string const &name)
+{
+    uid_t id;
+    unsigned long generation;
+    if( find_cached( nameCache.PwName, name, id, generation ) )
+        return id;
+
+    struct passwd pwent, *result = NULL;
+    memset( &pwent, 0, sizeof(pwent) );
+
+    int rc = finduserbyname( name.c_str(), &pwent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result );
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
+    LOG( "getuseridbyname(name): (rc)(uid)" );
+    LOG(name.c_str());
+    LOG(rc);
+    LOG(pwent.pw_uid);
+    LOG_END;
+
+    bool found = ( 0 == rc ) && ( 0 != result );
+    id = found ? pwent.pw_uid : (uid_t)-1;
+    if( found )
+        store_cached( nameCache.PwUid, id, name, true, generation );
+    store_cached( nameCache.PwName, name, id, found, generation );
+
+    return id;
 }
 
 gid_t
 SystemUserInfo::getgroupidbyname(string const &name)
 {
-    map<string, gid_t>::iterator iter = mGrNameCache.lower_bound( name );
-    if( iter != mGrNameCache.end() && iter->first == name )
-    {
-        return iter->second;
-    }
-    else
-    {
-        struct group grent, *result = NULL;
-        memset( &grent, 0, sizeof(grent) );
+    gid_t id;
+    unsigned long generation;
+    if( find_cached( nameCache.GrName, name, id, generation ) )
+        return id;
+
+    struct group grent, *result = NULL;
+    memset( &grent, 0, sizeof(grent) );
+
+    int rc = findgroupbyname( name.c_str(), &grent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result );
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
+    LOG( "getgroupidbyname(name): (rc)(gid)" );
+    LOG(name.c_str());
+    LOG(rc);
+    LOG(grent.gr_gid);
+    LOG_END;
+
+    bool found = ( 0 == rc ) && ( 0 != result );
+    id = found ? grent.gr_gid : (gid_t)-1;
+    if( found )
+        store_cached( nameCache.GrGid, id, name, true, generation );
+    store_cached( nameCache.GrName, name, id, found, generation );
+
+    return id;
+}
 
-        int rc = findgroupbyname( name.c_str(), &grent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result );
+bool
+SystemUserInfo::getusercredentials(string const &name, Credentials &cred)
+{
+    unsigned long generation;
+    if( find_cached( nameCache.Credentials, name, cred, generation ) )
+        return cred.Uid != (uid_t)-1;
 
-        LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
-        LOG( "getgroupidbyname(name): (rc)(gid)" );
-        LOG(name.c_str());
-        LOG(rc);
-        LOG(grent.gr_gid);
-        LOG_END;
+    struct passwd pwent, *result = NULL;
+    memset( &pwent, 0, sizeof(pwent) );
 
-        if( 0 == rc )
-        {
-            mGrGidCache.insert( make_pair( grent.gr_gid, name ) );
-        }
-        else
-        {
-            grent.gr_gid = (uid_t)-1;
-        }
-
-        iter = mGrNameCache.insert( iter, make_pair( name, grent.gr_gid ) );
+    int rc = finduserbyname( name.c_str(), &pwent, mSysBuf.getBuffer(), mSysBuf.getBufSize(), &result );
+    if( ( 0 == rc ) && ( 0 == result ) )
+        rc = ENOENT;
 
-        return grent.gr_gid;
+    Credentials found;
+    if( 0 == rc )
+    {
+        found.Uid = pwent.pw_uid;
+        found.Gid = pwent.pw_gid;
+        rc = findgroupsbyuser( name.c_str(), found.Gid, found.Groups, mSysBuf.getBuffer(), mSysBuf.getBufSize() );
+        if( 0 != rc )
+            found = Credentials();
     }
+
+    LOG_BEGIN( loggerModuleName, DEBUG_LOG | 0 );
+    LOG( "getusercredentials(name): (rc)(uid)(gid)(groups)" );
+    LOG(name.c_str());
+    LOG(rc);
+    LOG(found.Uid);
+    LOG(found.Gid);
+    LOG(found.Groups.size());
+    LOG_END;
+
+    store_cached( nameCache.Credentials, name, found, 0 == rc, generation );
+    cred = found;
+
+    return 0 == rc;
 }
 
 #endif
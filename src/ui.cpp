@@ -19,6 +19,7 @@
 #include <smart-snmpd/config.h>
 #include <smart-snmpd/cmndline.h>
 #include <smart-snmpd/ui.h>
+#include <smart-snmpd/pwent.h>
 
 #include <iostream>
 
@@ -220,6 +221,8 @@ UI::UI(int argc, char **argv)
     if( -2 == rc ) // ENOENT
         exit(255);
 
+    SystemUserInfo::setCacheTimeouts( Config::getInstance().getUserCacheTimeout(), Config::getInstance().getUserCacheNegativeTimeout() );
+
     setup_logging(false);
 }
 
@@ -388,6 +391,10 @@ UI::reload_config()
     {
         setup_logging();
 
+        // users and groups might have been changed along with the configuration
+        SystemUserInfo::setCacheTimeouts( Config::getInstance().getUserCacheTimeout(), Config::getInstance().getUserCacheNegativeTimeout() );
+        SystemUserInfo::invalidate();
+
         LOG_BEGIN( loggerModuleName, INFO_LOG | 9);
         LOG("Config loaded");
         LOG_END;
@@ -0,0 +1,413 @@
+/*
+ * Copyright 2010,2011 Matthias Haag, Jens Rehsack
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ *
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <build-smart-snmpd.h>
+
+#include <smart-snmpd/updatescheduler.h>
+#include <smart-snmpd/datasource.h>
+#include <smart-snmpd/mibobject.h>
+
+#include <algorithm>
+
+namespace SmartSnmpd
+{
+
+static const char * const loggerModuleName = "smartsnmpd.updatescheduler";
+
+UpdateScheduler *UpdateScheduler::mInstance = 0;
+
+struct JobOidLess
+{
+    bool operator () ( std::pair<std::string, UpdateJobStatus> const &a, std::pair<std::string, UpdateJobStatus> const &b ) const
+    {
+        return a.first < b.first;
+    }
+};
+
+void
+UpdateWorker::run()
+{
+    mScheduler.lock();
+
+    DataSource *dataSource;
+    while( 0 != ( dataSource = mScheduler.fetch() ) )
+    {
+        mScheduler.unlock();
+
+        UpdateTime started = UpdateScheduler::now();
+        try
+        {
+            dataSource->getMibObject()->refresh();
+        }
+        catch( ... )
+        {
+            // the worker and the job must survive - the job is rescheduled as usual
+            LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+            LOG("UpdateWorker::run(): update of (mib object) failed with an exception");
+            LOG(dataSource->getMibObject()->key()->get_printable());
+            LOG_END;
+        }
+        UpdateTime finished = UpdateScheduler::now();
+
+        mScheduler.lock();
+        mScheduler.finish( *dataSource, started, finished );
+    }
+
+    mScheduler.unlock();
+}
+
+UpdateScheduler::UpdateScheduler()
+    : Synchronized()
+    , mJobs()
+    , mTimerHeap()
+    , mReadyHeap()
+    , mWorkers()
+    , mGeneration(0)
+    , mSeed( (unsigned int)( time(NULL) ) )
+    , mRunning(false)
+{}
+
+UpdateScheduler::~UpdateScheduler()
+{
+    stop();
+}
+
+UpdateScheduler &
+UpdateScheduler::getInstance()
+{
+    if( 0 == mInstance )
+        mInstance = new UpdateScheduler();
+    return *mInstance;
+}
+
+UpdateTime
+UpdateScheduler::now()
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if( 0 == clock_gettime( CLOCK_MONOTONIC, &ts ) )
+        return ( (UpdateTime)(ts.tv_sec) ) * 1000 + ts.tv_nsec / 1000000;
+#endif
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return ( (UpdateTime)(tv.tv_sec) ) * 1000 + tv.tv_usec / 1000;
+}
+
+bool
+UpdateScheduler::start( unsigned aNumberOfWorkers )
+{
+    lock();
+
+    if( !mRunning )
+    {
+        LOG_BEGIN(loggerModuleName, EVENT_LOG | 3);
+        LOG("UpdateScheduler::start(): starting (workers)");
+        LOG(aNumberOfWorkers);
+        LOG_END;
+
+        mRunning = true;
+        if( 0 == aNumberOfWorkers )
+            aNumberOfWorkers = 1;
+
+        for( unsigned i = 0; i < aNumberOfWorkers; ++i )
+        {
+            UpdateWorker *worker = new UpdateWorker( *this );
+            worker->start();
+            if( !worker->is_alive() )
+            {
+                LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+                LOG("UpdateScheduler::start(): failed to start update worker (index)");
+                LOG(i);
+                LOG_END;
+
+                delete worker;
+                break;
+            }
+
+            mWorkers.push_back( worker );
+        }
+
+        mRunning = !mWorkers.empty();
+    }
+
+    bool rc = mRunning;
+    unlock();
+
+    return rc;
+}
+
+void
+UpdateScheduler::stop()
+{
+    lock();
+    mRunning = false;
+    notify_all();
+    std::vector<UpdateWorker *> workers;
+    workers.swap( mWorkers );
+    unlock();
+
+    for( std::vector<UpdateWorker *>::iterator i = workers.begin(); i != workers.end(); ++i )
+    {
+        (*i)->join();
+        delete *i;
+    }
+}
+
+bool
+UpdateScheduler::schedule( DataSource &aDataSource, UpdateJobConfig const &aJobConfig )
+{
+    lock();
+
+    if( !mRunning )
+    {
+        unlock();
+        return false;
+    }
+
+    JobContainerType::iterator iter = mJobs.find( &aDataSource );
+    if( iter == mJobs.end() )
+    {
+        Job job;
+        job.Config = aJobConfig;
+        job.Generation = 0;
+        job.Removing = false;
+        job.OneShot = false;
+        job.Retrigger = false;
+        iter = mJobs.insert( JobContainerType::value_type( &aDataSource, job ) ).first;
+
+        enqueue( aDataSource, iter->second, now() );
+    }
+    else
+    {
+        Job &job = iter->second;
+        job.Config = aJobConfig;
+        job.Removing = false;
+        job.OneShot = false;
+
+        // a running job is enqueued with the new settings when it finishes
+        if( !job.Status.Running )
+            enqueue( aDataSource, job, job.Status.Runs ? job.Status.LastRun + job.Config.Interval : now() );
+    }
+
+    notify_all();
+    unlock();
+
+    return true;
+}
+
+void
+UpdateScheduler::unschedule( DataSource &aDataSource )
+{
+    lock();
+
+    JobContainerType::iterator iter;
+    while( ( iter = mJobs.find( &aDataSource ) ) != mJobs.end() )
+    {
+        if( !iter->second.Status.Running )
+        {
+            // left heap entries are skipped when fetched
+            mJobs.erase( iter );
+            break;
+        }
+
+        iter->second.Removing = true;
+        wait();
+    }
+
+    unlock();
+}
+
+bool
+UpdateScheduler::trigger( DataSource &aDataSource, bool aAfterRunning )
+{
+    lock();
+
+    if( !mRunning )
+    {
+        unlock();
+        return false;
+    }
+
+    UpdateTime current = now();
+    JobContainerType::iterator iter = mJobs.find( &aDataSource );
+    if( iter == mJobs.end() )
+    {
+        Job job;
+        job.Config.Interval = 0;
+        job.Generation = 0;
+        job.Removing = false;
+        job.OneShot = true;
+        job.Retrigger = false;
+        iter = mJobs.insert( JobContainerType::value_type( &aDataSource, job ) ).first;
+
+        enqueue( aDataSource, iter->second, current, false );
+        notify_all();
+    }
+    else if( !iter->second.Status.Running && !iter->second.Removing && ( iter->second.Status.NextRun > current ) )
+    {
+        enqueue( aDataSource, iter->second, current, false );
+        notify_all();
+    }
+    else if( aAfterRunning && iter->second.Status.Running && !iter->second.Removing )
+    {
+        iter->second.Retrigger = true;
+    }
+
+    unlock();
+
+    return true;
+}
+
+bool
+UpdateScheduler::isScheduled( DataSource const &aDataSource )
+{
+    lock();
+    JobContainerType::const_iterator iter = mJobs.find( &aDataSource );
+    bool rc = ( iter != mJobs.end() ) && !iter->second.Removing && !iter->second.OneShot;
+    unlock();
+
+    return rc;
+}
+
+void
+UpdateScheduler::getJobStatuses( std::vector< std::pair<std::string, UpdateJobStatus> > &aJobs )
+{
+    aJobs.clear();
+
+    lock();
+    for( JobContainerType::iterator iter = mJobs.begin(); iter != mJobs.end(); ++iter )
+    {
+        if( iter->second.Removing )
+            continue;
+
+        // the data sources are registered non-const, the key is const for lookups only
+        DataSource *ds = const_cast<DataSource *>( iter->first );
+        aJobs.push_back( std::make_pair( std::string( ds->getMibObject()->key()->get_printable() ), iter->second.Status ) );
+    }
+    unlock();
+
+    std::sort( aJobs.begin(), aJobs.end(), JobOidLess() );
+}
+
+void
+UpdateScheduler::enqueue( DataSource &aDataSource, Job &aJob, UpdateTime aDue, bool aWithJitter )
+{
+    if( aWithJitter && aJob.Config.Jitter )
+    {
+        UpdateTime maxDelay = aJob.Config.Interval * aJob.Config.Jitter / 100;
+        if( maxDelay )
+            aDue += (UpdateTime)(rand_r( &mSeed )) % ( maxDelay + 1 );
+    }
+
+    HeapEntry entry;
+    entry.Due = aDue;
+    entry.Priority = aJob.Config.Priority;
+    entry.Source = &aDataSource;
+    entry.Generation = aJob.Generation = ++mGeneration;
+
+    aJob.Status.NextRun = aDue;
+
+    mTimerHeap.push_back( entry );
+    std::push_heap( mTimerHeap.begin(), mTimerHeap.end(), DueLater() );
+}
+
+DataSource *
+UpdateScheduler::fetch()
+{
+    while( mRunning )
+    {
+        UpdateTime current = now();
+
+        while( !mTimerHeap.empty() && ( mTimerHeap.front().Due <= current ) )
+        {
+            std::pop_heap( mTimerHeap.begin(), mTimerHeap.end(), DueLater() );
+            HeapEntry entry = mTimerHeap.back();
+            mTimerHeap.pop_back();
+
+            mReadyHeap.push_back( entry );
+            std::push_heap( mReadyHeap.begin(), mReadyHeap.end(), LessUrgent() );
+        }
+
+        while( !mReadyHeap.empty() )
+        {
+            std::pop_heap( mReadyHeap.begin(), mReadyHeap.end(), LessUrgent() );
+            HeapEntry entry = mReadyHeap.back();
+            mReadyHeap.pop_back();
+
+            JobContainerType::iterator iter = mJobs.find( entry.Source );
+            if( ( iter == mJobs.end() ) || ( iter->second.Generation != entry.Generation ) ||
+                iter->second.Status.Running || iter->second.Removing )
+                continue; // outdated entry
+
+            LOG_BEGIN(loggerModuleName, DEBUG_LOG | 8);
+            LOG("UpdateScheduler::fetch(): running update for (oid)(delay)");
+            LOG(entry.Source->getMibObject()->key()->get_printable());
+            LOG((unsigned long)(current - entry.Due));
+            LOG_END;
+
+            iter->second.Status.Running = true;
+            return entry.Source;
+        }
+
+        if( mTimerHeap.empty() )
+        {
+            wait();
+        }
+        else
+        {
+            UpdateTime timeout = mTimerHeap.front().Due - current;
+            wait( timeout > 0x7fffffff ? 0x7fffffff : (long)(timeout) );
+        }
+    }
+
+    return 0;
+}
+
+void
+UpdateScheduler::finish( DataSource &aDataSource, UpdateTime aStarted, UpdateTime aFinished )
+{
+    JobContainerType::iterator iter = mJobs.find( &aDataSource );
+    if( iter != mJobs.end() )
+    {
+        Job &job = iter->second;
+
+        job.Status.Running = false;
+        job.Status.LastRun = aStarted;
+        job.Status.LastDuration = aFinished - aStarted;
+        ++job.Status.Runs;
+
+        LOG_BEGIN(loggerModuleName, DEBUG_LOG | 8);
+        LOG("UpdateScheduler::finish(): updated (oid)(duration)(one-shot)");
+        LOG(aDataSource.getMibObject()->key()->get_printable());
+        LOG((unsigned long)(job.Status.LastDuration));
+        LOG(job.OneShot ? "yes" : "no");
+        LOG_END;
+
+        bool retrigger = job.Retrigger;
+        job.Retrigger = false;
+
+        if( job.OneShot && !retrigger )
+            mJobs.erase( iter );
+        else if( retrigger && !job.Removing )
+            enqueue( aDataSource, job, aFinished, false );
+        else if( !job.Removing )
+            enqueue( aDataSource, job, aStarted + job.Config.Interval );
+    }
+
+    notify_all(); // wake up unschedule() and workers waiting for a shorter timeout
+}
+
+}